@@ -0,0 +1,1098 @@
+#include "../include/source_buffer.h"
+#include "../include/Lexer.h"
+#include "../include/streaming_lexer.h"
+#include "../include/parallel_lexer.h"
+#ifdef SYSY_HAVE_FLEX
+#include "../include/flex_scanner.h"
+#endif
+#include "../include/Parser.h"
+#include "../include/flat_ast.h"
+#include "../include/ast_visitor.h"
+#include "../include/semantic_analyzer.h"
+#include "../include/const_eval.h"
+#include "../include/diagnostics.h"
+#include "../include/ir_lowering.h"
+#include "../include/dominators.h"
+#include "../include/passes.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// 前端基准测试
+// 生成大规模的SysY程序，分别统计词法分析、语法分析等阶段的耗时
+// 用法：sysy_bench [函数个数]
+//       sysy_bench <源文件>    对已有文件分别做分块流式和整体映射的词法分析，统计吞吐量和峰值内存
+
+// 统计堆分配次数：替换全局operator new，只计数，不改变分配行为
+static size_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+// 生成一个包含funcCount个函数的SysY程序
+// 每个函数包含变量声明、while循环、if/else分支、数组访问和函数调用
+static std::string generateProgram(int funcCount) {
+    std::string program;
+    program.reserve(static_cast<size_t>(funcCount) * 400);
+    program += "int g0 = 1;\nint g1[16];\n";
+
+    for (int i = 0; i < funcCount; ++i) {
+        std::string name = "func" + std::to_string(i);
+        program += "int " + name + "(int a, int b) {\n";
+        program += "    // loop body generated for benchmark\n";
+        program += "    int s = 0;\n    int k = a;\n";
+        program += "    while (k < b) {\n";
+        program += "        if (k > 10) {\n            s = s + k * 2 - g0;\n";
+        program += "        } else {\n            s = s - (k + 3) / 2;\n        }\n";
+        program += "        k = k + 1;\n    }\n";
+        if (i > 0) {
+            program += "    s = s + func" + std::to_string(i - 1) + "(s, 10);\n";
+        }
+        program += "    /* result */\n    return s;\n}\n";
+    }
+
+    program += "int main() {\n    return func" + std::to_string(funcCount - 1) + "(0, 100);\n}\n";
+    return program;
+}
+
+// 生成注释密集的SysY程序：大段文档注释、行尾注释和深缩进，代码本身占比很小
+static std::string generateCommentHeavyProgram(int funcCount) {
+    std::string program;
+    program.reserve(static_cast<size_t>(funcCount) * 1200);
+
+    for (int i = 0; i < funcCount; ++i) {
+        program += "/*\n * function_" + std::to_string(i) + "\n";
+        program += " * Computes an accumulated value over the requested interval of elements.\n";
+        program += " * The implementation is intentionally naive; see the design notes for details.\n";
+        program += " */\n";
+        program += "int function_" + std::to_string(i) + "(int accumulated_value, int upper_bound) {\n";
+        program += "                // initialise the running counter before entering the loop body\n";
+        program += "                int iteration_counter = accumulated_value;   // starting point\n";
+        program += "                while (iteration_counter < upper_bound) {\n";
+        program += "                                /* advance by one element per iteration */\n";
+        program += "                                iteration_counter = iteration_counter + 1;\n";
+        program += "                }\n";
+        program += "                return iteration_counter;   // final value\n";
+        program += "}\n\n";
+    }
+    return program;
+}
+
+// 生成数字常量密集的SysY程序：大型常量数组初始化，混合十进制、八进制、十六进制整数和各种形式的浮点数
+static std::string generateLiteralHeavyProgram(int funcCount) {
+    static const char* const literals[] = {
+        "0", "7", "42", "1024", "2147483647", "0777", "0x1F", "0XDEADBEEF",
+        "3.14159", ".5", "1.", "6.02e23", "1.5e-3", "0x1.8p3", "0X.8P-1", "1e10"
+    };
+    std::string program;
+    program.reserve(static_cast<size_t>(funcCount) * 600);
+
+    for (int i = 0; i < funcCount; ++i) {
+        program += "const float table" + std::to_string(i) + "[64] = {";
+        for (int j = 0; j < 64; ++j) {
+            program += literals[(i + j) % 16];
+            program += j + 1 < 64 ? ", " : "};\n";
+        }
+    }
+    return program;
+}
+
+// 生成只包含一个超长表达式的程序：terms项的加减乘除和取模
+static std::string generateLongExpressionProgram(int terms) {
+    static const char* const operators[] = {" + ", " * ", " - ", " / ", " % "};
+    std::string program = "int x;\nint main() {\n    return x";
+    program.reserve(static_cast<size_t>(terms) * 4 + 64);
+    for (int i = 1; i < terms; ++i) {
+        program += operators[i % 5];
+        program += 'x';
+    }
+    program += ";\n}\n";
+    return program;
+}
+
+// 生成只包含一个深度嵌套表达式的程序：depth层括号
+static std::string generateNestedExpressionProgram(int depth) {
+    std::string program = "int x;\nint main() {\n    return ";
+    program.reserve(static_cast<size_t>(depth) * 6 + 64);
+    program.append(static_cast<size_t>(depth), '(');
+    program += 'x';
+    for (int i = 0; i < depth; ++i) {
+        program += " + 1)";
+    }
+    program += ";\n}\n";
+    return program;
+}
+
+// 生成depth层嵌套语句块的程序：每层声明一个局部变量，并引用全局变量和外层变量
+static std::string generateNestedScopeProgram(int depth) {
+    std::string program = "int g = 1;\nint main() {\n    int x = 0;\n";
+    for (int i = 0; i < depth; ++i) {
+        std::string name = "v" + std::to_string(i);
+        program += "{ int " + name + " = g; x = x + " + name + ";\n";
+    }
+    program.append(static_cast<size_t>(depth), '}');
+    program += "\n    return x;\n}\n";
+    return program;
+}
+
+// 生成count个层层引用的全局常量：每个常量引用前一个常量和编号为一半的常量，
+// 不缓存常量的值时求值代价随层数指数增长；最后用常量做数组长度并在main中引用
+static std::string generateConstantChainProgram(int count) {
+    std::string program = "const int c0 = 1;\n";
+    for (int i = 1; i < count; ++i) {
+        program += "const int c" + std::to_string(i) + " = c" + std::to_string(i - 1) + " * 3 + c" +
+                   std::to_string(i / 2) + " % 7 + " + std::to_string(i) + ";\n";
+    }
+    std::string last = "c" + std::to_string(count - 1);
+    program += "int table[" + last + " % 100 + 100];\nint main() {\n    return " + last + " - c" +
+               std::to_string(count / 2) + " * 2;\n}\n";
+    return program;
+}
+
+// 计时辅助函数，返回执行func所用的毫秒数
+template <typename Func>
+static double timeMs(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// 旧的关键字识别方式：逐个字符串比较，作为关键字分类基准的对照
+static TokenType classifyKeywordChain(std::string_view word) {
+    if (word == "int") return TokenType::INT;
+    else if (word == "float") return TokenType::FLOAT;
+    else if (word == "void") return TokenType::VOID;
+    else if (word == "if") return TokenType::IF;
+    else if (word == "else") return TokenType::ELSE;
+    else if (word == "while") return TokenType::WHILE;
+    else if (word == "return") return TokenType::RETURN;
+    else if (word == "const") return TokenType::CONST;
+    else if (word == "break") return TokenType::BREAK;
+    else if (word == "continue") return TokenType::CONTINUE;
+    return TokenType::IDENT;
+}
+
+// 关键字分类基准：标识符密集的输入（约三成为关键字），两种实现都通过函数指针调用以避免内联差异
+static void benchKeywords() {
+    static const char* const vocabulary[] = {
+        "i", "j", "n", "sum", "value", "index", "count", "result", "temp", "buffer",
+        "length", "matrix", "idx", "left", "right", "input", "output", "flag", "min_val", "max_val",
+        "data", "iter", "intValue", "floatArr", "whileCount", "returnCode", "constant", "breakPoint", "elem", "cond",
+        "int", "float", "void", "const", "if", "else", "while", "break", "continue", "return",
+        "int", "if", "return", "while",
+    };
+    const size_t vocabularySize = sizeof(vocabulary) / sizeof(vocabulary[0]);
+
+    std::vector<std::string_view> words;
+    unsigned seed = 12345;
+    for (int i = 0; i < 1000000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        words.push_back(vocabulary[(seed >> 16) % vocabularySize]);
+    }
+
+    TokenType (*volatile classifyHash)(std::string_view) = &Lexer::classifyKeyword;
+    TokenType (*volatile classifyChain)(std::string_view) = &classifyKeywordChain;
+
+    const int rounds = 10;
+    size_t keywordCount = 0;
+    double hashMs = timeMs([&] {
+        for (int r = 0; r < rounds; ++r) {
+            for (auto word : words) {
+                keywordCount += classifyHash(word) != TokenType::IDENT;
+            }
+        }
+    });
+    double chainMs = timeMs([&] {
+        for (int r = 0; r < rounds; ++r) {
+            for (auto word : words) {
+                keywordCount += classifyChain(word) != TokenType::IDENT;
+            }
+        }
+    });
+
+    double total = static_cast<double>(words.size()) * rounds;
+    std::cout << "keywords (hash):  " << hashMs * 1e6 / total << " ns/word" << std::endl;
+    std::cout << "keywords (chain): " << chainMs * 1e6 / total << " ns/word"
+              << " (" << words.size() << " words, " << keywordCount / 2 / rounds << " keywords)" << std::endl;
+}
+
+// 批量扫描内核基准：用不同指令集级别对注释密集的源代码做词法分析
+static void benchScanKernels(int funcCount) {
+    std::string source = generateCommentHeavyProgram(funcCount);
+    double megabytes = source.size() / (1024.0 * 1024.0);
+
+    const ScanIsa levels[] = {ScanIsa::SCALAR, ScanIsa::SSE2, ScanIsa::AVX2};
+    for (ScanIsa isa : levels) {
+        if (static_cast<int>(isa) > static_cast<int>(ScanKernels::bestAvailable())) {
+            continue;
+        }
+        size_t tokenCount = 0;
+        double ms = timeMs([&] {
+            Lexer lexer(source);
+            lexer.setScanIsa(isa);
+            while (lexer.getNextToken().type() != TokenType::END_OF_FILE) {
+                tokenCount++;
+            }
+        });
+        std::cout << "lex comment-heavy (" << ScanKernels::isaName(isa) << "): " << ms << " ms, "
+                  << megabytes / (ms / 1000.0) << " MiB/s (" << tokenCount << " tokens)" << std::endl;
+    }
+}
+
+// 表达式解析基准：超长表达式和深度嵌套的表达式，耗时应与Token数成线性关系
+static void benchExpressions() {
+    struct Case {
+        const char* name;
+        std::string source;
+    };
+    const Case cases[] = {
+        {"1000000 terms", generateLongExpressionProgram(1000000)},
+        {"100000 nested parentheses", generateNestedExpressionProgram(100000)},
+    };
+    for (const Case& item : cases) {
+        Lexer lexer(item.source);
+        TokenStream tokens = lexer.tokenize();
+        Arena arena;
+        double ms = timeMs([&] {
+            Parser parser(tokens, arena);
+            parser.parse();
+        });
+        std::cout << "parse expression (" << item.name << "): " << ms << " ms, "
+                  << static_cast<long long>(tokens.size() / (ms / 1000.0)) << " tokens/s" << std::endl;
+    }
+}
+
+// 符号表基准：深度嵌套的作用域中查找全局变量，耗时应与嵌套深度成线性关系
+static void benchNestedScopes(int depth) {
+    std::string source = generateNestedScopeProgram(depth);
+    Lexer lexer(source);
+    TokenStream tokens = lexer.tokenize();
+    Arena arena;
+    Parser parser(tokens, arena);
+    CompUnit* compUnit = parser.parse();
+    double ms = timeMs([&] {
+        SemanticAnalyzer analyzer;
+        analyzer.dispatch(compUnit);
+    });
+    std::cout << "sema (" << depth << " nested scopes): " << ms << " ms" << std::endl;
+}
+
+// 常量求值基准：语义分析对每个常量的初始化表达式求值，常量折叠把引用常量的表达式替换为数字常量，
+// 两者都应与常量个数成线性关系
+static void benchConstants(int count) {
+    std::string source = generateConstantChainProgram(count);
+    Lexer lexer(source);
+    TokenStream tokens = lexer.tokenize();
+    Arena arena;
+    Parser parser(tokens, arena);
+    CompUnit* compUnit = parser.parse();
+    size_t errorCount = 0;
+    double semaMs = timeMs([&] {
+        SemanticAnalyzer analyzer;
+        analyzer.dispatch(compUnit);
+        errorCount = analyzer.getDiagnostics().errorCount();
+    });
+    size_t folded = 0;
+    double foldMs = timeMs([&] {
+        ConstantFolder folder(arena);
+        folder.dispatch(compUnit);
+        folded = folder.foldedCount();
+    });
+    std::cout << "constants (" << count << "): sema " << semaMs << " ms, fold " << foldMs << " ms ("
+              << folded << " folded, " << errorCount << " errors)" << std::endl;
+}
+
+// 语法错误恢复基准：每个函数删掉一个分号，一次分析报告全部语法错误，耗时应与无错误的分析相近
+static void benchSyntaxErrors(const std::string& source, double cleanParseMs) {
+    std::string broken = source;
+    const std::string statement = "int k = a;";
+    for (size_t pos = broken.find(statement); pos != std::string::npos; pos = broken.find(statement, pos)) {
+        pos += statement.size() - 1;
+        broken.erase(pos, 1);
+    }
+
+    Lexer lexer(broken);
+    TokenStream tokens = lexer.tokenize();
+    Arena arena;
+    size_t errorCount = 0;
+    double ms = timeMs([&] {
+        Parser parser(tokens, arena);
+        parser.parse();
+        errorCount = parser.getDiagnostics().size();
+    });
+    std::cout << "parse (errors):  " << ms << " ms (" << errorCount << " syntax errors, "
+              << ms / cleanParseMs << "x clean parse)" << std::endl;
+}
+
+// 通过名字解析的结果读取每个变量和函数调用所绑定的声明的类型，不查符号表
+class BoundDeclReader : public RecursiveASTVisitor<BoundDeclReader> {
+public:
+    size_t bound = 0;      // 已绑定的使用
+    size_t unbound = 0;    // 未绑定的使用（未声明）
+    size_t floats = 0;     // 声明为float的变量的使用
+
+    void visitVariableExpr(VariableExpr& node) {
+        if (VarDef* varDef = dyn_cast<VarDef>(node.getDecl())) {
+            bound++;
+            floats += varDef->getDecl()->getType() == Type::FLOAT;
+        } else if (FuncFParam* param = dyn_cast<FuncFParam>(node.getDecl())) {
+            bound++;
+            floats += param->getType() == Type::FLOAT;
+        } else {
+            unbound++;
+        }
+    }
+    void visitCallExpr(CallExpr& node) {
+        if (node.getDecl() != nullptr) {
+            bound++;
+        } else {
+            unbound++;
+        }
+        RecursiveASTVisitor::visitCallExpr(node);
+    }
+};
+
+// 诊断信息输出基准：大量语义错误逐行用std::endl写出（每行一次刷新），
+// 与先记录到DiagnosticEngine、排序后一次写出相比较；都写到/dev/null，只统计格式化和系统调用的开销
+static void benchDiagnostics(int errorCount) {
+    std::ofstream sink("/dev/null");
+    if (!sink) {
+        return;
+    }
+    Symbol name = StringInterner::global().intern("undeclared");
+    double directMs = timeMs([&] {
+        for (int i = 0; i < errorCount; i++) {
+            sink << "Error type 1 at line " << i + 1 << " : use of undeclared variable '" << name << "'" << std::endl;
+        }
+    });
+    double engineMs = timeMs([&] {
+        DiagnosticEngine diagnostics;
+        for (int i = 0; i < errorCount; i++) {
+            diagnostics.error(1, i + 1, "use of undeclared variable '", name, "'");
+        }
+        diagnostics.render(sink, DiagFormat::TEXT);
+    });
+    std::cout << "diagnostics (" << errorCount << " errors): endl per line " << directMs << " ms, engine "
+              << engineMs << " ms" << std::endl;
+}
+
+// 数字常量扫描基准：统计数字常量密集源代码的词法分析吞吐量
+static void benchNumbers(int funcCount) {
+    std::string source = generateLiteralHeavyProgram(funcCount);
+    size_t literalCount = 0;
+    double ms = timeMs([&] {
+        Lexer lexer(source);
+        TokenStream tokens = lexer.tokenize();
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            TokenType type = tokens.type(i);
+            literalCount += type == TokenType::INT_CONST || type == TokenType::FLOAT_CONST;
+        }
+    });
+    std::cout << "lex (literals):  " << ms << " ms (" << literalCount << " literals, "
+              << static_cast<long long>(literalCount / (ms / 1000.0)) << " literals/s)" << std::endl;
+}
+
+// 遍历整棵指针形式的语法树，统计节点个数和整数常量之和
+class NodeCountVisitor : public ASTVisitor {
+public:
+    size_t nodes = 0;     // 节点个数
+    long long sum = 0;    // 整数常量之和
+
+    void visit(CompUnit& node) override {
+        nodes++;
+        for (Decl* decl : node.getDecls()) decl->accept(*this);
+        for (FuncDef* funcDef : node.getFuncDefs()) funcDef->accept(*this);
+    }
+    void visit(FuncDef& node) override {
+        nodes++;
+        for (FuncFParam* param : node.getParams()) param->accept(*this);
+        node.getBody()->accept(*this);
+    }
+    void visit(VarDecl& node) override {
+        nodes++;
+        for (VarDef* varDef : node.getVarDefs()) varDef->accept(*this);
+    }
+    void visit(IfStmt& node) override {
+        nodes++;
+        node.getCondition()->accept(*this);
+        node.getThenStmt()->accept(*this);
+        if (node.getElseStmt()) node.getElseStmt()->accept(*this);
+    }
+    void visit(WhileStmt& node) override {
+        nodes++;
+        node.getCondition()->accept(*this);
+        node.getBody()->accept(*this);
+    }
+    void visit(BreakStmt&) override { nodes++; }
+    void visit(ContinueStmt&) override { nodes++; }
+    void visit(ReturnStmt& node) override {
+        nodes++;
+        if (node.getExpr()) node.getExpr()->accept(*this);
+    }
+    void visit(BinaryExpr& node) override {
+        nodes++;
+        node.getLeft()->accept(*this);
+        node.getRight()->accept(*this);
+    }
+    void visit(UnaryExpr& node) override {
+        nodes++;
+        node.getOperand()->accept(*this);
+    }
+    void visit(CallExpr& node) override {
+        nodes++;
+        for (Expr* arg : node.getArgs()) arg->accept(*this);
+    }
+    void visit(IndexExpr& node) override {
+        nodes++;
+        node.getBase()->accept(*this);
+        node.getIndex()->accept(*this);
+    }
+    void visit(NumberExpr& node) override {
+        nodes++;
+        if (node.getType() == Type::INT) sum += node.getIntValue();
+    }
+    void visit(VariableExpr&) override { nodes++; }
+    void visit(Block& node) override {
+        nodes++;
+        for (Stmt* stmt : node.getStatements()) stmt->accept(*this);
+    }
+    void visit(VarDef& node) override {
+        nodes++;
+        for (Expr* dim : node.getDims()) if (dim) dim->accept(*this);
+        if (node.getInitExpr()) node.getInitExpr()->accept(*this);
+    }
+    void visit(FuncFParam&) override { nodes++; }
+    void visit(ExprStmt& node) override {
+        nodes++;
+        if (node.getExpr()) node.getExpr()->accept(*this);
+    }
+    void visit(DeclStmt& node) override {
+        nodes++;
+        node.getDecl()->accept(*this);
+    }
+};
+
+// 与NodeCountVisitor相同的统计，改用静态分派的访问者
+class StaticNodeCounter : public RecursiveASTVisitor<StaticNodeCounter> {
+public:
+    size_t nodes = 0;     // 节点个数
+    long long sum = 0;    // 整数常量之和
+
+    void visitCompUnit(CompUnit& node) { nodes++; RecursiveASTVisitor::visitCompUnit(node); }
+    void visitFuncDef(FuncDef& node) { nodes++; RecursiveASTVisitor::visitFuncDef(node); }
+    void visitFuncFParam(FuncFParam&) { nodes++; }
+    void visitVarDecl(VarDecl& node) { nodes++; RecursiveASTVisitor::visitVarDecl(node); }
+    void visitVarDef(VarDef& node) { nodes++; RecursiveASTVisitor::visitVarDef(node); }
+    void visitBlock(Block& node) { nodes++; RecursiveASTVisitor::visitBlock(node); }
+    void visitDeclStmt(DeclStmt& node) { nodes++; RecursiveASTVisitor::visitDeclStmt(node); }
+    void visitExprStmt(ExprStmt& node) { nodes++; RecursiveASTVisitor::visitExprStmt(node); }
+    void visitIfStmt(IfStmt& node) { nodes++; RecursiveASTVisitor::visitIfStmt(node); }
+    void visitWhileStmt(WhileStmt& node) { nodes++; RecursiveASTVisitor::visitWhileStmt(node); }
+    void visitBreakStmt(BreakStmt&) { nodes++; }
+    void visitContinueStmt(ContinueStmt&) { nodes++; }
+    void visitReturnStmt(ReturnStmt& node) { nodes++; RecursiveASTVisitor::visitReturnStmt(node); }
+    void visitBinaryExpr(BinaryExpr& node) { nodes++; RecursiveASTVisitor::visitBinaryExpr(node); }
+    void visitUnaryExpr(UnaryExpr& node) { nodes++; RecursiveASTVisitor::visitUnaryExpr(node); }
+    void visitCallExpr(CallExpr& node) { nodes++; RecursiveASTVisitor::visitCallExpr(node); }
+    void visitIndexExpr(IndexExpr& node) { nodes++; RecursiveASTVisitor::visitIndexExpr(node); }
+    void visitNumberExpr(NumberExpr& node) {
+        nodes++;
+        if (node.getType() == Type::INT) sum += node.getIntValue();
+    }
+    void visitVariableExpr(VariableExpr&) { nodes++; }
+};
+
+// 扁平语法树基准：比较每个节点占用的内存，以及访问者遍历与线性扫描的耗时
+static void benchFlatAst(CompUnit& compUnit, const Arena& arena) {
+    FlatAst flat;
+    double buildMs = timeMs([&] { flat = FlatAst::build(compUnit, arena.allocationCount()); });
+    std::cout << "flat AST:        " << buildMs << " ms to build, " << flat.size() << " nodes, "
+              << flat.memoryBytes() / 1024 << " KiB (" << static_cast<double>(flat.memoryBytes()) / flat.size()
+              << " bytes/node vs " << static_cast<double>(arena.bytesAllocated()) / flat.size()
+              << " in the arena)" << std::endl;
+
+    NodeCountVisitor visitor;
+    double visitMs = timeMs([&] { compUnit.accept(visitor); });
+    StaticNodeCounter counter;
+    double staticMs = timeMs([&] { counter.dispatch(&compUnit); });
+    size_t scanned = 0;
+    long long sum = 0;
+    double scanMs = timeMs([&] {
+        for (NodeIndex node = 0; node < flat.size(); node++) {
+            scanned++;
+            if (flat.kind(node) == NodeKind::INT_LITERAL) sum += flat.intValue(node);
+        }
+    });
+    bool match = visitor.nodes == counter.nodes && counter.nodes == scanned && visitor.sum == counter.sum &&
+                 counter.sum == sum;
+    std::cout << "traverse:        " << visitMs << " ms virtual visitor, " << staticMs << " ms static visitor, "
+              << scanMs << " ms linear scan (" << scanned << " nodes, " << (match ? "results match" : "results differ")
+              << ")" << std::endl;
+}
+
+// 获取进程峰值常驻内存（KiB），不支持的平台返回0
+static long peakRssKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+// 对源文件做词法分析，输出吞吐量和峰值内存
+// 先用分块流式词法分析（内存与文件大小无关），再映射整个文件并生成Token缓冲区；
+// 峰值内存只增不减，所以流式分析放在前面单独统计
+static int benchLexFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        std::cerr << "Error: Could not open file \"" << path << "\"" << std::endl;
+        return 1;
+    }
+    
+    size_t streamCount = 0;
+    double streamMs = timeMs([&] {
+        StreamingLexer lexer(input);
+        while (lexer.getNextToken().type() != TokenType::END_OF_FILE) {
+            streamCount++;
+        }
+    });
+    std::cout << "lex (stream): " << streamMs << " ms, " << static_cast<long long>(streamCount / (streamMs / 1000.0))
+              << " tokens/s, peak RSS " << peakRssKiB() << " KiB" << std::endl;
+    
+    size_t tokenCount = 0;
+    size_t bytes = 0;
+    double ms = timeMs([&] {
+        std::unique_ptr<SourceBuffer> buffer = SourceBuffer::open(path);
+        if (!buffer) {
+            return;
+        }
+        bytes = buffer->text().size();
+        Lexer lexer(buffer->text());
+        TokenStream tokens = lexer.tokenize();
+        tokenCount = tokens.size() - 1;
+    });
+    
+    std::cout << "file:         " << bytes / (1024 * 1024) << " MiB, " << tokenCount << " tokens" << std::endl;
+    std::cout << "lex (mmap):   " << ms << " ms, " << static_cast<long long>(tokenCount / (ms / 1000.0))
+              << " tokens/s, peak RSS " << peakRssKiB() << " KiB" << std::endl;
+    
+    std::unique_ptr<SourceBuffer> buffer = SourceBuffer::open(path);
+#ifdef SYSY_HAVE_FLEX
+    // 对照：flex生成的表驱动扫描器
+    double flexMs = timeMs([&] {
+        FlexScanner scanner(buffer->text());
+        TokenStream flexTokens = scanner.tokenize();
+    });
+    std::cout << "lex (flex):   " << flexMs << " ms, " << static_cast<long long>(tokenCount / (flexMs / 1000.0))
+              << " tokens/s" << std::endl;
+#endif
+    
+    // 并行词法分析：线程数从1开始逐次翻倍，直到硬件线程数
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        size_t count = 0;
+        double parallelMs = timeMs([&] {
+            ParallelLexer lexer(buffer->text(), threads);
+            count = lexer.tokenize().size() - 1;
+        });
+        std::cout << "lex (" << threads << " threads): " << parallelMs << " ms, "
+                  << static_cast<long long>(count / (parallelMs / 1000.0)) << " tokens/s" << std::endl;
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    return 0;
+}
+
+// 翻译为IR：常量折叠之后翻译整个编译单元，再以文本形式输出
+static std::unique_ptr<Module> benchLowering(CompUnit& compUnit, Arena& arena) {
+    ConstantFolder folder(arena);
+    folder.dispatch(&compUnit);
+    std::unique_ptr<Module> module;
+    double lowerMs = timeMs([&] {
+        module = IRLowering::lower(compUnit);
+    });
+    size_t blocks = 0;
+    size_t instructions = 0;
+    for (const auto& function : module->getFunctions()) {
+        blocks += function->getBlockCount();
+        for (BasicBlock* block = function->getEntry(); block; block = block->getNext()) {
+            for (Instruction* inst = block->getFirst(); inst; inst = inst->getNext()) {
+                instructions++;
+            }
+        }
+    }
+    std::ostringstream out;
+    double printMs = timeMs([&] {
+        module->print(out);
+    });
+    std::cout << "lower to IR:     " << lowerMs << " ms (" << module->getFunctions().size() << " functions, "
+              << blocks << " blocks, " << instructions << " instructions), print " << printMs << " ms ("
+              << out.str().size() / 1024 << " KiB)" << std::endl;
+    return module;
+}
+
+// 线性同余随机数，生成控制流图用
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// 生成结构化的控制流图片段：if/else菱形和while循环随机嵌套，then分支偶尔提前返回，
+// 与SysY翻译得到的控制流图形状相同（可归约）；budget为剩余可创建的基本块个数，返回片段的出口块
+static BasicBlock* generateRegion(Function& function, IRBuilder& builder, BasicBlock* current, int& budget,
+                                  int depth, uint32_t& state) {
+    Value* condition = function.getConstant(1);
+    while (budget > 0 && depth < 16 && (depth == 0 || nextRandom(state) % 2 == 0)) {
+        budget -= 3;
+        if (nextRandom(state) % 2 == 0) {
+            BasicBlock* thenBlock = function.createBlock();
+            BasicBlock* elseBlock = function.createBlock();
+            BasicBlock* join = function.createBlock();
+            builder.setInsertPoint(current);
+            builder.createCondBr(condition, thenBlock, elseBlock);
+            BasicBlock* thenEnd = generateRegion(function, builder, thenBlock, budget, depth + 1, state);
+            builder.setInsertPoint(thenEnd);
+            if (nextRandom(state) % 8 == 0) {
+                builder.createRet(nullptr);
+            } else {
+                builder.createBr(join);
+            }
+            BasicBlock* elseEnd = generateRegion(function, builder, elseBlock, budget, depth + 1, state);
+            builder.setInsertPoint(elseEnd);
+            builder.createBr(join);
+            current = join;
+        } else {
+            BasicBlock* header = function.createBlock();
+            BasicBlock* body = function.createBlock();
+            BasicBlock* exit = function.createBlock();
+            builder.setInsertPoint(current);
+            builder.createBr(header);
+            builder.setInsertPoint(header);
+            builder.createCondBr(condition, body, exit);
+            BasicBlock* bodyEnd = generateRegion(function, builder, body, budget, depth + 1, state);
+            builder.setInsertPoint(bodyEnd);
+            builder.createBr(header);
+            current = exit;
+        }
+    }
+    return current;
+}
+
+// 生成约blockCount个基本块的结构化控制流图
+static void generateStructuredCfg(Function& function, int blockCount, uint32_t seed) {
+    IRBuilder builder(&function);
+    int budget = blockCount - 1;
+    uint32_t state = seed;
+    BasicBlock* end = generateRegion(function, builder, function.createBlock(), budget, 0, state);
+    builder.setInsertPoint(end);
+    builder.createRet(nullptr);
+}
+
+// 生成随机控制流图：基本块依次排列，每个块跳到下一个块、条件跳转到附近（向前或向后）或任意位置的块，或者返回；
+// 任意的跳转使图不可归约，用来检查算法的一般情况
+static void generateRandomCfg(Function& function, int blockCount, uint32_t seed) {
+    std::vector<BasicBlock*> blocks(blockCount);
+    for (int i = 0; i < blockCount; i++) {
+        blocks[i] = function.createBlock();
+    }
+    uint32_t state = seed;
+    auto nearby = [&](int i) {
+        int target = i + static_cast<int>(nextRandom(state) % 64) - 32;
+        return blocks[std::min(std::max(target, 0), blockCount - 1)];
+    };
+    IRBuilder builder(&function);
+    Value* condition = function.getConstant(1);
+    for (int i = 0; i < blockCount; i++) {
+        builder.setInsertPoint(blocks[i]);
+        uint32_t choice = nextRandom(state) % 64;
+        if (i == blockCount - 1 || choice == 0) {
+            builder.createRet(nullptr);
+        } else if (choice < 20) {
+            builder.createBr(blocks[i + 1]);
+        } else if (choice < 60) {
+            builder.createCondBr(condition, blocks[i + 1], nearby(i));
+        } else {
+            builder.createCondBr(condition, blocks[i + 1], blocks[nextRandom(state) % blockCount]);
+        }
+    }
+}
+
+// 生成短路求值的条件"if (c && c || c ...)"翻译得到的控制流图：blockCount - 3个条件块依次排列，
+// &&的假出口、||的真出口都直接跳到else块或then块，两个汇合点各有大量前驱，支配者链很长
+static void generateShortCircuitCfg(Function& function, int blockCount, uint32_t seed) {
+    int termCount = std::max(blockCount - 3, 1);
+    std::vector<BasicBlock*> terms(termCount);
+    for (int i = 0; i < termCount; i++) {
+        terms[i] = function.createBlock();
+    }
+    BasicBlock* thenBlock = function.createBlock();
+    BasicBlock* elseBlock = function.createBlock();
+    BasicBlock* exit = function.createBlock();
+    uint32_t state = seed;
+    IRBuilder builder(&function);
+    Value* condition = function.getConstant(1);
+    for (int i = 0; i < termCount; i++) {
+        builder.setInsertPoint(terms[i]);
+        if (i == termCount - 1) {
+            builder.createCondBr(condition, thenBlock, elseBlock);
+        } else if (nextRandom(state) % 4 != 0) {
+            builder.createCondBr(condition, terms[i + 1], elseBlock); // &&
+        } else {
+            builder.createCondBr(condition, thenBlock, terms[i + 1]); // ||
+        }
+    }
+    builder.setInsertPoint(thenBlock);
+    builder.createBr(exit);
+    builder.setInsertPoint(elseBlock);
+    builder.createBr(exit);
+    builder.setInsertPoint(exit);
+    builder.createRet(nullptr);
+}
+
+// 朴素算法：位集合上的迭代数据流求支配集合，dom[b]为b的全部支配者；图为按编号表示的后继表
+static std::vector<std::vector<bool>> naiveDominators(const std::vector<std::vector<int>>& succs, int root) {
+    size_t n = succs.size();
+    std::vector<std::vector<int>> preds(n);
+    for (size_t i = 0; i < n; i++) {
+        for (int target : succs[i]) {
+            preds[target].push_back(static_cast<int>(i));
+        }
+    }
+    std::vector<std::vector<bool>> dom(n, std::vector<bool>(n, true));
+    dom[root].assign(n, false);
+    dom[root][root] = true;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = 0; b < n; b++) {
+            if (static_cast<int>(b) == root) {
+                continue;
+            }
+            std::vector<bool> set(n, true);
+            for (int pred : preds[b]) {
+                for (size_t i = 0; i < n; i++) {
+                    set[i] = set[i] && dom[pred][i];
+                }
+            }
+            set[b] = true;
+            if (set != dom[b]) {
+                dom[b] = set;
+                changed = true;
+            }
+        }
+    }
+    return dom;
+}
+
+// 用朴素算法检查支配树、后支配树和支配边界
+static bool verifyDominators(int blockCount, uint32_t seed, void (*generate)(Function&, int, uint32_t)) {
+    Function function(Symbol(0), IRType::VOID);
+    generate(function, blockCount, seed);
+    DominatorTree domTree(function);
+    PostDominatorTree postDomTree(function);
+    DominanceFrontier frontier(domTree);
+
+    std::vector<BasicBlock*> blocks;
+    for (BasicBlock* block = function.getEntry(); block; block = block->getNext()) {
+        blocks.push_back(block);
+    }
+    int n = static_cast<int>(blocks.size());
+    // 正向图；反向图中编号n为虚拟出口
+    std::vector<std::vector<int>> succs(n);
+    std::vector<std::vector<int>> reverse(n + 1);
+    for (int i = 0; i < n; i++) {
+        for (uint32_t k = 0; k < blocks[i]->getSuccessorCount(); k++) {
+            int target = static_cast<int>(blocks[i]->getSuccessor(k)->getIndex());
+            succs[i].push_back(target);
+            reverse[target].push_back(i);
+        }
+        if (blocks[i]->getSuccessorCount() == 0) {
+            reverse[n].push_back(i);
+        }
+    }
+    std::vector<std::vector<bool>> dom = naiveDominators(succs, 0);
+    std::vector<std::vector<bool>> postDom = naiveDominators(reverse, n);
+
+    for (int a = 0; a < n; a++) {
+        for (int b = 0; b < n; b++) {
+            if (domTree.dominates(blocks[a], blocks[b]) != dom[b][a] ||
+                postDomTree.dominates(blocks[a], blocks[b]) != postDom[b][a]) {
+                return false;
+            }
+        }
+    }
+    // b在a的支配边界中：a支配b的某个可达前驱，但不严格支配b
+    for (int a = 0; a < n; a++) {
+        std::vector<bool> expected(n, false);
+        if (domTree.isReachable(blocks[a])) {
+            for (int p = 0; p < n; p++) {
+                if (!domTree.isReachable(blocks[p]) || !dom[p][a]) {
+                    continue;
+                }
+                for (int b : succs[p]) {
+                    expected[b] = expected[b] || a == b || !dom[b][a];
+                }
+            }
+        }
+        std::vector<bool> actual(n, false);
+        for (BasicBlock* block : frontier.get(blocks[a])) {
+            if (actual[block->getIndex()]) {
+                return false;
+            }
+            actual[block->getIndex()] = true;
+        }
+        if (actual != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 在一个函数上分别计时支配树、支配边界和后支配树，并对比常数时间查询与沿直接支配者链向上查找
+static void benchDominatorsOn(Function& function, const char* label) {
+    std::unique_ptr<DominatorTree> domTree;
+    double domMs = timeMs([&] {
+        domTree = std::make_unique<DominatorTree>(function);
+    });
+    std::unique_ptr<DominanceFrontier> frontier;
+    double frontierMs = timeMs([&] {
+        frontier = std::make_unique<DominanceFrontier>(*domTree);
+    });
+    std::unique_ptr<PostDominatorTree> postDomTree;
+    double postDomMs = timeMs([&] {
+        postDomTree = std::make_unique<PostDominatorTree>(function);
+    });
+    const std::vector<BasicBlock*>& order = domTree->getReversePostOrder();
+    size_t frontierSize = 0;
+    for (BasicBlock* block : order) {
+        frontierSize += frontier->get(block).size();
+    }
+
+    // 支配树很深时沿链查找很慢，只取前walkCount个查询对照
+    const size_t queryCount = 1000000;
+    const size_t walkCount = 10000;
+    std::vector<std::pair<BasicBlock*, BasicBlock*>> queries(queryCount);
+    uint32_t state = 7;
+    for (auto& query : queries) {
+        query.first = order[nextRandom(state) % order.size()];
+        query.second = order[nextRandom(state) % order.size()];
+    }
+    std::vector<bool> fastResults(queryCount);
+    double fastMs = timeMs([&] {
+        for (size_t i = 0; i < queryCount; i++) {
+            fastResults[i] = domTree->dominates(queries[i].first, queries[i].second);
+        }
+    });
+    std::vector<bool> walkResults(walkCount);
+    double walkMs = timeMs([&] {
+        for (size_t i = 0; i < walkCount; i++) {
+            BasicBlock* runner = queries[i].second;
+            while (runner != nullptr && runner != queries[i].first) {
+                runner = domTree->getIdom(runner);
+            }
+            walkResults[i] = runner != nullptr;
+        }
+    });
+    bool match = std::equal(walkResults.begin(), walkResults.end(), fastResults.begin());
+
+    std::cout << "dominators (" << label << ", " << function.getBlockCount() << " blocks): tree " << domMs << " ms ("
+              << domMs * 1e6 / function.getBlockCount() << " ns/block), frontier " << frontierMs << " ms ("
+              << frontierSize << " entries), postdom " << postDomMs << " ms; query " << fastMs * 1e6 / queryCount
+              << " ns vs idom walk " << walkMs * 1e6 / walkCount << " ns (" << (match ? "results match" : "results differ")
+              << ")" << std::endl;
+}
+
+// 支配树：与朴素算法对照检查，生成的控制流图上的规模测试，以及翻译得到的整个模块
+static void benchDominators(Module& module) {
+    bool match = true;
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        int blockCount = static_cast<int>(50 + seed * 10);
+        match = match && verifyDominators(blockCount, seed, generateStructuredCfg) &&
+                verifyDominators(blockCount, seed, generateRandomCfg) &&
+                verifyDominators(blockCount, seed, generateShortCircuitCfg);
+    }
+    std::cout << "dominators:      naive dataflow check on 60 CFGs, " << (match ? "results match" : "results differ")
+              << std::endl;
+
+    for (int blockCount : {1000, 10000, 100000, 1000000}) {
+        Function function(Symbol(0), IRType::VOID);
+        generateStructuredCfg(function, blockCount, 12345);
+        benchDominatorsOn(function, "if/while");
+    }
+    Function irreducible(Symbol(0), IRType::VOID);
+    generateRandomCfg(irreducible, 100000, 12345);
+    benchDominatorsOn(irreducible, "irreducible");
+    // 一长串&&、||：逐个前驱求支配者链交点的迭代算法在这里是平方的（16000项约0.8秒）
+    for (int blockCount : {16000, 100000}) {
+        Function function(Symbol(0), IRType::VOID);
+        generateShortCircuitCfg(function, blockCount, 12345);
+        benchDominatorsOn(function, "&&/|| chain");
+    }
+
+    size_t blocks = 0;
+    double moduleMs = timeMs([&] {
+        for (const auto& function : module.getFunctions()) {
+            DominatorTree domTree(*function);
+            DominanceFrontier frontier(domTree);
+            PostDominatorTree postDomTree(*function);
+            blocks += domTree.getReversePostOrder().size();
+        }
+    });
+    std::cout << "dominators (module): " << moduleMs << " ms (" << module.getFunctions().size() << " functions, "
+              << blocks << " blocks, tree + frontier + postdom)" << std::endl;
+}
+
+// 优化流水线：-O2的各Pass和分析在翻译得到的模块上的耗时
+static void benchPasses(Module& module) {
+    PassManager passManager;
+    addOptimizationPipeline(passManager, 2);
+    passManager.setTimePasses(true);
+    double runMs = timeMs([&] {
+        passManager.run(module);
+    });
+    std::cout << "-O2 pipeline:    " << runMs << " ms (" << passManager.size() << " passes)" << std::endl;
+    passManager.printTimeReport(std::cout);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && !std::isdigit(static_cast<unsigned char>(argv[1][0]))) {
+        return benchLexFile(argv[1]);
+    }
+
+    int funcCount = argc > 1 ? std::atoi(argv[1]) : 20000;
+    if (funcCount <= 0) {
+        std::cerr << "Usage: sysy_bench [function_count | source_file]" << std::endl;
+        return 1;
+    }
+
+    std::string source = generateProgram(funcCount);
+    std::cout << "source: " << source.size() / 1024 << " KiB, " << funcCount << " functions" << std::endl;
+
+    // 词法分析：一次性生成Token缓冲区
+    TokenStream tokens;
+    double lexMs = timeMs([&] {
+        Lexer lexer(source);
+        tokens = lexer.tokenize();
+    });
+    std::cout << "lex:             " << lexMs << " ms (" << tokens.size() << " tokens)" << std::endl;
+#ifdef SYSY_HAVE_FLEX
+    // 对照：flex生成的表驱动扫描器
+    double flexMs = timeMs([&] {
+        FlexScanner scanner(source);
+        TokenStream flexTokens = scanner.tokenize();
+    });
+    std::cout << "lex (flex):      " << flexMs << " ms" << std::endl;
+#endif
+    std::cout << "token buffer:    " << tokens.memoryBytes() / 1024 << " KiB ("
+              << static_cast<double>(tokens.memoryBytes()) / tokens.size() << " bytes/token, "
+              << sizeof(Token) << "-byte Token)" << std::endl;
+
+    benchKeywords();
+    benchScanKernels(funcCount);
+    benchNumbers(funcCount);
+
+    // 流式词法分析：每取一个Token前都预览后续两个Token
+    double peekMs = timeMs([&] {
+        Lexer lexer(source);
+        while (lexer.getNextToken().type() != TokenType::END_OF_FILE) {
+            lexer.peekToken(1);
+            lexer.peekToken(2);
+        }
+    });
+    std::cout << "lex + peek(1,2): " << peekMs << " ms" << std::endl;
+
+    // 语法分析：直接读取Token缓冲区，语法树节点分配在Arena中
+    Arena arena;
+    CompUnit* compUnit = nullptr;
+    size_t heapBefore = heapAllocations;
+    double parseMs = timeMs([&] {
+        Parser parser(tokens, arena);
+        compUnit = parser.parse();
+    });
+    std::cout << "parse:           " << parseMs << " ms (" << arena.allocationCount() << " arena allocations, "
+              << arena.bytesAllocated() / 1024 << " KiB in " << arena.getBlockCount() << " blocks, "
+              << heapAllocations - heapBefore << " heap allocations)" << std::endl;
+
+    // 语法分析加上释放整棵语法树
+    double parseFreeMs = timeMs([&] {
+        Arena scratch;
+        Parser parser(tokens, scratch);
+        parser.parse();
+    });
+    std::cout << "parse + free:    " << parseFreeMs << " ms" << std::endl;
+    benchFlatAst(*compUnit, arena);
+    benchSyntaxErrors(source, parseMs);
+    benchExpressions();
+
+    // 语义分析：函数体按线程数并行检查
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        double semaMs = timeMs([&] {
+            SemanticAnalyzer analyzer(threads);
+            analyzer.dispatch(compUnit);
+        });
+        std::cout << "sema (" << threads << " threads): " << semaMs << " ms" << std::endl;
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    // 语义分析之后，后续阶段通过绑定直接读取声明
+    BoundDeclReader reader;
+    double bindingMs = timeMs([&] {
+        reader.dispatch(compUnit);
+    });
+    std::cout << "bound uses:      " << bindingMs << " ms (" << reader.bound << " bound, " << reader.unbound
+              << " unbound, " << reader.floats << " float)" << std::endl;
+    std::unique_ptr<Module> module = benchLowering(*compUnit, arena);
+    benchDominators(*module);
+    benchPasses(*module);
+    benchNestedScopes(5000);
+    benchConstants(20000);
+    benchDiagnostics(100000);
+
+    // 对照：旧流程对同一份源代码进行两次完整的词法分析
+    double doubleLexMs = timeMs([&] {
+        Lexer first(source);
+        TokenStream dump = first.tokenize();
+        Lexer second(source);
+        TokenStream reparse = second.tokenize();
+    });
+
+    std::cout << "front-end (single lex): " << lexMs + parseMs << " ms" << std::endl;
+    std::cout << "front-end (double lex): " << doubleLexMs + parseMs << " ms" << std::endl;
+    return 0;
+}
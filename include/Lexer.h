@@ -1,21 +1,52 @@
 #pragma once
 #include "token.h"
+#include "token_stream.h"
+#include "scan_kernels.h"
+#include <array>
 #include <string>
+#include <string_view>
+#include <vector>
 
 // Lexer类 - 词法分析器，负责将源代码字符串转换为Token流
+// 词法分析器和Token都只引用源代码，调用者需保证源代码在它们之前不被释放
 class Lexer {
+public:
+    // 预览窗口容量：peekToken(n)允许的最大n
+    static constexpr size_t MAX_LOOKAHEAD = 8;
+    
+    // 数字常量的扫描结果
+    struct NumberLiteral {
+        TokenType type;        // INT_CONST或FLOAT_CONST，非法常量为UNKNOWN
+        size_t length;         // 常量原文的长度（非法常量为需要跳过的长度）
+        union {
+            int intValue;      // 整数值（超过INT_MAX的十六进制、八进制常量和2147483648按32位补码保存）
+            float floatValue;  // 浮点数值
+        };
+        const char* error;     // 非法常量的错误描述，完整的错误信息为：描述 '原文'
+    };
+    
 private:
-    std::string source;   // 源代码字符串
+    std::string_view source; // 源代码（不复制）
     size_t position;      // 当前字符位置
     size_t line;          // 当前行号
     size_t column;        // 当前列号
     char currentChar;     // 当前字符
+    const ScanKernels* kernels; // 空白、注释和标识符的批量扫描内核
+    StringInterner* interner;   // 标识符驻留表（默认为进程范围的驻留表）
+    
+    // 预览窗口：已扫描但尚未被getNextToken取走的Token组成的环形缓冲区
+    std::array<Token, MAX_LOOKAHEAD> lookahead;
+    size_t lookaheadHead;  // 窗口中第一个Token的下标
+    size_t lookaheadCount; // 窗口中的Token数量
+    
+    std::vector<std::string> errorMessages; // 错误信息旁路表，UNKNOWN Token通过errorIndex引用
     
     // 私有方法：字符处理函数
     void advance();       // 前进到下一个字符
+    void moveTo(size_t newPosition, const ScanLines& lines); // 批量扫描后移动到指定位置
     char peek();          // 预览下一个字符
     void skipWhitespace();// 跳过空白字符（空格、制表符、换行符等）
-    void skipComment();   // 跳过注释
+    void skipComment();   // 跳过空白字符和注释
     bool isDigit(char c); // 检查字符是否为数字
     bool isAlpha(char c); // 检查字符是否为字母
     bool isAlnum(char c); // 检查字符是否为字母或数字
@@ -24,11 +55,15 @@ private:
     Token parseNumber();  // 解析数字常量（整数或浮点数）
     Token parseIdentifier(); // 解析标识符或关键字
     Token parseString();  // 解析字符串常量
+    Token scanToken();    // 从源代码中扫描出下一个Token（不经过预览窗口）
+    void setError(Token& token, std::string message); // 把Token标记为UNKNOWN并记录错误信息
+    void finishToken(Token& token, size_t start);     // 根据起始位置和当前位置填写Token的原文位置
     
 public:
     // 构造函数：初始化词法分析器
-    // 参数：source - 要分析的源代码字符串（常量引用）
-    Lexer(const std::string& source);
+    // 参数：source - 要分析的源代码，生命周期需覆盖词法分析器及其产生的Token
+    //       firstLine - source第一行的行号（分块分析时为块在整个文件中的起始行）
+    Lexer(std::string_view source, size_t firstLine = 1);
     
     // 获取下一个Token
     // 返回：解析出的下一个Token
@@ -36,14 +71,51 @@ public:
     
     // 预览下一个Token（不消耗Token）
     // 返回：预览到的Token
-    Token peekToken();
+    const Token& peekToken();
     
-    // 预览第n个Token（不消耗Token）
-    // 参数：n - 要预览的Token索引（从0开始）
-    // 返回：预览到的Token
-    Token peekToken(int n);
+    // 预览第n个Token（不消耗Token），每个Token只扫描一次，预览本身是数组访问
+    // 参数：n - 要预览的Token序号，从1开始：peekToken(1)与peekToken()相同，都是下一个Token；
+    //       最多预览MAX_LOOKAHEAD（8）个Token
+    // 返回：预览到的Token，引用在下一次调用getNextToken前有效
+    // 异常：n小于1或大于MAX_LOOKAHEAD时抛出std::out_of_range
+    const Token& peekToken(int n);
+    
+    // 一次性扫描全部源代码，生成物化的Token缓冲区
+    // 返回：按顺序排列的Token序列（末尾总是END_OF_FILE），供Token输出和语法分析共同使用
+    TokenStream tokenize();
+    
+    // 获取UNKNOWN Token的错误信息
+    // 参数：token - 由本词法分析器产生的UNKNOWN Token
+    const std::string& getErrorMessage(const Token& token) const;
+    
+    // 获取Token在源代码中的原文
+    std::string_view lexeme(const Token& token) const { return source.substr(token.offset, token.length()); }
+    
+    // 选择批量扫描内核的指令集级别（默认使用CPU支持的最高级别）
+    void setScanIsa(ScanIsa isa);
+    
+    // 使用指定的驻留表驻留标识符（并行词法分析时每个线程使用局部驻留表）
+    // 此后产生的标识符Token的symbol是该驻留表中的编号，不能直接调用Symbol::str()
+    void setInterner(StringInterner& table) { interner = &table; }
+    
+    // 关键字分类
+    // 参数：word - 标识符原文
+    // 返回：对应的关键字Token类型，不是关键字时返回IDENT
+    static TokenType classifyKeyword(std::string_view word);
+    
+    // 扫描数字常量
+    // 直接读取源代码字节，不分配内存、不抛出异常，支持SysY的全部常量形式：
+    // 十进制、八进制和十六进制整数，带指数的十进制浮点数（包括".5"和"1."），以及十六进制浮点数
+    // 参数：text - 常量的起始位置（数字，或后面跟数字的'.'）
+    //       size - 最多读取的字节数
+    // 返回：常量的类型、长度和值
+    static NumberLiteral scanNumber(const char* text, size_t size);
     
     // 获取当前行号
-    // 返回：当前处理的行号
+    // 返回：当前扫描到的行号（预览过的Token也已计入）
     size_t getLine() const { return line; }
+    
+    // 获取当前扫描位置
+    // 返回：下一个待扫描字符在源代码中的下标（预览过的Token也已计入）
+    size_t getPosition() const { return position; }
 };
\ No newline at end of file
@@ -1,33 +1,66 @@
 #pragma once
 #include "token.h"
+#include "token_stream.h"
 #include "ast.h"
+#include "arena.h"
+#include "diagnostics.h"
 #include <string>
-#include <memory>
-
-// 使用前向声明替代包含Lexer.h
-class Lexer;
+#include <vector>
 
+// 语法分析器直接按下标读取Lexer::tokenize()生成的Token缓冲区，不再重新进行词法分析
+// 语法树节点全部分配在调用者提供的Arena中，语法树的生存期与Arena相同
+// 语法错误不抛出异常：记录错误后进入恐慌模式，在语句边界（';'和'}'）同步后继续分析，一次报告所有语法错误
 class Parser {
 private:
-    Lexer& lexer;
-    Token currentToken;
+    const TokenStream& tokens; // Token缓冲区（末尾为END_OF_FILE）
+    size_t position;           // 当前Token在缓冲区中的下标
+    Arena& arena;              // 语法树节点所在的Arena
+    std::vector<ASTNode*> pending; // 正在收集的子节点列表（嵌套的列表依次压在后面）
+    DiagnosticEngine diagnostics;  // 已记录的语法错误
+    bool failed;                   // 是否处于恐慌模式（已报告错误，尚未同步）
+    int parenDepth;                // 上次同步以来已消费但尚未闭合的'('个数
+    
+    // 表达式解析中运算符栈的一项：运算符，或者尚未闭合的括号、数组下标、函数调用
+    struct OperatorEntry {
+        enum class Kind : uint8_t { BINARY, UNARY, GROUP, INDEX, CALL };
+        Kind kind;        // 项的种类
+        TokenType op;     // 运算符类型（BINARY、UNARY）
+        Symbol callee;    // 被调用的函数名（CALL）
+        uint32_t argMark; // 实参在pending中的起始位置（CALL）
+        int line;         // 运算符或左括号所在的行号
+    };
+    std::vector<Expr*> operands;           // 表达式解析的操作数栈
+    std::vector<OperatorEntry> operators;  // 表达式解析的运算符栈
     
     // 解析方法
-    std::unique_ptr<FuncDef> parseFuncDef();
-    std::unique_ptr<Expr> parseExpression();
-    std::unique_ptr<Expr> parseBinaryExpression();
-    std::unique_ptr<Expr> parseUnaryExpression();
-    std::unique_ptr<Expr> parsePrimaryExpression();
-    std::unique_ptr<Stmt> parseStatement();
+    FuncDef* parseFuncDef();
+    Expr* parseExpression();
+    Stmt* parseStatement();
     
     // 辅助方法
-    void parseFuncParams(std::vector<std::unique_ptr<FuncFParam>>& params);
-    std::unique_ptr<VarDecl> parseVarDef();
+    NodeList<FuncFParam> parseFuncParams();
+    VarDecl* parseVarDef();
     void parseStatementList(Block& block);
-    void consumeToken(TokenType expectedType);
+    Block* parseBlock();
+    template <typename T>
+    NodeList<T> finishList(size_t mark);
+    static int precedence(const OperatorEntry& entry);
+    void reduceOperator();
+    void reduceOperators(int minPrecedence, size_t operatorBase);
+    bool consumeToken(TokenType expectedType);
+    // 记录语法错误，说明文字由各个参数依次拼接而成
+    template <typename... Args>
+    void reportError(const Args&... args);
+    void synchronize();
+    void advanceToken();
+    TokenType peekType(size_t n) const;
+    TokenType currentType() const { return tokens.type(position); }
+    int currentLine() const { return tokens.line(position); }
     
 public:
-    Parser(Lexer& lexer);
-    std::unique_ptr<CompUnit> parse();
-    size_t getLine() const { return lexer.getLine(); }
+    Parser(const TokenStream& tokens, Arena& arena);
+    CompUnit* parse();
+    bool hasErrors() const { return diagnostics.hasErrors(); }
+    const DiagnosticEngine& getDiagnostics() const { return diagnostics; }
+    size_t getLine() const { return currentLine(); }
 };
\ No newline at end of file
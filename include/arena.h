@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// NodeList - 分配在Arena中的定长指针数组
+// 由语法分析器在子节点全部解析完后一次性生成，之后不再改变；本身只是一个视图，可以按值传递
+template <typename T>
+class NodeList {
+private:
+    T* const* items; // 指向Arena中的指针数组
+    size_t count;    // 元素个数
+
+public:
+    NodeList() : items(nullptr), count(0) {}
+    NodeList(T* const* items, size_t count) : items(items), count(count) {}
+
+    T* const* begin() const { return items; }
+    T* const* end() const { return items + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T* operator[](size_t index) const { return items[index]; }
+};
+
+// Arena类 - 语法树节点的区域分配器
+// 节点按分配顺序依次放在大块内存中，同一个函数的节点在内存中连续存放；
+// Arena析构时整块释放，不会逐个调用节点的析构函数，因此放入Arena的对象不能持有需要析构的资源
+class Arena {
+private:
+    // 内存块头部，块的数据区紧跟在头部之后
+    struct Block {
+        Block* next; // 上一个分配的块
+        size_t size; // 数据区大小
+    };
+
+    static constexpr size_t MIN_BLOCK_SIZE = 4 * 1024; // 第一个内存块的数据区大小
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;    // 普通内存块数据区大小的上限
+
+    Block* blocks;      // 最近分配的块（链表头）
+    size_t nextBlockSize; // 下一个普通块的数据区大小：从MIN_BLOCK_SIZE起每次翻倍，直到BLOCK_SIZE
+    char* cursor;       // 当前块中下一个可用位置
+    char* limit;        // 当前块数据区的末尾
+    size_t allocations; // 累计分配的对象个数
+    size_t bytes;       // 累计分配的字节数（不含对齐填充）
+    size_t blockCount;  // 向系统申请的内存块个数
+
+    // 当前块空间不足时申请新块，返回满足对齐要求的地址
+    void* allocateSlow(size_t size, size_t align);
+
+public:
+    Arena();
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // 分配size字节、按align对齐的内存
+    void* allocate(size_t size, size_t align) {
+        allocations++;
+        bytes += size;
+        uintptr_t address = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t(align) - 1);
+        if (cursor != nullptr && address + size <= reinterpret_cast<uintptr_t>(limit)) {
+            cursor = reinterpret_cast<char*>(address + size);
+            return reinterpret_cast<void*>(address);
+        }
+        return allocateSlow(size, align);
+    }
+
+    // 在Arena中构造一个对象
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // 分配count个T类型元素的数组（不初始化）
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // 把count个指针复制到Arena中，生成NodeList
+    template <typename T>
+    NodeList<T> copyList(T* const* items, size_t count) {
+        if (count == 0) {
+            return NodeList<T>();
+        }
+        T** copy = allocateArray<T*>(count);
+        std::memcpy(copy, items, count * sizeof(T*));
+        return NodeList<T>(copy, count);
+    }
+
+    // 累计分配的对象个数
+    size_t allocationCount() const { return allocations; }
+    // 累计分配的字节数
+    size_t bytesAllocated() const { return bytes; }
+    // 向系统申请的内存块个数
+    size_t getBlockCount() const { return blockCount; }
+};
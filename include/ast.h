@@ -1,8 +1,8 @@
 #pragma once
-#include <vector>
-#include <memory>
 #include <string>
 #include "token.h"
+#include "interner.h"
+#include "arena.h"
 
 // 前向声明ASTVisitor类，用于实现访问者模式
 class ASTVisitor;
@@ -14,10 +14,29 @@ enum class Type {
     VOID     // 空类型
 };
 
+// 语法树节点的种类（占1字节），指针形式的语法树和扁平编码（flat_ast.h）共用
+// 同一类别的节点编号连续（语句从BLOCK到RETURN_STMT，表达式从BINARY_EXPR到VARIABLE_EXPR），便于按范围判断
+enum class NodeKind : uint8_t {
+    COMP_UNIT, FUNC_DEF, FUNC_PARAM, VAR_DECL, VAR_DEF,
+    BLOCK, DECL_STMT, EXPR_STMT, IF_STMT, WHILE_STMT, BREAK_STMT, CONTINUE_STMT, RETURN_STMT,
+    BINARY_EXPR, UNARY_EXPR, CALL_EXPR, INDEX_EXPR, INT_LITERAL, FLOAT_LITERAL, VARIABLE_EXPR
+};
+
 // 抽象语法树(AST)节点的基类
+// 所有节点都由语法分析器在Arena中分配，子节点以裸指针和NodeList引用，随Arena一起整体释放；
+// 节点的析构函数不会被调用，因此节点中不能持有std::vector、std::string等需要析构的成员
+// 每个节点在构造时记录自己的种类，isa/cast/dyn_cast据此判断节点类型，静态访问者（ast_visitor.h）据此分派
 class ASTNode {
+private:
+    NodeKind kind; // 节点种类
+
+protected:
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
+
 public:
-    virtual ~ASTNode() = default; // 虚析构函数，确保子类正确析构
+    virtual ~ASTNode() = default;
+    // 获取节点种类
+    NodeKind getKind() const { return kind; }
     virtual void accept(ASTVisitor& visitor) = 0; // 接受访问者，实现访问者模式
     virtual int getLine() const = 0; // 获取节点所在行号
 };
@@ -28,27 +47,61 @@ class FuncDef;
 class Stmt;
 class Expr;
 class VarDef;
+class VarDecl;
 class FuncFParam;
 class Block;
 
+// 按节点种类判断类型（LLVM风格），代替dynamic_cast，不需要RTTI
+// isa<T>(node)：node是否为T类型；cast<T>(node)：已知类型时直接转换；dyn_cast<T>(node)：类型不符时返回nullptr
+template <typename T>
+inline bool isa(const ASTNode* node) {
+    return T::classof(node);
+}
+
+template <typename T>
+inline T* cast(ASTNode* node) {
+    return static_cast<T*>(node);
+}
+
+template <typename T>
+inline T* dyn_cast(ASTNode* node) {
+    return node != nullptr && T::classof(node) ? static_cast<T*>(node) : nullptr;
+}
+
 // 声明类的基类，继承自ASTNode
 class Decl : public ASTNode {
+protected:
+    explicit Decl(NodeKind kind) : ASTNode(kind) {}
+
 public:
     virtual ~Decl() = default;
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::VAR_DECL; }
     virtual void accept(ASTVisitor& visitor) = 0;
 };
 
 // 语句类的基类，继承自ASTNode
 class Stmt : public ASTNode {
+protected:
+    explicit Stmt(NodeKind kind) : ASTNode(kind) {}
+
 public:
     virtual ~Stmt() = default;
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= NodeKind::BLOCK && node->getKind() <= NodeKind::RETURN_STMT;
+    }
     virtual void accept(ASTVisitor& visitor) = 0;
 };
 
 // 表达式类的基类，继承自ASTNode
 class Expr : public ASTNode {
+protected:
+    explicit Expr(NodeKind kind) : ASTNode(kind) {}
+
 public:
     virtual ~Expr() = default;
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= NodeKind::BINARY_EXPR && node->getKind() <= NodeKind::VARIABLE_EXPR;
+    }
     virtual void accept(ASTVisitor& visitor) = 0;
     virtual Type getType() const = 0; // 获取表达式类型
 };
@@ -56,25 +109,40 @@ public:
 // 变量定义节点类
 class VarDef : public ASTNode {
 private:
-    std::string name;              // 变量名
-    std::unique_ptr<Expr> initExpr; // 变量初始化表达式
+    Symbol name;                   // 变量名
+    Expr* initExpr; // 变量初始化表达式
+    NodeList<Expr> dims;           // 数组各维长度的表达式，省略长度的维为nullptr
     bool isArray;                  // 是否为数组
+    VarDecl* decl;                 // 所属的变量声明（类型、是否为常量）
     int line;                      // 节点所在行号
 
 public:
     // 构造函数
-    VarDef(const std::string& name, std::unique_ptr<Expr> initExpr = nullptr, bool isArray = false, int line = 1)
-        : name(name), initExpr(std::move(initExpr)), isArray(isArray), line(line) {}
+    VarDef(Symbol name, Expr* initExpr = nullptr, bool isArray = false, int line = 1)
+        : ASTNode(NodeKind::VAR_DEF), name(name), initExpr(initExpr), isArray(isArray), decl(nullptr), line(line) {}
 
     // 获取变量名
-    const std::string& getName() const { return name; }
+    Symbol getName() const { return name; }
     // 获取初始化表达式
-    Expr* getInitExpr() const { return initExpr.get(); }
+    Expr* getInitExpr() const { return initExpr; }
+    // 设置初始化表达式（常量折叠）
+    void setInitExpr(Expr* value) { initExpr = value; }
+    // 获取数组各维长度的表达式
+    const NodeList<Expr>& getDims() const { return dims; }
+    // 设置数组各维长度的表达式
+    void setDims(NodeList<Expr> value) { dims = value; }
     // 判断是否为数组
     bool getIsArray() const { return isArray; }
+    // 获取所属的变量声明
+    VarDecl* getDecl() const { return decl; }
+    // 设置所属的变量声明
+    void setDecl(VarDecl* value) { decl = value; }
     // 获取节点所在行号
     int getLine() const override { return line; }
 
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::VAR_DEF; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -83,7 +151,7 @@ public:
 class FuncFParam : public ASTNode {
 private:
     Type type;           // 形参类型
-    std::string name;    // 形参名
+    Symbol name;         // 形参名
     bool isArray;        // 是否为数组类型
     int arraySize;       // 数组大小
     int line;            // 节点所在行号
@@ -91,13 +159,13 @@ private:
 public:
     FuncFParam() = default; // 默认构造函数
     // 带参构造函数
-    FuncFParam(Type type, const std::string& name, bool isArray = false, int line = 1)
-        : type(type), name(name), isArray(isArray), arraySize(0), line(line) {}
+    FuncFParam(Type type, Symbol name, bool isArray = false, int line = 1)
+        : ASTNode(NodeKind::FUNC_PARAM), type(type), name(name), isArray(isArray), arraySize(0), line(line) {}
 
     // 获取形参类型
     Type getType() const { return type; }
     // 获取形参名
-    const std::string& getName() const { return name; }
+    Symbol getName() const { return name; }
     // 判断是否为数组类型
     bool getIsArray() const { return isArray; }
     // 获取数组大小
@@ -108,12 +176,15 @@ public:
     // 设置形参类型
     void setType(Type value) { type = value; }
     // 设置形参名
-    void setName(const std::string& value) { name = value; }
+    void setName(Symbol value) { name = value; }
     // 设置是否为数组类型
     void setIsArray(bool value) { isArray = value; }
     // 设置数组大小
     void setArraySize(int value) { arraySize = value; }
 
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::FUNC_PARAM; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -121,22 +192,27 @@ public:
 // 编译单元节点类，代表整个程序
 class CompUnit : public ASTNode {
 private:
-    std::vector<std::unique_ptr<Decl>> decls;     // 全局声明列表
-    std::vector<std::unique_ptr<FuncDef>> funcDefs; // 函数定义列表
+    NodeList<Decl> decls;     // 全局声明列表
+    NodeList<FuncDef> funcDefs; // 函数定义列表
 
 public:
-    // 添加全局声明
-    void addDecl(std::unique_ptr<Decl> decl) { decls.push_back(std::move(decl)); }
-    // 添加函数定义
-    void addFuncDef(std::unique_ptr<FuncDef> funcDef) { funcDefs.push_back(std::move(funcDef)); }
+    // 构造函数
+    CompUnit() : ASTNode(NodeKind::COMP_UNIT) {}
+    // 设置全局声明列表
+    void setDecls(NodeList<Decl> value) { decls = value; }
+    // 设置函数定义列表
+    void setFuncDefs(NodeList<FuncDef> value) { funcDefs = value; }
     
     // 获取全局声明列表
-    const std::vector<std::unique_ptr<Decl>>& getDecls() const { return decls; }
+    const NodeList<Decl>& getDecls() const { return decls; }
     // 获取函数定义列表
-    const std::vector<std::unique_ptr<FuncDef>>& getFuncDefs() const { return funcDefs; }
+    const NodeList<FuncDef>& getFuncDefs() const { return funcDefs; }
     // 获取节点所在行号（编译单元总是行号1）
     int getLine() const override { return 1; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::COMP_UNIT; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -145,39 +221,40 @@ public:
 class FuncDef : public ASTNode {
 private:
     Type returnType;                // 函数返回类型
-    std::string name;               // 函数名
-    std::vector<std::unique_ptr<FuncFParam>> params; // 函数形参列表
-    std::unique_ptr<Block> body;   // 函数体
+    Symbol name;                    // 函数名
+    NodeList<FuncFParam> params; // 函数形参列表
+    Block* body;   // 函数体
     int line;                       // 节点所在行号
 
 public:
-    FuncDef() = default; // 默认构造函数
+    FuncDef() : ASTNode(NodeKind::FUNC_DEF), returnType(Type::INT), name(0), body(nullptr), line(1) {} // 默认构造函数
     // 带参构造函数
-    FuncDef(Type returnType, const std::string& name, std::unique_ptr<Block> body, int line = 1)
-        : returnType(returnType), name(name), body(std::move(body)), line(line) {}
+    FuncDef(Type returnType, Symbol name, Block* body, int line = 1)
+        : ASTNode(NodeKind::FUNC_DEF), returnType(returnType), name(name), body(body), line(line) {}
         
     // 获取函数返回类型
     Type getReturnType() const { return returnType; }
     // 获取函数名
-    const std::string& getName() const { return name; }
+    Symbol getName() const { return name; }
     // 获取函数形参列表
-    const std::vector<std::unique_ptr<FuncFParam>>& getParams() const { return params; }
+    const NodeList<FuncFParam>& getParams() const { return params; }
     // 获取函数体
-    Block* getBody() const { return body.get(); }
+    Block* getBody() const { return body; }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
     // 设置函数返回类型
     void setReturnType(Type value) { returnType = value; }
     // 设置函数名
-    void setName(const std::string& value) { name = value; }
+    void setName(Symbol value) { name = value; }
     // 设置函数体
-    void setBody(std::unique_ptr<Block> newBody) { body = std::move(newBody); }
-    // 添加函数形参
-    void addParam(std::unique_ptr<FuncFParam> param) { params.push_back(std::move(param)); }
-    // 获取函数形参列表的引用
-    std::vector<std::unique_ptr<FuncFParam>>& getParamsRef() { return params; }
+    void setBody(Block* newBody) { body = newBody; }
+    // 设置函数形参列表
+    void setParams(NodeList<FuncFParam> value) { params = value; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::FUNC_DEF; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -187,25 +264,28 @@ class VarDecl : public Decl {
 private:
     Type type;                       // 变量类型
     bool isConst;                    // 是否为常量
-    std::vector<std::unique_ptr<VarDef>> varDefs; // 变量定义列表
+    NodeList<VarDef> varDefs; // 变量定义列表
     int line;                        // 节点所在行号
 
 public:
     // 构造函数
-    VarDecl(Type type, bool isConst, int line = 1) : type(type), isConst(isConst), line(line) {}
+    VarDecl(Type type, bool isConst, int line = 1) : Decl(NodeKind::VAR_DECL), type(type), isConst(isConst), line(line) {}
     
     // 获取变量类型
     Type getType() const { return type; }
     // 判断是否为常量
     bool getIsConst() const { return isConst; }
     // 获取变量定义列表
-    const std::vector<std::unique_ptr<VarDef>>& getVarDefs() const { return varDefs; }
+    const NodeList<VarDef>& getVarDefs() const { return varDefs; }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
-    // 添加变量定义
-    void addVarDef(std::unique_ptr<VarDef> varDef) { varDefs.push_back(std::move(varDef)); }
+    // 设置变量定义列表
+    void setVarDefs(NodeList<VarDef> value) { varDefs = value; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::VAR_DECL; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -213,31 +293,36 @@ public:
 // if语句节点类
 class IfStmt : public Stmt {
 private:
-    std::unique_ptr<Expr> condition; // if条件表达式
-    std::unique_ptr<Stmt> thenStmt;  // if语句块
-    std::unique_ptr<Stmt> elseStmt;  // else语句块（可选）
+    Expr* condition; // if条件表达式
+    Stmt* thenStmt;  // if语句块
+    Stmt* elseStmt;  // else语句块（可选）
     int line;                        // 节点所在行号
 
 public:
     // 构造函数
-    IfStmt(std::unique_ptr<Expr> condition, 
-           std::unique_ptr<Stmt> thenStmt, 
-           std::unique_ptr<Stmt> elseStmt = nullptr, 
+    IfStmt(Expr* condition, 
+           Stmt* thenStmt, 
+           Stmt* elseStmt = nullptr, 
            int line = 1)
-        : condition(std::move(condition)), 
-          thenStmt(std::move(thenStmt)), 
-          elseStmt(std::move(elseStmt)), 
+        : Stmt(NodeKind::IF_STMT), condition(condition), 
+          thenStmt(thenStmt), 
+          elseStmt(elseStmt), 
           line(line) {}
           
     // 获取条件表达式
-    Expr* getCondition() const { return condition.get(); }
+    Expr* getCondition() const { return condition; }
+    // 设置条件表达式（常量折叠）
+    void setCondition(Expr* value) { condition = value; }
     // 获取if语句块
-    Stmt* getThenStmt() const { return thenStmt.get(); }
+    Stmt* getThenStmt() const { return thenStmt; }
     // 获取else语句块
-    Stmt* getElseStmt() const { return elseStmt.get(); }
+    Stmt* getElseStmt() const { return elseStmt; }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::IF_STMT; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -245,22 +330,63 @@ public:
 // while语句节点类
 class WhileStmt : public Stmt {
 private:
-    std::unique_ptr<Expr> condition; // while条件表达式
-    std::unique_ptr<Stmt> body;      // while语句块
+    Expr* condition; // while条件表达式
+    Stmt* body;      // while语句块
     int line;                        // 节点所在行号
 
 public:
     // 构造函数
-    WhileStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> body, int line = 1)
-        : condition(std::move(condition)), body(std::move(body)), line(line) {}
+    WhileStmt(Expr* condition, Stmt* body, int line = 1)
+        : Stmt(NodeKind::WHILE_STMT), condition(condition), body(body), line(line) {}
     
     // 获取条件表达式
-    Expr* getCondition() const { return condition.get(); }
+    Expr* getCondition() const { return condition; }
+    // 设置条件表达式（常量折叠）
+    void setCondition(Expr* value) { condition = value; }
     // 获取while语句块
-    Stmt* getBody() const { return body.get(); }
+    Stmt* getBody() const { return body; }
+    // 获取节点所在行号
+    int getLine() const override { return line; }
+    
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::WHILE_STMT; }
+
+    // 接受访问者
+    void accept(ASTVisitor& visitor) override;
+};
+
+// break语句节点类
+class BreakStmt : public Stmt {
+private:
+    int line; // 节点所在行号
+
+public:
+    // 构造函数
+    BreakStmt(int line = 1) : Stmt(NodeKind::BREAK_STMT), line(line) {}
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::BREAK_STMT; }
+
+    // 接受访问者
+    void accept(ASTVisitor& visitor) override;
+};
+
+// continue语句节点类
+class ContinueStmt : public Stmt {
+private:
+    int line; // 节点所在行号
+
+public:
+    // 构造函数
+    ContinueStmt(int line = 1) : Stmt(NodeKind::CONTINUE_STMT), line(line) {}
+    // 获取节点所在行号
+    int getLine() const override { return line; }
+    
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::CONTINUE_STMT; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -268,18 +394,23 @@ public:
 // return语句节点类
 class ReturnStmt : public Stmt {
 private:
-    std::unique_ptr<Expr> expr; // 返回表达式
+    Expr* expr; // 返回表达式
     int line;                   // 节点所在行号
 
 public:
     // 构造函数
-    ReturnStmt(std::unique_ptr<Expr> expr, int line = 1) : expr(std::move(expr)), line(line) {}
+    ReturnStmt(Expr* expr, int line = 1) : Stmt(NodeKind::RETURN_STMT), expr(expr), line(line) {}
     
     // 获取返回表达式
-    Expr* getExpr() const { return expr.get(); }
+    Expr* getExpr() const { return expr; }
+    // 设置返回表达式（常量折叠）
+    void setExpr(Expr* value) { expr = value; }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::RETURN_STMT; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -287,20 +418,24 @@ public:
 // 二元表达式节点类
 class BinaryExpr : public Expr {
 private:
-    std::unique_ptr<Expr> left;  // 左操作数
-    std::unique_ptr<Expr> right; // 右操作数
+    Expr* left;  // 左操作数
+    Expr* right; // 右操作数
     TokenType op;                  // 操作符类型
     Type exprType;                 // 表达式类型
+    int line;                      // 节点所在行号（操作符所在的行）
 
 public:
     // 构造函数
-    BinaryExpr(std::unique_ptr<Expr> left, TokenType op, std::unique_ptr<Expr> right)
-        : left(std::move(left)), op(op), right(std::move(right)), exprType(Type::INT) {}
+    BinaryExpr(Expr* left, TokenType op, Expr* right, int line = 1)
+        : Expr(NodeKind::BINARY_EXPR), left(left), op(op), right(right), exprType(Type::INT), line(line) {}
     
     // 获取左操作数
-    Expr* getLeft() const { return left.get(); }
+    Expr* getLeft() const { return left; }
     // 获取右操作数
-    Expr* getRight() const { return right.get(); }
+    Expr* getRight() const { return right; }
+    // 设置左、右操作数（常量折叠）
+    void setLeft(Expr* value) { left = value; }
+    void setRight(Expr* value) { right = value; }
     // 获取操作符类型
     TokenType getOp() const { return op; }
     // 获取表达式类型
@@ -308,8 +443,11 @@ public:
     // 设置表达式类型
     void setType(Type type) { exprType = type; }
     // 获取节点所在行号
-    int getLine() const override { return left ? left->getLine() : 1; }
+    int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::BINARY_EXPR; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -318,25 +456,31 @@ public:
 class UnaryExpr : public Expr {
 private:
     TokenType op;                  // 操作符类型
-    std::unique_ptr<Expr> operand; // 操作数
+    Expr* operand; // 操作数
     Type exprType;                 // 表达式类型
+    int line;                      // 节点所在行号（操作符所在的行）
 
 public:
     // 构造函数
-    UnaryExpr(TokenType op, std::unique_ptr<Expr> operand)
-        : op(op), operand(std::move(operand)), exprType(Type::INT) {}
+    UnaryExpr(TokenType op, Expr* operand, int line = 1)
+        : Expr(NodeKind::UNARY_EXPR), op(op), operand(operand), exprType(Type::INT), line(line) {}
     
     // 获取操作符类型
     TokenType getOp() const { return op; }
     // 获取操作数
-    Expr* getOperand() const { return operand.get(); }
+    Expr* getOperand() const { return operand; }
+    // 设置操作数（常量折叠）
+    void setOperand(Expr* value) { operand = value; }
     // 获取表达式类型
     Type getType() const override { return exprType; }
     // 设置表达式类型
     void setType(Type type) { exprType = type; }
     // 获取节点所在行号
-    int getLine() const override { return operand ? operand->getLine() : 1; }
+    int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::UNARY_EXPR; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -344,20 +488,27 @@ public:
 // 函数调用表达式节点类
 class CallExpr : public Expr {
 private:
-    std::string callee;            // 被调用的函数名
-    std::vector<std::unique_ptr<Expr>> args; // 函数调用参数列表
+    Symbol callee;                 // 被调用的函数名
+    NodeList<Expr> args; // 函数调用参数列表
     Type exprType;                 // 表达式类型
+    FuncDef* decl;                 // 名字解析得到的函数定义，未解析或未定义时为nullptr
     int line;                      // 节点所在行号
 
 public:
     // 构造函数
-    CallExpr(const std::string& callee, std::vector<std::unique_ptr<Expr>> args, int line = 1)
-        : callee(callee), args(std::move(args)), exprType(Type::INT), line(line) {}
+    CallExpr(Symbol callee, NodeList<Expr> args, int line = 1)
+        : Expr(NodeKind::CALL_EXPR), callee(callee), args(args), exprType(Type::INT), decl(nullptr), line(line) {}
     
     // 获取被调用的函数名
-    const std::string& getCallee() const { return callee; }
+    Symbol getCallee() const { return callee; }
+    // 获取被调用的函数定义
+    FuncDef* getDecl() const { return decl; }
+    // 设置被调用的函数定义（名字解析）
+    void setDecl(FuncDef* value) { decl = value; }
     // 获取函数调用参数列表
-    const std::vector<std::unique_ptr<Expr>>& getArgs() const { return args; }
+    const NodeList<Expr>& getArgs() const { return args; }
+    // 设置函数调用参数列表（常量折叠）
+    void setArgs(NodeList<Expr> value) { args = value; }
     // 获取表达式类型
     Type getType() const override { return exprType; }
     // 设置表达式类型
@@ -365,6 +516,9 @@ public:
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::CALL_EXPR; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -372,26 +526,32 @@ public:
 // 数组索引表达式节点类
 class IndexExpr : public Expr {
 private:
-    std::unique_ptr<Expr> base;   // 数组基地址表达式
-    std::unique_ptr<Expr> index;  // 索引表达式
+    Expr* base;   // 数组基地址表达式
+    Expr* index;  // 索引表达式
     Type exprType;                 // 表达式类型
+    int line;                      // 节点所在行号（左方括号所在的行）
 
 public:
     // 构造函数
-    IndexExpr(std::unique_ptr<Expr> base, std::unique_ptr<Expr> index)
-        : base(std::move(base)), index(std::move(index)), exprType(Type::INT) {}
+    IndexExpr(Expr* base, Expr* index, int line = 1)
+        : Expr(NodeKind::INDEX_EXPR), base(base), index(index), exprType(Type::INT), line(line) {}
     
     // 获取数组基地址表达式
-    Expr* getBase() const { return base.get(); }
+    Expr* getBase() const { return base; }
     // 获取索引表达式
-    Expr* getIndex() const { return index.get(); }
+    Expr* getIndex() const { return index; }
+    // 设置索引表达式（常量折叠）
+    void setIndex(Expr* value) { index = value; }
     // 获取表达式类型
     Type getType() const override { return exprType; }
     // 设置表达式类型
     void setType(Type type) { exprType = type; }
     // 获取节点所在行号
-    int getLine() const override { return base ? base->getLine() : 1; }
+    int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::INDEX_EXPR; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -406,9 +566,9 @@ private:
 
 public:
     // 整数构造函数
-    NumberExpr(int value, int line = 1) : intValue(value), floatValue(0.0f), exprType(Type::INT), line(line) {}
+    NumberExpr(int value, int line = 1) : Expr(NodeKind::INT_LITERAL), intValue(value), floatValue(0.0f), exprType(Type::INT), line(line) {}
     // 浮点数构造函数
-    NumberExpr(float value, int line = 1) : intValue(0), floatValue(value), exprType(Type::FLOAT), line(line) {}
+    NumberExpr(float value, int line = 1) : Expr(NodeKind::FLOAT_LITERAL), intValue(0), floatValue(value), exprType(Type::FLOAT), line(line) {}
     // 获取整数值
     int getIntValue() const { return intValue; }
     // 获取浮点数值
@@ -420,6 +580,11 @@ public:
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用（整数和浮点数常量是两种节点种类）
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::INT_LITERAL || node->getKind() == NodeKind::FLOAT_LITERAL;
+    }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -427,15 +592,21 @@ public:
 // 变量表达式节点类
 class VariableExpr : public Expr {
 private:
-    std::string name; // 变量名
+    Symbol name;   // 变量名
     Type exprType; // 表达式类型
+    ASTNode* decl; // 名字解析得到的声明：VarDef、FuncFParam或FuncDef，未解析或未声明时为nullptr
     int line;      // 节点所在行号
 
 public:
     // 构造函数
-    VariableExpr(const std::string& name, int line = 1) : name(name), exprType(Type::INT), line(line) {}
+    VariableExpr(Symbol name, int line = 1)
+        : Expr(NodeKind::VARIABLE_EXPR), name(name), exprType(Type::INT), decl(nullptr), line(line) {}
     // 获取变量名
-    const std::string& getName() const { return name; }
+    Symbol getName() const { return name; }
+    // 获取变量的声明，用isa/dyn_cast区分种类
+    ASTNode* getDecl() const { return decl; }
+    // 设置变量的声明（名字解析）
+    void setDecl(ASTNode* value) { decl = value; }
     // 获取表达式类型
     Type getType() const override { return exprType; }
     // 设置表达式类型
@@ -443,6 +614,9 @@ public:
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::VARIABLE_EXPR; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -450,25 +624,26 @@ public:
 // 代码块节点类
 class Block : public Stmt {
 private:
-    std::vector<std::unique_ptr<Stmt>> statements; // 代码块中的语句列表
-    int line;                                      // 节点所在行号
+    NodeList<Stmt> statements; // 代码块中的语句列表
+    int line;                  // 节点所在行号
 
 public:
     // 构造函数
-    Block(int line = 1) : line(line) {}
+    Block(int line = 1) : Stmt(NodeKind::BLOCK), line(line) {}
     
-    // 添加语句到代码块
-    void addStatement(std::unique_ptr<Stmt> stmt) {
-        statements.push_back(std::move(stmt));
-    }
+    // 设置代码块中的语句列表
+    void setStatements(NodeList<Stmt> value) { statements = value; }
     
     // 获取代码块中的语句列表
-    const std::vector<std::unique_ptr<Stmt>>& getStatements() const {
+    const NodeList<Stmt>& getStatements() const {
         return statements;
     }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::BLOCK; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -476,17 +651,22 @@ public:
 // 表达式语句节点类
 class ExprStmt : public Stmt {
 private:
-    std::unique_ptr<Expr> expr; // 语句中的表达式
+    Expr* expr; // 语句中的表达式
     int line;                   // 节点所在行号
 
 public:
     // 构造函数
-    ExprStmt(std::unique_ptr<Expr> expr, int line = 1) : expr(std::move(expr)), line(line) {}
+    ExprStmt(Expr* expr, int line = 1) : Stmt(NodeKind::EXPR_STMT), expr(expr), line(line) {}
     // 获取语句中的表达式
-    Expr* getExpr() const { return expr.get(); }
+    Expr* getExpr() const { return expr; }
+    // 设置语句中的表达式（常量折叠）
+    void setExpr(Expr* value) { expr = value; }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::EXPR_STMT; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -494,17 +674,20 @@ public:
 // 声明语句节点类，用于在语句块中包含变量声明
 class DeclStmt : public Stmt {
 private:
-    std::unique_ptr<Decl> decl; // 包装的声明
+    Decl* decl; // 包装的声明
     int line;                   // 节点所在行号
 
 public:
     // 构造函数
-    DeclStmt(std::unique_ptr<Decl> decl, int line = 1) : decl(std::move(decl)), line(line) {}
+    DeclStmt(Decl* decl, int line = 1) : Stmt(NodeKind::DECL_STMT), decl(decl), line(line) {}
     // 获取声明
-    Decl* getDecl() const { return decl.get(); }
+    Decl* getDecl() const { return decl; }
     // 获取节点所在行号
     int getLine() const override { return line; }
     
+    // 判断节点是否为本类型，供isa/cast/dyn_cast使用
+    static bool classof(const ASTNode* node) { return node->getKind() == NodeKind::DECL_STMT; }
+
     // 接受访问者
     void accept(ASTVisitor& visitor) override;
 };
@@ -524,6 +707,10 @@ public:
     virtual void visit(IfStmt& node) = 0;
     // 访问while语句节点
     virtual void visit(WhileStmt& node) = 0;
+    // 访问break语句节点
+    virtual void visit(BreakStmt& node) = 0;
+    // 访问continue语句节点
+    virtual void visit(ContinueStmt& node) = 0;
     // 访问return语句节点
     virtual void visit(ReturnStmt& node) = 0;
     // 访问二元表达式节点
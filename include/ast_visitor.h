@@ -0,0 +1,112 @@
+#pragma once
+#include "ast.h"
+
+// 强制内联：让每个调用点都有自己的分派跳转表，间接跳转的预测按调用点区分
+#if defined(__GNUC__) || defined(__clang__)
+#define SYSY_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define SYSY_ALWAYS_INLINE __forceinline
+#else
+#define SYSY_ALWAYS_INLINE inline
+#endif
+
+// RecursiveASTVisitor - 静态分派的语法树访问者（CRTP）
+// 派生类以自己为模板参数继承本类，按需定义visitXxx(Xxx&)方法；dispatch按节点的种类标签用switch
+// 直接调用派生类的方法，在编译期确定调用目标，可以内联，不经过accept/visit两次虚函数调用。
+// 派生类没有定义的visitXxx使用这里的默认实现：按源代码顺序分派全部子节点；
+// 派生类的方法中需要继续遍历子节点时，调用dispatch或者基类的同名方法。
+//
+// 用法：
+//   class Counter : public RecursiveASTVisitor<Counter> {
+//   public:
+//       int calls = 0;
+//       void visitCallExpr(CallExpr& node) { calls++; RecursiveASTVisitor::visitCallExpr(node); }
+//   };
+//   Counter counter;
+//   counter.dispatch(compUnit);
+template <typename Derived>
+class RecursiveASTVisitor {
+protected:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+
+    // 依次分派列表中的节点
+    template <typename T>
+    void dispatchList(const NodeList<T>& items) {
+        for (T* item : items) {
+            dispatch(item);
+        }
+    }
+
+public:
+    // 按节点种类调用派生类对应的visitXxx，空指针直接忽略
+    SYSY_ALWAYS_INLINE void dispatch(ASTNode* node) {
+        if (node == nullptr) {
+            return;
+        }
+        switch (node->getKind()) {
+            case NodeKind::COMP_UNIT: return derived().visitCompUnit(*cast<CompUnit>(node));
+            case NodeKind::FUNC_DEF: return derived().visitFuncDef(*cast<FuncDef>(node));
+            case NodeKind::FUNC_PARAM: return derived().visitFuncFParam(*cast<FuncFParam>(node));
+            case NodeKind::VAR_DECL: return derived().visitVarDecl(*cast<VarDecl>(node));
+            case NodeKind::VAR_DEF: return derived().visitVarDef(*cast<VarDef>(node));
+            case NodeKind::BLOCK: return derived().visitBlock(*cast<Block>(node));
+            case NodeKind::DECL_STMT: return derived().visitDeclStmt(*cast<DeclStmt>(node));
+            case NodeKind::EXPR_STMT: return derived().visitExprStmt(*cast<ExprStmt>(node));
+            case NodeKind::IF_STMT: return derived().visitIfStmt(*cast<IfStmt>(node));
+            case NodeKind::WHILE_STMT: return derived().visitWhileStmt(*cast<WhileStmt>(node));
+            case NodeKind::BREAK_STMT: return derived().visitBreakStmt(*cast<BreakStmt>(node));
+            case NodeKind::CONTINUE_STMT: return derived().visitContinueStmt(*cast<ContinueStmt>(node));
+            case NodeKind::RETURN_STMT: return derived().visitReturnStmt(*cast<ReturnStmt>(node));
+            case NodeKind::BINARY_EXPR: return derived().visitBinaryExpr(*cast<BinaryExpr>(node));
+            case NodeKind::UNARY_EXPR: return derived().visitUnaryExpr(*cast<UnaryExpr>(node));
+            case NodeKind::CALL_EXPR: return derived().visitCallExpr(*cast<CallExpr>(node));
+            case NodeKind::INDEX_EXPR: return derived().visitIndexExpr(*cast<IndexExpr>(node));
+            case NodeKind::INT_LITERAL:
+            case NodeKind::FLOAT_LITERAL: return derived().visitNumberExpr(*cast<NumberExpr>(node));
+            case NodeKind::VARIABLE_EXPR: return derived().visitVariableExpr(*cast<VariableExpr>(node));
+        }
+    }
+
+    // 默认实现：分派全部子节点
+    void visitCompUnit(CompUnit& node) {
+        dispatchList(node.getDecls());
+        dispatchList(node.getFuncDefs());
+    }
+    void visitFuncDef(FuncDef& node) {
+        dispatchList(node.getParams());
+        dispatch(node.getBody());
+    }
+    void visitFuncFParam(FuncFParam&) {}
+    void visitVarDecl(VarDecl& node) { dispatchList(node.getVarDefs()); }
+    void visitVarDef(VarDef& node) {
+        dispatchList(node.getDims());
+        dispatch(node.getInitExpr());
+    }
+    void visitBlock(Block& node) { dispatchList(node.getStatements()); }
+    void visitDeclStmt(DeclStmt& node) { dispatch(node.getDecl()); }
+    void visitExprStmt(ExprStmt& node) { dispatch(node.getExpr()); }
+    void visitIfStmt(IfStmt& node) {
+        dispatch(node.getCondition());
+        dispatch(node.getThenStmt());
+        dispatch(node.getElseStmt());
+    }
+    void visitWhileStmt(WhileStmt& node) {
+        dispatch(node.getCondition());
+        dispatch(node.getBody());
+    }
+    void visitBreakStmt(BreakStmt&) {}
+    void visitContinueStmt(ContinueStmt&) {}
+    void visitReturnStmt(ReturnStmt& node) { dispatch(node.getExpr()); }
+    void visitBinaryExpr(BinaryExpr& node) {
+        dispatch(node.getLeft());
+        dispatch(node.getRight());
+    }
+    void visitUnaryExpr(UnaryExpr& node) { dispatch(node.getOperand()); }
+    void visitCallExpr(CallExpr& node) { dispatchList(node.getArgs()); }
+    void visitIndexExpr(IndexExpr& node) {
+        dispatch(node.getBase());
+        dispatch(node.getIndex());
+    }
+    void visitNumberExpr(NumberExpr&) {}
+    void visitVariableExpr(VariableExpr&) {}
+};
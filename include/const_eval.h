@@ -0,0 +1,105 @@
+#pragma once
+#include "arena.h"
+#include "ast.h"
+#include "ast_visitor.h"
+#include <unordered_map>
+#include <vector>
+
+// 编译期常量的值，类型为INT或FLOAT
+struct ConstValue {
+    Type type;
+    union {
+        int intValue;
+        float floatValue;
+    };
+
+    ConstValue() : type(Type::INT), intValue(0) {}
+    static ConstValue ofInt(int value) {
+        ConstValue result;
+        result.intValue = value;
+        return result;
+    }
+    static ConstValue ofFloat(float value) {
+        ConstValue result;
+        result.type = Type::FLOAT;
+        result.floatValue = value;
+        return result;
+    }
+
+    // 按浮点数取值（整数隐式转换为浮点数）
+    float asFloat() const { return type == Type::FLOAT ? floatValue : static_cast<float>(intValue); }
+    // 作为条件时是否为真
+    bool isTrue() const { return type == Type::FLOAT ? floatValue != 0.0f : intValue != 0; }
+};
+
+// ConstEvaluator类 - 按SysY的int/float语义在编译期对表达式求值
+// 整数运算按32位补码回绕，int与float混合运算时整数先转换为float，比较和逻辑运算的结果为int，
+// &&和||短路：左操作数已经决定结果时，右操作数不必是常量表达式。
+// 除数为0、INT_MIN / -1、float取模、赋值、函数调用和数组元素都不是常量表达式，留到运行时处理。
+// 变量只有在名字解析绑定到标量const变量时才是常量，其值为初始化表达式的值（转换为声明的类型），
+// 每个const变量只求值一次，结果缓存起来；因此常量之间层层引用时总的求值代价仍是线性的。
+// 求值用显式栈做后序遍历，表达式的长度和嵌套深度都不消耗调用栈
+class ConstEvaluator {
+private:
+    // 一个子表达式的求值结果
+    struct Result {
+        bool constant;    // 是否为常量表达式
+        ConstValue value; // 常量的值
+    };
+
+    // 工作栈中的一项
+    struct WorkItem {
+        Expr* expr;    // 待求值的表达式
+        bool expanded; // 子表达式是否已压栈
+    };
+
+    std::vector<WorkItem> work;                         // 工作栈
+    std::vector<Result> results;                        // 已求值但尚未被父表达式取走的结果
+    std::vector<Expr*> args;                            // 折叠实参时新列表的暂存区
+    std::unordered_map<const VarDef*, Result> constants; // 已求值的const变量（求值中的变量记为非常量）
+    size_t foldCount;                                   // 累计替换为常量的子表达式个数
+
+    // 对expr求值；arena不为nullptr时，把非常量表达式中的常量子表达式替换为数字常量
+    Result run(Expr* expr, Arena* arena);
+    // 生成表达式的结果，子表达式的结果在results末尾
+    Result combine(Expr* expr, Arena* arena);
+    // 求出结果后不是数字常量时，生成值相同的数字常量
+    Expr* replacement(Expr* expr, const Result& result, Arena& arena);
+
+public:
+    ConstEvaluator() : foldCount(0) {}
+
+    // 对表达式求值，是常量表达式时把值写入value并返回true，不修改语法树
+    // 表达式中的名字必须已经完成名字解析
+    bool evaluate(Expr* expr, ConstValue& value);
+    // 常量折叠：把表达式中最大的常量子表达式替换为分配在arena中的数字常量，返回替换后的表达式
+    // 赋值的左侧不会被替换
+    Expr* fold(Expr* expr, Arena& arena);
+    // 把value转换为type类型（float转int向零取整，超出int范围时不是常量），失败时返回false
+    static bool convert(ConstValue& value, Type type);
+
+    // 累计替换为常量的子表达式个数
+    size_t foldedCount() const { return foldCount; }
+};
+
+// ConstantFolder类 - 对整个编译单元做常量折叠
+// 依次折叠变量定义的各维长度和初始化表达式、if和while的条件、return和表达式语句中的表达式；
+// 在语义分析没有错误之后运行，名字解析的结果和表达式类型都已确定
+class ConstantFolder : public RecursiveASTVisitor<ConstantFolder> {
+private:
+    Arena& arena;             // 新的数字常量所在的Arena
+    ConstEvaluator evaluator; // 常量求值器
+    std::vector<Expr*> dims;  // 折叠各维长度时新列表的暂存区
+
+public:
+    explicit ConstantFolder(Arena& arena) : arena(arena) {}
+
+    // 累计替换为常量的子表达式个数
+    size_t foldedCount() const { return evaluator.foldedCount(); }
+
+    void visitVarDef(VarDef& node);
+    void visitIfStmt(IfStmt& node);
+    void visitWhileStmt(WhileStmt& node);
+    void visitReturnStmt(ReturnStmt& node);
+    void visitExprStmt(ExprStmt& node);
+};
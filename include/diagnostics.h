@@ -0,0 +1,117 @@
+#pragma once
+#include "interner.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 诊断信息的种类
+enum class DiagKind : uint8_t {
+    LEXICAL,  // 词法错误（Error type A）
+    SYNTAX,   // 语法错误（Error type B）
+    SEMANTIC, // 语义错误（Error type 1~11）
+    WARNING   // 警告
+};
+
+// 诊断信息的输出格式
+enum class DiagFormat : uint8_t {
+    TEXT, // 实验要求的格式：Error type N at line L : 说明
+    JSON  // JSON数组，每条诊断信息一个对象
+};
+
+// 一条诊断信息，说明文字保存在DiagnosticEngine的文字池中
+struct Diagnostic {
+    DiagKind kind;          // 种类
+    uint8_t errorType;      // 语义错误的类型编号，其他种类为0
+    int line;               // 所在行号
+    int column;             // 所在列号（从1开始），0表示未知
+    uint32_t messageOffset; // 说明文字在文字池中的偏移
+    uint32_t messageLength; // 说明文字的长度
+};
+
+// DiagnosticEngine类 - 收集诊断信息，最后统一排序输出
+// 报告时只在文字池末尾拼接说明文字并记录一条定长的Diagnostic，不进行任何I/O；
+// 完全相同的诊断信息（种类、类型、位置、说明都相同）只记录一次。
+// render按位置（行号、列号）稳定排序，同一位置的诊断信息保持报告顺序，
+// 然后在一个缓冲区中生成全部输出，只写一次输出流
+class DiagnosticEngine {
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;       // 去重表中的空位
+    static constexpr uint32_t REMOVED = UINT32_MAX - 1; // 去重表中被撤销的诊断信息留下的位置
+
+    std::vector<Diagnostic> entries;  // 按报告顺序排列的诊断信息
+    std::string text;                 // 文字池
+    std::vector<uint32_t> seen;       // 去重表：开放寻址的哈希表，保存诊断信息的下标，大小为2的幂
+    size_t usedSlots;                 // 去重表中非空的位置个数（含REMOVED）
+    size_t errors;                    // 错误（不含警告）的条数
+    uint32_t messageStart;            // 正在拼接的说明文字在文字池中的起始位置
+
+    // 诊断信息的哈希值，由种类、类型、位置和说明文字组合而成
+    size_t hashOf(const Diagnostic& entry) const;
+    // 两条诊断信息是否完全相同
+    bool sameAs(const Diagnostic& left, const Diagnostic& right) const;
+    // 去重表占用超过一半时扩容，同时清除REMOVED
+    void growSeen();
+
+    // 拼接说明文字的各个部分
+    void append(std::string_view value) { text.append(value); }
+    void append(const char* value) { text.append(value); }
+    void append(const std::string& value) { text.append(value); }
+    void append(char value) { text.push_back(value); }
+    void append(Symbol value) { text.append(value.str()); }
+    void append(long long value);
+    void append(int value) { append(static_cast<long long>(value)); }
+    void append(size_t value) { append(static_cast<long long>(value)); }
+
+    // 记录文字池末尾从messageStart开始的说明文字，重复的诊断信息丢弃
+    void commit(DiagKind kind, uint8_t errorType, int line, int column);
+
+public:
+    DiagnosticEngine();
+
+    // 报告一条诊断信息，说明文字由各个参数（字符串、Symbol、整数）依次拼接而成
+    // 参数：kind - 种类
+    //       errorType - 语义错误的类型编号，其他种类为0
+    //       line、column - 所在位置，column为0表示未知
+    template <typename... Args>
+    void report(DiagKind kind, uint8_t errorType, int line, int column, const Args&... args) {
+        messageStart = static_cast<uint32_t>(text.size());
+        (append(args), ...);
+        commit(kind, errorType, line, column);
+    }
+
+    // 报告语义错误
+    template <typename... Args>
+    void error(uint8_t errorType, int line, const Args&... args) {
+        report(DiagKind::SEMANTIC, errorType, line, 0, args...);
+    }
+
+    // 报告警告
+    template <typename... Args>
+    void warning(int line, const Args&... args) {
+        report(DiagKind::WARNING, 0, line, 0, args...);
+    }
+
+    // 把other中[begin, end)的诊断信息按顺序追加到本引擎（用于合并多个线程的结果）
+    void merge(const DiagnosticEngine& other, size_t begin, size_t end);
+
+    // 诊断信息的条数
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    // 是否有错误（不含警告）
+    bool hasErrors() const { return errors != 0; }
+    size_t errorCount() const { return errors; }
+    const Diagnostic& operator[](size_t index) const { return entries[index]; }
+    // 诊断信息的说明文字
+    std::string_view message(const Diagnostic& entry) const {
+        return std::string_view(text).substr(entry.messageOffset, entry.messageLength);
+    }
+
+    // 撤销count之后报告的诊断信息（用于回溯）
+    void truncate(size_t count);
+    // 按位置排序后以指定格式输出全部诊断信息
+    void render(std::ostream& out, DiagFormat format) const;
+    // 清空全部诊断信息
+    void clear();
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include "ir.h"
+#include <cstdint>
+#include <vector>
+
+// 支配关系分析
+// 支配树用SEMI-NCA算法计算：在深度优先树上先用带路径压缩的森林求每个结点的半支配者，
+// 再从父结点沿支配者链向上找到半支配者所在的位置，得到直接支配者。
+// 与逐个前驱求支配者链交点的迭代算法不同，有大量前驱的汇合点（如一长串&&、||的假出口）不会使代价变为平方；
+// 可达的基本块按逆后序编号，对外的结果和各个数组都以逆后序编号为下标。
+// 支配树建好后做一次深度优先遍历，记录每个结点进入和离开时的序号，
+// "a支配b"等价于b的区间嵌套在a的区间内，查询为常数时间，不必沿支配者链向上查找。
+//
+// 基本块以BasicBlock::getIndex()为编号，构造时会调用Function::renumberBlocks；
+// 之后增删基本块或改变跳转目标都会使分析结果失效，需要重新计算
+
+class DominanceFrontier;
+
+// DominatorTreeBase类 - 支配树和后支配树的共同部分：在一个以编号表示结点的有向图上计算支配树
+class DominatorTreeBase {
+protected:
+    static constexpr uint32_t UNDEFINED = UINT32_MAX;
+
+    std::vector<uint32_t> rpoIndex;     // 结点编号到逆后序编号，不可达的结点为UNDEFINED
+    std::vector<BasicBlock*> rpoBlocks; // 逆后序编号到基本块（后支配树的虚拟出口为nullptr）
+    std::vector<uint32_t> idoms;        // 直接支配者的逆后序编号，根为它自己
+    std::vector<uint32_t> predOffsets;  // 前驱（只含可达结点）：preds[predOffsets[i]..predOffsets[i+1])
+    std::vector<uint32_t> preds;
+    std::vector<uint32_t> childOffsets; // 支配树中的子结点：children[childOffsets[i]..childOffsets[i+1])
+    std::vector<BasicBlock*> children;
+    std::vector<uint32_t> dfsIn;        // 支配树深度优先遍历中进入结点时的序号
+    std::vector<uint32_t> dfsOut;       // 离开结点时子树中最大的进入序号
+
+    DominatorTreeBase() = default;
+
+    // 计算支配树：图有nodeCount个结点，root为根，结点i的后继为targets[offsets[i]..offsets[i+1])，
+    // nodeBlocks为结点对应的基本块
+    void build(uint32_t nodeCount, uint32_t root, const std::vector<uint32_t>& offsets,
+               const std::vector<uint32_t>& targets, const std::vector<BasicBlock*>& nodeBlocks);
+    // 基本块的逆后序编号，不可达时为UNDEFINED；nullptr表示后支配树的虚拟出口
+    uint32_t indexOf(const BasicBlock* block) const {
+        if (block != nullptr) {
+            return rpoIndex[block->getIndex()];
+        }
+        return !rpoBlocks.empty() && rpoBlocks[0] == nullptr ? 0 : UNDEFINED;
+    }
+
+    friend class DominanceFrontier;
+
+public:
+    // 基本块是否从根可达
+    bool isReachable(const BasicBlock* block) const { return indexOf(block) != UNDEFINED; }
+
+    // 直接支配者；根、不可达的基本块以及直接后支配者为虚拟出口时返回nullptr
+    BasicBlock* getIdom(const BasicBlock* block) const {
+        uint32_t index = indexOf(block);
+        return index == UNDEFINED || index == 0 ? nullptr : rpoBlocks[idoms[index]];
+    }
+
+    // a是否支配b（a == b时也成立），常数时间
+    // 不可达的基本块被任何基本块支配，但不支配其他基本块
+    bool dominates(const BasicBlock* a, const BasicBlock* b) const {
+        uint32_t blockB = indexOf(b);
+        if (blockB == UNDEFINED) {
+            return true;
+        }
+        uint32_t blockA = indexOf(a);
+        if (blockA == UNDEFINED) {
+            return false;
+        }
+        return dfsIn[blockA] <= dfsIn[blockB] && dfsIn[blockB] <= dfsOut[blockA];
+    }
+
+    // a是否严格支配b
+    bool properlyDominates(const BasicBlock* a, const BasicBlock* b) const { return a != b && dominates(a, b); }
+
+    // 支配树中的子结点，按逆后序排列；后支配树中nullptr表示虚拟出口
+    NodeList<BasicBlock> getChildren(const BasicBlock* block) const {
+        uint32_t index = indexOf(block);
+        if (index == UNDEFINED) {
+            return NodeList<BasicBlock>();
+        }
+        return NodeList<BasicBlock>(children.data() + childOffsets[index], childOffsets[index + 1] - childOffsets[index]);
+    }
+
+    // 可达基本块的逆后序，第一个元素为根（后支配树中为代表虚拟出口的nullptr）
+    const std::vector<BasicBlock*>& getReversePostOrder() const { return rpoBlocks; }
+};
+
+// DominatorTree类 - 以入口块为根的支配树
+class DominatorTree : public DominatorTreeBase {
+public:
+    explicit DominatorTree(Function& function);
+};
+
+// PostDominatorTree类 - 后支配树：在反向的控制流图上计算，根是连接全部返回块的虚拟出口
+// 无法到达返回指令的基本块（如死循环）不在后支配树中
+class PostDominatorTree : public DominatorTreeBase {
+public:
+    explicit PostDominatorTree(Function& function);
+};
+
+// DominanceFrontier类 - 支配边界：b在a的支配边界中，当且仅当a支配b的某个前驱但不严格支配b
+// 对每个有多个前驱的汇合点，从每个前驱沿支配者链向上走到汇合点的直接支配者为止，途经的结点的边界都包含该汇合点，
+// 总代价与各边界的大小之和成正比。在后支配树上计算得到的是反向支配边界（控制依赖）
+class DominanceFrontier {
+private:
+    std::vector<uint32_t> offsets;   // 按逆后序编号：frontier[offsets[i]..offsets[i+1])
+    std::vector<BasicBlock*> frontier;
+    const DominatorTreeBase& tree;   // 所依据的支配树
+
+public:
+    explicit DominanceFrontier(const DominatorTreeBase& tree);
+
+    // 基本块的支配边界，不可达的基本块为空
+    NodeList<BasicBlock> get(const BasicBlock* block) const {
+        uint32_t index = tree.indexOf(block);
+        if (index == DominatorTreeBase::UNDEFINED) {
+            return NodeList<BasicBlock>();
+        }
+        return NodeList<BasicBlock>(frontier.data() + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include "ast.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 节点下标，NO_NODE表示不存在的子节点（如没有else分支）
+using NodeIndex = uint32_t;
+constexpr NodeIndex NO_NODE = UINT32_MAX;
+
+// 子节点列表：extra池中的一段连续下标
+struct NodeRange {
+    const NodeIndex* first; // 第一个子节点下标
+    const NodeIndex* last;  // 最后一个子节点之后
+
+    const NodeIndex* begin() const { return first; }
+    const NodeIndex* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    NodeIndex operator[](size_t index) const { return first[index]; }
+};
+
+// FlatAst类 - 语法树的扁平编码（结构数组）
+// 每个节点只占kind、tag、line、lhs、rhs五列中的一行，共14字节，子节点用32位下标引用；
+// 子节点列表和放不下的第三个操作数保存在共享的extra池中（列表编码为[个数, 下标...]）。
+// 节点按后序排列：子节点总在父节点之前，根节点（编译单元）在最后，
+// 因此自底向上的分析（类型推导、常量折叠等）只需从前往后线性扫描一遍。
+//
+// 各种节点的编码：
+//   种类            tag                   lhs               rhs
+//   COMP_UNIT       -                     声明列表          函数定义列表
+//   FUNC_DEF        返回类型              函数名            extra：[形参列表, 函数体]
+//   FUNC_PARAM      类型|数组标志         形参名            数组大小（数值）
+//   VAR_DECL        类型|常量标志         变量定义列表      -
+//   VAR_DEF         数组标志              变量名            extra：[各维长度列表, 初始化表达式]
+//   BLOCK           -                     语句列表          -
+//   DECL_STMT       -                     声明              -
+//   EXPR_STMT       -                     表达式            -
+//   IF_STMT         -                     条件              extra：[then分支, else分支]
+//   WHILE_STMT      -                     条件              循环体
+//   BREAK_STMT      -                     -                 -
+//   CONTINUE_STMT   -                     -                 -
+//   RETURN_STMT     -                     返回值            -
+//   BINARY_EXPR     运算符                左操作数          右操作数
+//   UNARY_EXPR      运算符                操作数            -
+//   CALL_EXPR       -                     函数名            实参列表
+//   INDEX_EXPR      -                     数组表达式        下标表达式
+//   INT_LITERAL     -                     整数值            -
+//   FLOAT_LITERAL   -                     浮点数值的位模式  -
+//   VARIABLE_EXPR   -                     变量名            -
+// 其中"列表"和"extra"都是extra池中的偏移，名字是Symbol编号，类型是Type的取值
+class FlatAst {
+private:
+    std::vector<NodeKind> kinds;   // 节点种类
+    std::vector<uint8_t> tags;     // 运算符、类型或标志
+    std::vector<int> lines;        // 节点所在行号
+    std::vector<uint32_t> lhs;     // 第一个操作数
+    std::vector<uint32_t> rhs;     // 第二个操作数
+    std::vector<uint32_t> extra;   // 子节点列表和额外操作数
+
+    friend class FlatAstBuilder;
+
+public:
+    static constexpr uint8_t ARRAY_FLAG = 0x10; // FUNC_PARAM、VAR_DEF：是否为数组
+    static constexpr uint8_t CONST_FLAG = 0x20; // VAR_DECL：是否为常量
+    static constexpr uint8_t TYPE_MASK = 0x0F;  // tag中保存Type的位
+
+    // 由指针形式的语法树生成扁平编码（不使用递归，树的深度不受调用栈限制）
+    // 参数：root - 编译单元
+    //       nodeHint - 预计的节点个数，用于预先分配各列的空间，可以取Arena的分配次数
+    static FlatAst build(CompUnit& root, size_t nodeHint = 0);
+
+    // 与指针形式的语法树逐个节点比较种类、tag、行号、操作数和子节点列表（用于测试）
+    // 返回第一处不一致的描述，完全一致时返回空串
+    std::string verify(CompUnit& root) const;
+
+    // 节点个数
+    size_t size() const { return kinds.size(); }
+    // 根节点（编译单元）的下标
+    NodeIndex root() const { return static_cast<NodeIndex>(kinds.size() - 1); }
+
+    // 按列访问节点
+    NodeKind kind(NodeIndex node) const { return kinds[node]; }
+    uint8_t tag(NodeIndex node) const { return tags[node]; }
+    int line(NodeIndex node) const { return lines[node]; }
+    uint32_t left(NodeIndex node) const { return lhs[node]; }
+    uint32_t right(NodeIndex node) const { return rhs[node]; }
+    // 读取extra池中offset处的值
+    uint32_t extraAt(uint32_t offset) const { return extra[offset]; }
+    // 读取extra池中offset处的子节点列表
+    NodeRange list(uint32_t offset) const {
+        const NodeIndex* first = extra.data() + offset + 1;
+        return NodeRange{first, first + extra[offset]};
+    }
+
+    // 按节点种类解释各列
+    TokenType op(NodeIndex node) const { return static_cast<TokenType>(tags[node]); }
+    Type type(NodeIndex node) const { return static_cast<Type>(tags[node] & TYPE_MASK); }
+    bool isArray(NodeIndex node) const { return (tags[node] & ARRAY_FLAG) != 0; }
+    bool isConst(NodeIndex node) const { return (tags[node] & CONST_FLAG) != 0; }
+    Symbol name(NodeIndex node) const { return Symbol(lhs[node]); }
+    int intValue(NodeIndex node) const { return static_cast<int>(lhs[node]); }
+    float floatValue(NodeIndex node) const {
+        float value;
+        std::memcpy(&value, &lhs[node], sizeof(value));
+        return value;
+    }
+    NodeRange children(NodeIndex node) const { return list(lhs[node]); } // BLOCK、VAR_DECL、COMP_UNIT的第一个列表
+    NodeRange funcDefs(NodeIndex node) const { return list(rhs[node]); } // COMP_UNIT
+    NodeRange params(NodeIndex node) const { return list(extra[rhs[node]]); } // FUNC_DEF
+    NodeIndex body(NodeIndex node) const { return extra[rhs[node] + 1]; }    // FUNC_DEF
+    NodeRange args(NodeIndex node) const { return list(rhs[node]); }     // CALL_EXPR
+    NodeRange dims(NodeIndex node) const { return list(extra[rhs[node]]); }     // VAR_DEF
+    NodeIndex initExpr(NodeIndex node) const { return extra[rhs[node] + 1]; }  // VAR_DEF
+    NodeIndex thenBranch(NodeIndex node) const { return extra[rhs[node]]; }     // IF_STMT
+    NodeIndex elseBranch(NodeIndex node) const { return extra[rhs[node] + 1]; } // IF_STMT
+
+    // 扁平编码占用的字节数
+    size_t memoryBytes() const {
+        return kinds.size() * (sizeof(NodeKind) + sizeof(uint8_t) + sizeof(int) + 2 * sizeof(uint32_t)) +
+               extra.size() * sizeof(uint32_t);
+    }
+};
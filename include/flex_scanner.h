@@ -0,0 +1,49 @@
+#pragma once
+#include "token.h"
+#include "token_stream.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Flex扫描器的状态，规则动作通过yyextra访问
+struct FlexScanState {
+    size_t position = 0;                    // 已匹配的字节数（下一个Token的起始偏移）
+    size_t line = 1;                        // 当前行号
+    bool finished = false;                  // 是否已经遇到源代码结束
+    Token token;                            // 最近一次识别出的Token
+    std::vector<std::string> errorMessages; // 错误信息旁路表，UNKNOWN Token通过errorIndex引用
+};
+
+// FlexScanner类 - 由src/scanner.l生成的表驱动DFA扫描器
+// 接口与Lexer相同，产生的Token序列（类型、行号、原文位置、值和错误信息）与手写词法分析器完全一致
+// 只在配置时找到flex的情况下构建（定义SYSY_HAVE_FLEX）
+class FlexScanner {
+private:
+    std::string_view source; // 源代码（不复制；flex内部会复制一份用于扫描）
+    FlexScanState state;     // 扫描状态
+    void* scanner;           // flex的可重入扫描器（yyscan_t）
+    void* buffer;            // flex的输入缓冲区（YY_BUFFER_STATE）
+    
+public:
+    // 构造函数
+    // 参数：source - 要分析的源代码，生命周期需覆盖扫描器及其产生的Token
+    FlexScanner(std::string_view source);
+    ~FlexScanner();
+    FlexScanner(const FlexScanner&) = delete;
+    FlexScanner& operator=(const FlexScanner&) = delete;
+    
+    // 获取下一个Token
+    Token getNextToken();
+    
+    // 一次性扫描全部源代码，生成物化的Token缓冲区（末尾总是END_OF_FILE）
+    TokenStream tokenize();
+    
+    // 获取UNKNOWN Token的错误信息
+    const std::string& getErrorMessage(const Token& token) const { return state.errorMessages.at(token.errorIndex); }
+    
+    // 获取Token在源代码中的原文
+    std::string_view lexeme(const Token& token) const { return source.substr(token.offset, token.length()); }
+    
+    // 获取当前行号
+    size_t getLine() const { return state.line; }
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Symbol - 标识符的32位编号
+// 同名标识符在整个进程内编号相同，名字比较退化为整数比较
+// 默认构造不初始化，以便放入Token的union中；编号0固定表示空名字
+struct Symbol {
+    uint32_t id; // 在StringInterner中的编号
+
+    Symbol() = default;
+    constexpr explicit Symbol(uint32_t id) : id(id) {}
+
+    // 获取标识符的名字
+    std::string_view str() const;
+    // 判断是否为空名字
+    bool empty() const { return id == 0; }
+
+    bool operator==(Symbol other) const { return id == other.id; }
+    bool operator!=(Symbol other) const { return id != other.id; }
+};
+
+// 输出标识符的名字
+std::ostream& operator<<(std::ostream& os, Symbol symbol);
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    size_t operator()(Symbol symbol) const noexcept { return symbol.id; }
+};
+}
+
+// StringInterner类 - 字符串驻留表
+// 每个不同的名字只保存一份，并分配一个递增的Symbol编号
+// Symbol::str()总是查询进程范围的驻留表；驻留表本身不加锁，
+// 并行词法分析时每个线程使用自己的局部驻留表，合并结果时再映射到进程范围的编号
+class StringInterner {
+private:
+    std::deque<std::string> names;                          // 按编号保存的名字，deque保证元素地址不变
+    std::unordered_map<std::string_view, uint32_t> ids;     // 名字到编号的映射，键引用names中的字符串
+
+public:
+    // 创建局部驻留表（同样预先驻留空名字）
+    StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // 获取进程范围的驻留表
+    static StringInterner& global();
+
+    // 驻留名字，返回它的编号（已存在则直接返回原编号）
+    Symbol intern(std::string_view name);
+
+    // 根据编号获取名字
+    std::string_view name(Symbol symbol) const { return names[symbol.id]; }
+
+    // 已驻留的名字数量（包括空名字）
+    size_t size() const { return names.size(); }
+};
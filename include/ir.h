@@ -0,0 +1,417 @@
+#pragma once
+#include "arena.h"
+#include "interner.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// 中间代码（IR）：SSA形式的模块、函数、基本块和带类型的指令
+// 指令的操作数通过Use记录，每个Value把使用自己的全部Use串成侵入式的双向链表（use-def链），
+// 因此"替换全部使用"和"是否还有使用"都不需要扫描整个函数。
+// 一个函数的全部基本块、指令、形参和常量都分配在该函数自己的Arena中，随函数一起释放；
+// 和语法树一样，放入Arena的对象不会被析构，因此不能持有std::vector等需要析构的成员
+
+class Use;
+class Instruction;
+class BasicBlock;
+class Function;
+class Module;
+
+// 值的类型：SysY只有int和float两种标量，数组通过指针访问
+enum class IRType : uint8_t {
+    VOID, // 无值（store、跳转、void函数的返回）
+    I32,  // 32位整数，比较运算的结果也是i32（0或1）
+    F32,  // 单精度浮点数
+    PTR   // 标量元素的地址
+};
+
+// 值的种类
+enum class ValueKind : uint8_t {
+    CONSTANT,   // 整数或浮点数常量
+    ARGUMENT,   // 函数形参
+    GLOBAL,     // 全局变量（值为它的地址）
+    INSTRUCTION // 指令的结果
+};
+
+// Value类 - 可以作为指令操作数的值
+class Value {
+private:
+    ValueKind kind; // 值的种类
+    IRType type;    // 值的类型
+    mutable uint32_t number; // 输出时的编号（%n），由输出函数临时设置，放在对齐填充中不增加对象大小
+    Use* uses;      // 使用本值的Use链表的头
+
+    friend class Use;
+    friend class FunctionPrinter;
+
+protected:
+    Value(ValueKind kind, IRType type) : kind(kind), type(type), number(0), uses(nullptr) {}
+
+public:
+    ValueKind getKind() const { return kind; }
+    IRType getType() const { return type; }
+    // 使用本值的第一个Use，沿Use::getNext遍历全部使用
+    Use* getUses() const { return uses; }
+    bool hasUses() const { return uses != nullptr; }
+    // 把本值的全部使用改为使用value
+    void replaceAllUsesWith(Value* value);
+};
+
+// 按值的种类判断类型，与语法树的isa/cast/dyn_cast（ast.h）用法相同
+template <typename T>
+inline bool isa(const Value* value) {
+    return T::classof(value);
+}
+
+template <typename T>
+inline T* cast(Value* value) {
+    return static_cast<T*>(value);
+}
+
+template <typename T>
+inline T* dyn_cast(Value* value) {
+    return value != nullptr && T::classof(value) ? static_cast<T*>(value) : nullptr;
+}
+
+// Use类 - 指令的一个操作数
+// 同一个值的全部Use串成双向链表：prev指向前一个Use的next字段（或者值的链表头），删除时不需要查找
+class Use {
+private:
+    Value* value;      // 使用的值，可以为nullptr
+    Instruction* user; // 使用者
+    Use* next;         // 同一个值的下一个Use
+    Use** prev;        // 指向本Use的指针（前一个Use的next或者值的uses）
+
+    void link();
+    void unlink();
+
+public:
+    Use() : value(nullptr), user(nullptr), next(nullptr), prev(nullptr) {}
+    Use(const Use&) = delete;
+    Use& operator=(const Use&) = delete;
+
+    Value* get() const { return value; }
+    Instruction* getUser() const { return user; }
+    Use* getNext() const { return next; }
+    // 改为使用newValue，同时维护新旧两个值的Use链表
+    void set(Value* newValue);
+    // 设置使用者（指令创建操作数时调用）
+    void setUser(Instruction* value) { user = value; }
+};
+
+// Constant类 - 整数或浮点数常量，同一函数中值相同的常量只有一个
+class Constant : public Value {
+private:
+    union {
+        int intValue;
+        float floatValue;
+    };
+
+public:
+    explicit Constant(int value) : Value(ValueKind::CONSTANT, IRType::I32), intValue(value) {}
+    explicit Constant(float value) : Value(ValueKind::CONSTANT, IRType::F32), floatValue(value) {}
+
+    int getIntValue() const { return intValue; }
+    float getFloatValue() const { return floatValue; }
+
+    static bool classof(const Value* value) { return value->getKind() == ValueKind::CONSTANT; }
+};
+
+// Argument类 - 函数形参，数组形参的类型为指针
+class Argument : public Value {
+private:
+    Symbol name;    // 形参名
+    unsigned index; // 形参序号
+
+public:
+    Argument(IRType type, Symbol name, unsigned index) : Value(ValueKind::ARGUMENT, type), name(name), index(index) {}
+
+    Symbol getName() const { return name; }
+    unsigned getIndex() const { return index; }
+
+    static bool classof(const Value* value) { return value->getKind() == ValueKind::ARGUMENT; }
+};
+
+// GlobalVariable类 - 全局变量，值为它的地址（指针）
+// 标量和数组统一为count个元素，初始值只有标量可以指定，其余元素为0
+class GlobalVariable : public Value {
+private:
+    Symbol name;         // 变量名
+    IRType elementType;  // 元素类型（I32或F32）
+    uint32_t count;      // 元素个数
+    bool isArray;        // 是否为数组
+    union {
+        int intInit;
+        float floatInit;
+    };
+
+public:
+    GlobalVariable(Symbol name, IRType elementType, uint32_t count, bool isArray)
+        : Value(ValueKind::GLOBAL, IRType::PTR), name(name), elementType(elementType), count(count),
+          isArray(isArray), intInit(0) {}
+
+    Symbol getName() const { return name; }
+    IRType getElementType() const { return elementType; }
+    uint32_t getCount() const { return count; }
+    bool getIsArray() const { return isArray; }
+    int getIntInit() const { return intInit; }
+    float getFloatInit() const { return floatInit; }
+    // 设置标量的初始值
+    void setInit(int value) { intInit = value; }
+    void setInit(float value) { floatInit = value; }
+
+    static bool classof(const Value* value) { return value->getKind() == ValueKind::GLOBAL; }
+};
+
+// 指令的操作码
+enum class Opcode : uint8_t {
+    // 整数运算（i32）
+    ADD, SUB, MUL, SDIV, SREM,
+    // 浮点运算（f32）
+    FADD, FSUB, FMUL, FDIV, FREM, FNEG,
+    // 比较：结果为i32，谓词见CmpPredicate
+    ICMP, FCMP,
+    // 内存：ALLOCA在栈上分配count个元素，GEP计算"基地址 + 下标 * 元素大小"
+    ALLOCA, LOAD, STORE, GEP,
+    // 函数调用
+    CALL,
+    // SSA的φ函数：每个操作数对应一个前驱基本块
+    PHI,
+    // 终结指令：无条件跳转、条件跳转（条件为非0的i32时跳到第一个目标）、返回
+    BR, CONDBR, RET
+};
+
+// 比较谓词
+enum class CmpPredicate : uint8_t { EQ, NE, LT, GT, LE, GE };
+
+// Instruction类 - 指令，同时也是它的结果值
+// 操作数是分配在Arena中的Use数组；跳转目标和φ函数的前驱块保存在与操作数并列的blocks数组中。
+// 指令在基本块中按执行顺序串成双向链表，插入和删除都是常数时间
+class Instruction : public Value {
+private:
+    Opcode opcode;          // 操作码
+    CmpPredicate predicate; // 比较谓词（ICMP、FCMP）
+    BasicBlock* parent;     // 所在基本块
+    Instruction* prev;      // 基本块中的上一条指令
+    Instruction* next;      // 基本块中的下一条指令
+    Use* operands;          // 操作数
+    BasicBlock** blocks;    // 跳转目标（BR、CONDBR）或前驱块（PHI）
+    uint32_t operandCount;  // 操作数个数
+    uint32_t capacity;      // operands和blocks的容量（PHI添加前驱时按需扩大）
+    uint32_t blockCount;    // blocks中的有效个数
+    uint32_t allocaCount;   // ALLOCA分配的元素个数
+    IRType allocatedType;   // ALLOCA分配的元素类型
+    bool allocatedArray;    // ALLOCA是否为数组
+    Symbol name;            // ALLOCA对应的变量名，用于输出
+    Function* callee;       // 被调用的函数（CALL）
+
+    friend class BasicBlock;
+    friend class IRBuilder;
+
+public:
+    Instruction(Opcode opcode, IRType type)
+        : Value(ValueKind::INSTRUCTION, type), opcode(opcode), predicate(CmpPredicate::EQ), parent(nullptr),
+          prev(nullptr), next(nullptr), operands(nullptr), blocks(nullptr), operandCount(0), capacity(0),
+          blockCount(0), allocaCount(1), allocatedType(IRType::I32), allocatedArray(false), name(0),
+          callee(nullptr) {}
+
+    Opcode getOpcode() const { return opcode; }
+    CmpPredicate getPredicate() const { return predicate; }
+    BasicBlock* getParent() const { return parent; }
+    Instruction* getPrev() const { return prev; }
+    Instruction* getNext() const { return next; }
+    bool isTerminator() const {
+        return opcode == Opcode::BR || opcode == Opcode::CONDBR || opcode == Opcode::RET;
+    }
+
+    // 操作数
+    uint32_t getOperandCount() const { return operandCount; }
+    Value* getOperand(uint32_t index) const { return operands[index].get(); }
+    Use& getOperandUse(uint32_t index) const { return operands[index]; }
+    void setOperand(uint32_t index, Value* value) { operands[index].set(value); }
+
+    // 跳转目标（BR：1个，CONDBR：真、假2个）或φ函数的前驱块
+    uint32_t getBlockCount() const { return blockCount; }
+    BasicBlock* getBlock(uint32_t index) const { return blocks[index]; }
+    void setBlock(uint32_t index, BasicBlock* block) { blocks[index] = block; }
+
+    // φ函数：添加一个来自前驱块block的值
+    void addIncoming(Value* value, BasicBlock* block, Arena& arena);
+    // φ函数：删除第index个前驱
+    void removeIncoming(uint32_t index);
+    // φ函数：来自前驱块block的值，没有时返回nullptr
+    Value* getIncomingValueFor(const BasicBlock* block) const;
+
+    // ALLOCA
+    uint32_t getAllocaCount() const { return allocaCount; }
+    IRType getAllocatedType() const { return allocatedType; }
+    bool isArrayAlloca() const { return allocatedArray; }
+    Symbol getName() const { return name; }
+
+    // CALL
+    Function* getCallee() const { return callee; }
+
+    // 清除全部操作数的使用（删除指令之前调用）
+    void dropOperands();
+    // 从基本块中摘除并清除操作数；指令的结果不能再有使用
+    void eraseFromParent();
+
+    static bool classof(const Value* value) { return value->getKind() == ValueKind::INSTRUCTION; }
+};
+
+// BasicBlock类 - 基本块：以一条终结指令结束的指令序列
+// 基本块在函数中串成双向链表，index是按链表顺序的编号，由Function::renumberBlocks更新，供分析使用
+class BasicBlock {
+private:
+    Function* parent;   // 所在函数
+    Instruction* first; // 第一条指令
+    Instruction* last;  // 最后一条指令
+    BasicBlock* prev;   // 函数中的上一个基本块
+    BasicBlock* next;   // 函数中的下一个基本块
+    uint32_t index;     // 编号
+
+    friend class Function;
+
+public:
+    explicit BasicBlock(Function* parent) : parent(parent), first(nullptr), last(nullptr), prev(nullptr),
+                                            next(nullptr), index(0) {}
+
+    Function* getParent() const { return parent; }
+    Instruction* getFirst() const { return first; }
+    Instruction* getLast() const { return last; }
+    BasicBlock* getPrev() const { return prev; }
+    BasicBlock* getNext() const { return next; }
+    uint32_t getIndex() const { return index; }
+    bool empty() const { return first == nullptr; }
+
+    // 终结指令，基本块尚未结束时返回nullptr
+    Instruction* getTerminator() const {
+        return last != nullptr && last->isTerminator() ? last : nullptr;
+    }
+    // 后继块的个数和第index个后继块
+    uint32_t getSuccessorCount() const {
+        Instruction* terminator = getTerminator();
+        return terminator != nullptr ? terminator->getBlockCount() : 0;
+    }
+    BasicBlock* getSuccessor(uint32_t index) const { return last->getBlock(index); }
+
+    // 把指令插入到before之前，before为nullptr时追加到末尾
+    void insert(Instruction* inst, Instruction* before);
+    // 摘除指令（不清除操作数）
+    void remove(Instruction* inst);
+};
+
+// Function类 - 函数：形参和基本块的链表，第一个基本块为入口
+// 由Module持有；函数自己的Arena保存它的全部基本块、指令、形参和常量
+class Function {
+private:
+    Symbol name;                                      // 函数名
+    IRType returnType;                                // 返回类型
+    Arena arena;                                      // 本函数的IR对象所在的Arena
+    std::vector<Argument*> args;                      // 形参
+    BasicBlock* first;                                // 入口块
+    BasicBlock* last;                                 // 最后一个基本块
+    size_t blockCount;                                // 基本块个数
+    std::unordered_map<int, Constant*> intConstants;  // 整数常量
+    std::unordered_map<uint32_t, Constant*> floatConstants; // 浮点数常量，按位模式区分
+
+public:
+    Function(Symbol name, IRType returnType);
+    Function(const Function&) = delete;
+    Function& operator=(const Function&) = delete;
+
+    Symbol getName() const { return name; }
+    IRType getReturnType() const { return returnType; }
+    Arena& getArena() { return arena; }
+
+    // 形参
+    Argument* addArgument(IRType type, Symbol name);
+    const std::vector<Argument*>& getArgs() const { return args; }
+
+    // 基本块
+    BasicBlock* getEntry() const { return first; }
+    BasicBlock* getLast() const { return last; }
+    size_t getBlockCount() const { return blockCount; }
+    // 在末尾创建一个新的基本块
+    BasicBlock* createBlock();
+    // 删除基本块：清除其中全部指令的操作数并从链表中摘除；其中的指令结果不能再有使用
+    void eraseBlock(BasicBlock* block);
+    // 按链表顺序重新给基本块编号（0到getBlockCount()-1）
+    void renumberBlocks();
+    // 按order重新排列基本块并编号，不在order中的基本块被删除：
+    // 从保留下来的后继块的φ函数中删除来自它的值，再清除其中全部指令的操作数
+    void reorderBlocks(const std::vector<BasicBlock*>& order);
+
+    // 常量
+    Constant* getConstant(int value);
+    Constant* getConstant(float value);
+};
+
+// Module类 - 一个编译单元的IR：全局变量和函数
+class Module {
+private:
+    Arena arena;                                     // 全局变量所在的Arena
+    std::vector<GlobalVariable*> globals;            // 全局变量
+    std::vector<std::unique_ptr<Function>> functions; // 函数，按源代码顺序
+
+public:
+    Module() = default;
+    Module(const Module&) = delete;
+    Module& operator=(const Module&) = delete;
+
+    // 创建全局变量
+    GlobalVariable* createGlobal(Symbol name, IRType elementType, uint32_t count, bool isArray);
+    // 创建函数
+    Function* createFunction(Symbol name, IRType returnType);
+
+    const std::vector<GlobalVariable*>& getGlobals() const { return globals; }
+    const std::vector<std::unique_ptr<Function>>& getFunctions() const { return functions; }
+
+    // 以文本形式输出整个模块（--emit-ir）
+    void print(std::ostream& out) const;
+};
+
+// 以文本形式输出一个函数
+void printFunction(const Function& function, std::ostream& out);
+
+// IRBuilder类 - 在插入点创建指令
+// 插入点是一个基本块和其中的一条指令，新指令插入到这条指令之前；指令为nullptr时追加到基本块末尾
+class IRBuilder {
+private:
+    Function* function;    // 所在函数
+    BasicBlock* block;     // 插入点所在的基本块
+    Instruction* before;   // 插入到这条指令之前，nullptr表示末尾
+
+    // 分配一条有operandCount个操作数、blockCount个目标块的指令并插入
+    Instruction* create(Opcode opcode, IRType type, uint32_t operandCount, uint32_t blockCount);
+
+public:
+    explicit IRBuilder(Function* function) : function(function), block(nullptr), before(nullptr) {}
+
+    Function* getFunction() const { return function; }
+    BasicBlock* getBlock() const { return block; }
+    // 设置插入点：追加到block末尾
+    void setInsertPoint(BasicBlock* value) { block = value; before = nullptr; }
+    // 设置插入点：插入到inst之前
+    void setInsertPoint(Instruction* inst) { block = inst->getParent(); before = inst; }
+
+    // 算术运算
+    Instruction* createBinary(Opcode opcode, Value* left, Value* right);
+    Instruction* createNeg(Value* operand);
+    Instruction* createCmp(CmpPredicate predicate, Value* left, Value* right);
+    // 内存访问
+    Instruction* createAlloca(IRType type, uint32_t count, bool isArray, Symbol name);
+    Instruction* createLoad(IRType type, Value* address);
+    Instruction* createStore(Value* value, Value* address);
+    Instruction* createGep(Value* base, Value* index);
+    // 函数调用
+    Instruction* createCall(Function* callee, Value* const* args, size_t argCount);
+    // φ函数，预留capacity个前驱
+    Instruction* createPhi(IRType type, uint32_t capacity);
+    // 终结指令
+    Instruction* createBr(BasicBlock* target);
+    Instruction* createCondBr(Value* condition, BasicBlock* trueBlock, BasicBlock* falseBlock);
+    Instruction* createRet(Value* value);
+};
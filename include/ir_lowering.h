@@ -0,0 +1,105 @@
+#pragma once
+#include "ast_visitor.h"
+#include "const_eval.h"
+#include "ir.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// IRLowering类 - 把语义检查通过、完成常量折叠的语法树翻译为IR
+// 局部变量和标量形参一律放在入口块开头的alloca中，读写都是load/store，之后由mem2reg提升为SSA值；
+// 数组按行优先连续存放，多维下标折算成一个线性下标，用一条gep取元素地址，下标不足全部维数时结果为子数组的地址。
+// 条件中的&&、||和!直接翻译为跳转，出现在值的位置时经过分支和φ函数得到0或1。
+// 表达式用显式栈翻译，长度和嵌套深度都不消耗调用栈；语句按嵌套递归访问
+class IRLowering : public RecursiveASTVisitor<IRLowering> {
+private:
+    // 变量的存储位置
+    struct Storage {
+        Value* address;       // 变量（或数组首元素）的地址
+        IRType elementType;   // 元素类型
+        uint32_t strideBegin; // 各维步长在strides中的起始位置
+        uint32_t rank;        // 数组维数，标量为0
+    };
+
+    // 表达式的翻译方式
+    enum class Mode : uint8_t {
+        VALUE,   // 计算值
+        ADDRESS, // 计算地址（赋值的左侧）
+        COND     // 按真假跳转到trueBlock或falseBlock
+    };
+
+    // 工作栈中的一项
+    struct Frame {
+        Mode mode;              // 翻译方式
+        uint8_t stage;          // 0表示子表达式尚未压栈
+        Expr* expr;             // 待翻译的表达式
+        BasicBlock* trueBlock;  // COND：为真时的目标；VALUE中的&&、||：为真的块
+        BasicBlock* falseBlock; // COND：为假时的目标；VALUE中的&&、||：为假的块
+        BasicBlock* rightBlock; // COND中的&&、||：翻译右操作数的块
+    };
+
+    // 正在翻译的循环：continue和break的跳转目标
+    struct Loop {
+        BasicBlock* condBlock; // continue跳转到条件块
+        BasicBlock* exitBlock; // break跳转到循环之后的块
+    };
+
+    Module& module;                                      // 生成的模块
+    Function* function;                                  // 正在翻译的函数，全局作用域为nullptr
+    IRBuilder builder;                                   // 在当前基本块末尾插入指令
+    Instruction* lastAlloca;                             // 入口块中最后一条alloca
+    std::unordered_map<const ASTNode*, Storage> globals; // 全局变量定义到存储位置
+    std::unordered_map<const ASTNode*, Storage> locals;  // 当前函数的局部变量定义、形参到存储位置，每个函数开始时清空
+    std::unordered_map<const FuncDef*, Function*> functions; // 函数定义到IR函数
+    std::vector<uint32_t> strides;                       // 数组的各维步长（以元素为单位），全局数组的在前
+    size_t globalStrideCount;                            // 全局数组的步长个数
+    std::vector<Frame> frames;                           // 表达式的工作栈
+    std::vector<Value*> values;                          // 已翻译但尚未被父表达式取走的值
+    std::vector<Expr*> indices;                          // 数组下标的暂存区
+    std::vector<Loop> loops;                             // 由外到内的循环嵌套
+    ConstEvaluator evaluator;                            // 计算数组长度和全局变量的初始值
+
+    explicit IRLowering(Module& module);
+
+    // 在入口块开头分配变量
+    Instruction* createAlloca(IRType type, uint32_t count, bool isArray, Symbol name);
+    // 登记数组变量的存储位置，各维长度依次为dims
+    void addStorage(const ASTNode* decl, Value* address, IRType elementType, const std::vector<uint32_t>& dims);
+    // 变量定义或形参的存储位置
+    const Storage& storageOf(const ASTNode* decl);
+    // 数组一维的长度（已折叠为常量）
+    uint32_t dimensionOf(Expr* dim);
+    // 当前基本块已经结束时，开始一个新的（不可达的）基本块
+    void ensureOpenBlock();
+    // 翻译表达式：VALUE返回值，ADDRESS返回地址，COND返回nullptr
+    Value* lowerExpr(Expr* expr, Mode mode, BasicBlock* trueBlock = nullptr, BasicBlock* falseBlock = nullptr);
+    // 处理工作栈顶的一项
+    void step();
+    // 条件的翻译：&&、||和!拆成跳转，其余表达式求值后按是否为0跳转
+    void stepCondition(Frame frame);
+    // 二元运算（操作数的值已经求出）
+    Value* lowerBinary(TokenType op, Value* left, Value* right);
+    // 数组下标表达式：收集下标到indices，返回被索引的变量
+    VariableExpr* collectIndices(IndexExpr& node);
+    // 下标的乘法和加法，两个操作数都是常量时直接算出结果
+    Value* combineIndex(Opcode opcode, Value* left, Value* right);
+    // 计算元素（或子数组）的地址，下标的值在values末尾；返回地址，isElement表示是否下标到了单个元素
+    Value* elementAddress(const Storage& slot, size_t indexCount, bool& isElement);
+    // 删除从入口不可达的基本块，其余按逆后序排列
+    void finishFunction();
+
+public:
+    // 翻译整个编译单元
+    static std::unique_ptr<Module> lower(CompUnit& unit);
+
+    void visitCompUnit(CompUnit& node);
+    void visitFuncDef(FuncDef& node);
+    void visitVarDecl(VarDecl& node);
+    void visitBlock(Block& node);
+    void visitExprStmt(ExprStmt& node);
+    void visitIfStmt(IfStmt& node);
+    void visitWhileStmt(WhileStmt& node);
+    void visitBreakStmt(BreakStmt& node);
+    void visitContinueStmt(ContinueStmt& node);
+    void visitReturnStmt(ReturnStmt& node);
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include "token.h"
+#include "token_stream.h"
+#include <string_view>
+
+// ParallelLexer类 - 多线程词法分析器
+// 把源代码在换行处切分为若干块，每块由一个线程独立分析，再拼接为一个Token缓冲区
+// 块边界可能落在多行注释内部，因此每块的分析都是推测性的：合并时检查前一块实际停下的位置
+// 是否与后一块的某个Token对齐（偏移和行号都相同），不对齐时从该位置起重新顺序分析，直到重新对齐
+// 结果与对整个源代码顺序调用Lexer::tokenize完全一致，包括行号和词法错误
+class ParallelLexer {
+public:
+    // 每块的最小字节数，源代码较小时直接顺序分析
+    static constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+    
+private:
+    std::string_view source; // 源代码（不复制）
+    unsigned threadCount;    // 最多使用的线程数
+    
+public:
+    // 构造函数
+    // 参数：source - 要分析的源代码，生命周期需覆盖产生的Token缓冲区
+    //       threadCount - 最多使用的线程数，0表示使用硬件线程数
+    ParallelLexer(std::string_view source, unsigned threadCount = 0);
+    
+    // 扫描全部源代码，生成与Lexer::tokenize相同的Token缓冲区
+    TokenStream tokenize();
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include "dominators.h"
+#include "ir.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 中端的Pass管理
+// 优化以函数为单位进行：PassManager对每个函数依次运行全部Pass，函数级分析（支配树等）由AnalysisManager
+// 在第一次被请求时计算并缓存。Pass声明自己需要和保留的分析，修改了函数的Pass运行后，没有保留的分析被丢弃，
+// 下一次请求时重新计算；没有修改函数时全部分析都保留
+
+// 函数级分析的种类
+enum class Analysis : uint8_t {
+    DOMINATOR_TREE,      // 支配树
+    POST_DOMINATOR_TREE, // 后支配树
+    DOMINANCE_FRONTIER   // 支配边界（依赖支配树）
+};
+
+constexpr uint32_t ANALYSIS_COUNT = 3;
+
+// 分析的集合，按Analysis的编号取位
+using AnalysisSet = uint32_t;
+
+constexpr AnalysisSet NO_ANALYSES = 0;
+// 目前的分析都只依赖控制流图，只修改基本块内部指令、不改变跳转关系的Pass可以全部保留
+constexpr AnalysisSet ALL_ANALYSES = (1u << ANALYSIS_COUNT) - 1;
+
+constexpr AnalysisSet analysisSet(Analysis analysis) {
+    return 1u << static_cast<uint32_t>(analysis);
+}
+
+template <typename... Rest>
+constexpr AnalysisSet analysisSet(Analysis analysis, Rest... rest) {
+    return analysisSet(analysis) | analysisSet(rest...);
+}
+
+// AnalysisManager类 - 函数级分析的缓存
+class AnalysisManager {
+private:
+    // 一个函数已经计算的分析
+    struct FunctionAnalyses {
+        std::unique_ptr<DominatorTree> domTree;
+        std::unique_ptr<PostDominatorTree> postDomTree;
+        std::unique_ptr<DominanceFrontier> frontier;
+    };
+
+    std::unordered_map<const Function*, FunctionAnalyses> cache;
+    bool timing;                           // 是否统计计算分析的耗时
+    double computeMs[ANALYSIS_COUNT];      // 每种分析累计的计算时间
+    size_t computeCount[ANALYSIS_COUNT];   // 每种分析的计算次数
+
+    // 计时并计数
+    template <typename Func>
+    void measure(Analysis analysis, Func&& func);
+
+public:
+    AnalysisManager();
+    AnalysisManager(const AnalysisManager&) = delete;
+    AnalysisManager& operator=(const AnalysisManager&) = delete;
+
+    // 取得分析结果，没有缓存时计算
+    DominatorTree& getDominatorTree(Function& function);
+    PostDominatorTree& getPostDominatorTree(Function& function);
+    DominanceFrontier& getDominanceFrontier(Function& function);
+    // 确保analyses中的分析都已计算
+    void compute(Function& function, AnalysisSet analyses);
+    // 分析是否已缓存
+    bool isCached(const Function& function, Analysis analysis) const;
+
+    // 丢弃preserved之外的分析；依赖于被丢弃的分析的结果也一并丢弃
+    void invalidate(const Function& function, AnalysisSet preserved);
+    // 丢弃函数的全部分析
+    void release(const Function& function) { cache.erase(&function); }
+
+    // 统计
+    void setTiming(bool value) { timing = value; }
+    double getComputeMs(Analysis analysis) const { return computeMs[static_cast<uint32_t>(analysis)]; }
+    size_t getComputeCount(Analysis analysis) const { return computeCount[static_cast<uint32_t>(analysis)]; }
+    double getTotalComputeMs() const;
+
+    static const char* getName(Analysis analysis);
+};
+
+// FunctionPass类 - 对单个函数的变换
+class FunctionPass {
+public:
+    virtual ~FunctionPass() = default;
+
+    // Pass的名字（-print-after和-time-passes中使用）
+    virtual const char* getName() const = 0;
+    // 需要的分析：运行前计算好，运行中也可以通过AnalysisManager按需取得其他分析
+    virtual AnalysisSet getRequired() const { return NO_ANALYSES; }
+    // 修改了函数时仍然有效的分析
+    virtual AnalysisSet getPreserved() const { return NO_ANALYSES; }
+    // 变换函数，返回是否修改了函数
+    virtual bool run(Function& function, AnalysisManager& analyses) = 0;
+};
+
+// PassManager类 - 按顺序对模块中的每个函数运行一组Pass
+class PassManager {
+private:
+    // 每个Pass的统计
+    struct PassStats {
+        double ms;     // 累计运行时间（不含其中计算分析的时间）
+        size_t runs;   // 运行次数
+        size_t changes; // 修改了函数的次数
+    };
+
+    std::vector<std::unique_ptr<FunctionPass>> passes;
+    std::vector<PassStats> stats;
+    AnalysisManager analyses;
+    std::string printAfter;    // 在名为printAfter的Pass之后输出函数，"all"表示每个Pass之后
+    std::ostream* printStream; // -print-after的输出流
+    bool timePasses;           // 是否统计各Pass的耗时
+
+public:
+    PassManager();
+
+    void add(std::unique_ptr<FunctionPass> pass);
+    size_t size() const { return passes.size(); }
+
+    // -print-after：在名为name（或"all"）的Pass之后把函数输出到out
+    void setPrintAfter(const std::string& name, std::ostream& out);
+    // -time-passes：统计各Pass和分析的耗时
+    void setTimePasses(bool value);
+
+    // 运行全部Pass：逐个函数依次运行，一个函数完成后释放它的分析
+    void run(Module& module);
+    void run(Function& function);
+
+    // 输出耗时统计，按耗时从大到小排列
+    void printTimeReport(std::ostream& out) const;
+};
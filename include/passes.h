@@ -0,0 +1,53 @@
+#pragma once
+#include "pass_manager.h"
+#include <memory>
+#include <string_view>
+
+// 优化Pass
+
+// PromoteMemToRegPass类 - 把标量局部变量和形参从栈上提升为SSA值（mem2reg）
+// 只被load和store访问的标量alloca被删除：在变量活跃的迭代支配边界处放置φ函数，再沿支配树把load替换为到达的定值。
+// 不改变控制流图
+class PromoteMemToRegPass : public FunctionPass {
+public:
+    const char* getName() const override { return "mem2reg"; }
+    AnalysisSet getRequired() const override {
+        return analysisSet(Analysis::DOMINATOR_TREE, Analysis::DOMINANCE_FRONTIER);
+    }
+    AnalysisSet getPreserved() const override { return ALL_ANALYSES; }
+    bool run(Function& function, AnalysisManager& analyses) override;
+};
+
+// SimplifyCfgPass类 - 化简控制流图（simplifycfg）
+// 条件为常量或两个目标相同的条件跳转改为无条件跳转；删除不可达的基本块；
+// 只含一条无条件跳转的基本块让前驱直接跳到它的目标；唯一前驱以无条件跳转进入的基本块并入前驱
+class SimplifyCfgPass : public FunctionPass {
+public:
+    const char* getName() const override { return "simplifycfg"; }
+    bool run(Function& function, AnalysisManager& analyses) override;
+};
+
+// DeadCodeEliminationPass类 - 删除结果没有使用、也没有副作用的指令（dce）
+// store、call和终结指令保留；删除一条指令后，它的操作数可能随之变为无用，用工作表继续处理
+class DeadCodeEliminationPass : public FunctionPass {
+public:
+    const char* getName() const override { return "dce"; }
+    AnalysisSet getPreserved() const override { return ALL_ANALYSES; }
+    bool run(Function& function, AnalysisManager& analyses) override;
+};
+
+// InstSimplifyPass类 - 指令化简（instsimplify）
+// 操作数全是常量的算术和比较指令替换为结果常量，x+0、x*1等恒等式替换为x，全部来源相同的φ函数替换为该值；
+// 只替换使用，不改变控制流，被替换的指令留给dce删除
+class InstSimplifyPass : public FunctionPass {
+public:
+    const char* getName() const override { return "instsimplify"; }
+    AnalysisSet getPreserved() const override { return ALL_ANALYSES; }
+    bool run(Function& function, AnalysisManager& analyses) override;
+};
+
+// 按名字创建Pass，名字未知时返回nullptr
+std::unique_ptr<FunctionPass> createPass(std::string_view name);
+
+// 按优化级别添加Pass：-O0不优化，-O1把局部变量提升为SSA值、化简控制流图并删除死代码，-O2在提升之后先化简指令
+void addOptimizationPipeline(PassManager& passManager, int level);
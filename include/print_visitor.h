@@ -1,10 +1,10 @@
 #pragma once
-#include "ast.h"
+#include "ast_visitor.h"
 #include <string>
 #include <iostream>
 
 // 打印访问者类，用于实现语法树的先序遍历打印
-class PrintVisitor : public ASTVisitor {
+class PrintVisitor : public RecursiveASTVisitor<PrintVisitor> {
 private:
     int indentation; // 缩进级别，用于格式化输出
     
@@ -22,37 +22,41 @@ public:
     PrintVisitor();
     
     // 访问编译单元节点
-    void visit(CompUnit& node) override;
+    void visitCompUnit(CompUnit& node);
     // 访问函数定义节点
-    void visit(FuncDef& node) override;
+    void visitFuncDef(FuncDef& node);
     // 访问变量声明节点
-    void visit(VarDecl& node) override;
+    void visitVarDecl(VarDecl& node);
     // 访问if语句节点
-    void visit(IfStmt& node) override;
+    void visitIfStmt(IfStmt& node);
     // 访问while语句节点
-    void visit(WhileStmt& node) override;
+    void visitWhileStmt(WhileStmt& node);
+    // 访问break语句节点
+    void visitBreakStmt(BreakStmt& node);
+    // 访问continue语句节点
+    void visitContinueStmt(ContinueStmt& node);
     // 访问return语句节点
-    void visit(ReturnStmt& node) override;
+    void visitReturnStmt(ReturnStmt& node);
     // 访问二元表达式节点
-    void visit(BinaryExpr& node) override;
+    void visitBinaryExpr(BinaryExpr& node);
     // 访问一元表达式节点
-    void visit(UnaryExpr& node) override;
+    void visitUnaryExpr(UnaryExpr& node);
     // 访问函数调用表达式节点
-    void visit(CallExpr& node) override;
+    void visitCallExpr(CallExpr& node);
     // 访问数组索引表达式节点
-    void visit(IndexExpr& node) override;
+    void visitIndexExpr(IndexExpr& node);
     // 访问数字表达式节点
-    void visit(NumberExpr& node) override;
+    void visitNumberExpr(NumberExpr& node);
     // 访问变量表达式节点
-    void visit(VariableExpr& node) override;
+    void visitVariableExpr(VariableExpr& node);
     // 访问代码块节点
-    void visit(Block& node) override;
+    void visitBlock(Block& node);
     // 访问变量定义节点
-    void visit(VarDef& node) override;
+    void visitVarDef(VarDef& node);
     // 访问函数形参节点
-    void visit(FuncFParam& node) override;
+    void visitFuncFParam(FuncFParam& node);
     // 访问表达式语句节点
-    void visit(ExprStmt& node) override;
+    void visitExprStmt(ExprStmt& node);
     // 访问声明语句节点
-    void visit(DeclStmt& node) override;
+    void visitDeclStmt(DeclStmt& node);
 };
\ No newline at end of file
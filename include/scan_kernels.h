@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+
+// 扫描内核使用的指令集级别
+enum class ScanIsa {
+    SCALAR, // 逐字节扫描（所有平台可用）
+    SSE2,   // 每次处理16字节
+    AVX2    // 每次处理32字节
+};
+
+// 扫描过程中遇到的换行统计
+struct ScanLines {
+    size_t count = 0;       // 换行符个数
+    size_t lastNewline = 0; // 最后一个换行符相对扫描起点的偏移（count为0时无意义）
+};
+
+// ScanKernels - 词法分析器热点循环的批量扫描内核
+// 所有内核都从p开始、最多扫描n个字节，返回停止位置相对p的偏移；
+// 与逐字符扫描一样，遇到'\0'即视为源代码结束
+struct ScanKernels {
+    // 跳过空白字符（空格、\t、\n、\v、\f、\r），统计其中的换行
+    size_t (*skipWhitespace)(const char* p, size_t n, ScanLines& lines);
+    // 查找单行注释的结束位置：第一个'\n'或'\0'
+    size_t (*findLineEnd)(const char* p, size_t n);
+    // 查找多行注释的结束位置：返回"*/"之后的偏移，未闭合时返回'\0'或末尾的偏移，统计其中的换行
+    size_t (*findBlockCommentEnd)(const char* p, size_t n, ScanLines& lines);
+    // 计算标识符长度：连续的字母、数字和下划线
+    size_t (*scanIdentifier)(const char* p, size_t n);
+
+    // 获取指定指令集的内核，当前平台不支持时退化为可用的最高级别
+    static const ScanKernels& get(ScanIsa isa);
+    // 通过CPUID检测当前CPU支持的最高指令集级别（只检测一次）
+    static ScanIsa bestAvailable();
+    // 获取指令集级别的名称
+    static const char* isaName(ScanIsa isa);
+};
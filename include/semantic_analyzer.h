@@ -1,40 +1,94 @@
 #pragma once
-#include "ast.h"
+#include "ast_visitor.h"
+#include "const_eval.h"
+#include "diagnostics.h"
 #include "symbol_table.h"
+#include <climits>
 #include <string>
 #include <vector>
 
-class SemanticAnalyzer : public ASTVisitor {
+// 语义分析器
+// 分析编译单元分两个阶段：先顺序处理全局声明并登记全部函数签名，得到只读的全局符号表；
+// 再把函数体分给多个线程并行检查，每个线程在全局符号表上建立自己的局部作用域。
+// 各线程的诊断信息记录在各自的诊断引擎中，最后按函数顺序合并，结果与顺序分析完全一致：
+// 检查第i个函数体时，在它之后才定义的函数视为尚未声明
+class SemanticAnalyzer : public RecursiveASTVisitor<SemanticAnalyzer> {
+public:
+    // 每个线程至少检查的函数个数，函数较少时在当前线程顺序检查
+    static constexpr size_t MIN_FUNCTIONS_PER_THREAD = 256;
+
 private:
-    SymbolTable symbolTable;
-    std::string currentFunction;
+    SymbolTable symbolTable;   // 全局符号表；检查函数体时是以全局符号表为外层表的局部作用域
+    DiagnosticEngine diagnostics; // 记录的诊断信息
+    ConstEvaluator evaluator;  // 常量求值器（数组长度、常量的值）
+    unsigned threadCount;      // 最多使用的线程数
+    int functionLimit;         // 可见函数的最大序号，序号更大的函数尚未定义
+    Symbol currentFunction;
     Type currentReturnType;
-    
+
     bool isInLoop;
     bool hasReturnStmt;
-    
+
+    // 表达式工作栈中的一项
+    struct ExprWork {
+        Expr* expr;    // 待检查的表达式
+        bool expanded; // 子表达式是否已压栈
+    };
+
+    std::vector<ExprWork> exprWork; // 检查表达式时使用的工作栈（嵌套的表达式依次压在后面）
+
+    // 检查函数体的分析器，使用只读的全局符号表
+    explicit SemanticAnalyzer(const SymbolTable& globals);
+
+    // 查找符号，在当前函数之后才定义的函数视为未声明
+    const SymbolEntry* lookup(Symbol name) const;
+    // 第一阶段：检查函数签名并把函数登记到全局符号表，index为函数定义的序号
+    void declareFunction(FuncDef& node, int index);
+    // 第二阶段：检查形参和函数体
+    void checkFunctionBody(FuncDef& node);
+    // 用显式栈后序检查整个表达式，表达式的长度和嵌套深度都不消耗调用栈
+    void checkExpr(Expr& root);
+    // 以下检查在子表达式都处理完之后进行（函数名的检查在处理实参之前）
+    void checkBinaryExpr(BinaryExpr& node);
+    void checkUnaryExpr(UnaryExpr& node);
+    void checkCallee(CallExpr& node);
+    void checkCallArgs(CallExpr& node);
+    void checkIndexExpr(IndexExpr& node);
+    // 检查变量的初始化表达式
+    void checkInitializer(VarDef& node, Type varType);
+    // 计算数组各维的长度，写入dims
+    void evaluateDimensions(VarDef& node, std::vector<int>& dims);
+    // 检查常量的初始化表达式，把常量的值写入entry
+    void evaluateConstant(VarDef& node, SymbolEntry& entry);
+
 public:
-    SemanticAnalyzer() : isInLoop(false), hasReturnStmt(false) {}
-    
-    void visit(CompUnit& node) override;
-    void visit(FuncDef& node) override;
-    void visit(VarDecl& node) override;
-    void visit(IfStmt& node) override;
-    void visit(WhileStmt& node) override;
-    void visit(ReturnStmt& node) override;
-    void visit(BinaryExpr& node) override;
-    void visit(UnaryExpr& node) override;
-    void visit(CallExpr& node) override;
-    void visit(IndexExpr& node) override;
-    void visit(NumberExpr& node) override;
-    void visit(VariableExpr& node) override;
-    void visit(Block& node) override;
-    void visit(VarDef& node) override;
-    void visit(FuncFParam& node) override;
-    void visit(ExprStmt& node) override;
-    void visit(DeclStmt& node) override;
-    
+    // 参数：threadCount - 最多使用的线程数，0表示使用硬件线程数
+    explicit SemanticAnalyzer(unsigned threadCount = 0);
+
+    // 分析过程中记录的全部诊断信息
+    const DiagnosticEngine& getDiagnostics() const { return diagnostics; }
+
+    void visitCompUnit(CompUnit& node);
+    void visitFuncDef(FuncDef& node);
+    void visitVarDecl(VarDecl& node);
+    void visitIfStmt(IfStmt& node);
+    void visitWhileStmt(WhileStmt& node);
+    void visitBreakStmt(BreakStmt& node);
+    void visitContinueStmt(ContinueStmt& node);
+    void visitReturnStmt(ReturnStmt& node);
+    void visitBinaryExpr(BinaryExpr& node);
+    void visitUnaryExpr(UnaryExpr& node);
+    void visitCallExpr(CallExpr& node);
+    void visitIndexExpr(IndexExpr& node);
+    void visitNumberExpr(NumberExpr& node);
+    void visitVariableExpr(VariableExpr& node);
+    void visitBlock(Block& node);
+    void visitVarDef(VarDef& node);
+    void visitFuncFParam(FuncFParam& node);
+    void visitExprStmt(ExprStmt& node);
+    void visitDeclStmt(DeclStmt& node);
+
     void checkTypeCompatibility(Type t1, Type t2, const std::string& context);
-    void checkArrayDimensions(const std::vector<std::unique_ptr<Expr>>& indices, 
+    void checkArrayDimensions(const NodeList<Expr>& indices,
                              const std::vector<int>& dims);
-};
\ No newline at end of file
+};
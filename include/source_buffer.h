@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+// SourceBuffer类 - 只读的源代码缓冲区
+// 普通文件通过mmap直接映射到内存，词法分析器和Token直接引用其中的字节，不做任何复制；
+// 管道、标准输入或不支持mmap的平台则退化为read()读入内部字符串
+class SourceBuffer {
+private:
+    const char* data;     // 源代码首地址
+    size_t size;          // 源代码字节数
+    bool mapped;          // 是否为mmap映射
+    std::string storage;  // 退化模式下保存读入的内容
+
+    SourceBuffer() : data(nullptr), size(0), mapped(false) {}
+
+    // 从文件描述符读取全部内容（用于管道和标准输入）
+    bool readAll(int fd);
+
+public:
+    ~SourceBuffer();
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    // 打开源文件
+    // 参数：path - 文件路径，"-"表示标准输入
+    // 返回：打开成功返回缓冲区，失败返回nullptr
+    static std::unique_ptr<SourceBuffer> open(const std::string& path);
+
+    // 获取源代码内容，在缓冲区销毁前有效
+    std::string_view text() const { return std::string_view(data, size); }
+    // 判断是否为mmap映射
+    bool isMapped() const { return mapped; }
+};
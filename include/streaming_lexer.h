@@ -0,0 +1,49 @@
+#pragma once
+#include "token.h"
+#include "Lexer.h"
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// StreamingLexer类 - 分块流式词法分析器
+// 按固定大小的块读取输入，只在内存中保留当前块和上一块未消费的尾部，
+// 适合处理数百MB的机器生成源文件；跨块的Token、注释和空白会被正确拼接
+// 内存占用与输入大小无关，上限约为块大小加上最长的单个Token
+class StreamingLexer {
+public:
+    // 默认块大小
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+    
+private:
+    std::istream& input;        // 输入流
+    size_t blockSize;           // 每次读取的字节数
+    bool inputEnded;            // 输入是否已经读完
+    std::string buffer;         // 当前窗口：上一块未消费的尾部 + 新读入的块
+    std::optional<Lexer> lexer; // 在当前窗口上工作的词法分析器，窗口变化后重新创建
+    std::string errorMessage;   // 最近一个UNKNOWN Token的错误信息
+    
+    // 丢弃已消费的内容并读入下一块
+    // 参数：keep - 窗口中需要保留的起始位置
+    //       prefix - 拼接在保留内容之前的文本（用于延续跨块的注释）
+    //       line - 新窗口第一个字符的行号
+    void refill(size_t keep, const std::string& prefix, size_t line);
+    
+public:
+    // 构造函数
+    // 参数：input - 输入流，需以二进制方式打开
+    //       blockSize - 每次读取的字节数
+    StreamingLexer(std::istream& input, size_t blockSize = DEFAULT_BLOCK_SIZE);
+    
+    // 获取下一个Token，输出与对整个文件调用Lexer::getNextToken完全一致
+    // 返回：下一个Token，输入结束后总是返回END_OF_FILE
+    Token getNextToken();
+    
+    // 获取最近一个UNKNOWN Token的错误信息
+    const std::string& getErrorMessage() const { return errorMessage; }
+    
+    // 获取最近一个Token的原文，在下一次调用getNextToken前有效
+    std::string_view lexeme(const Token& token) const {
+        return std::string_view(buffer).substr(token.offset, token.length());
+    }
+};
@@ -1,9 +1,10 @@
 #pragma once
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <vector>
-#include <unordered_map>
-#include <variant>
 #include "ast.h"
+#include "interner.h"
 
 struct SymbolEntry {
 public:
@@ -22,27 +23,61 @@ public:
     // 函数相关字段
     int paramCount; // 参数数量
     std::vector<Type> paramTypes; // 参数类型列表
+    int funcIndex; // 函数定义在源代码中的序号，其他符号为-1
+    ASTNode* decl; // 声明符号的语法树节点：VarDef、FuncFParam或FuncDef
     
     // 默认构造函数
-    SymbolEntry() : kind(Kind::VARIABLE), type(Type::INT), isArray(false), valueType(ValueType::NONE), paramCount(0) {} 
+    SymbolEntry() : kind(Kind::VARIABLE), type(Type::INT), isArray(false), valueType(ValueType::NONE), paramCount(0), funcIndex(-1), decl(nullptr) {} 
     
     SymbolEntry(Kind kind, Type type, bool isArray = false)
-        : kind(kind), type(type), isArray(isArray), valueType(ValueType::NONE), paramCount(0) {}
+        : kind(kind), type(type), isArray(isArray), valueType(ValueType::NONE), paramCount(0), funcIndex(-1), decl(nullptr) {}
 };
 
+// 符号表以驻留后的Symbol编号为键，查找时只做整数哈希和整数比较
+// 所有作用域共用一张开放寻址的哈希表，每个名字只占一个槽位，槽位指向该名字最内层的条目，
+// 条目再链接到被它遮蔽的外层同名条目；因此查找与嵌套深度无关，为常数时间。
+// 条目按插入顺序存放在entries中，它同时是撤销日志：退出作用域时把本作用域的条目依次弹出，
+// 并把对应槽位恢复为被遮蔽的条目。条目存放在deque中，插入新条目不会使已返回的指针失效。
+// 可以指定一个只读的外层符号表（如全局符号表），本表找不到的名字再到外层表中查找；
+// 多个线程各自在同一个外层表上建立自己的局部作用域，外层表在此期间不能修改
 class SymbolTable {
 private:
-    std::vector<std::unordered_map<std::string, SymbolEntry>> scopes;
-    
+    static constexpr uint32_t NONE = UINT32_MAX; // 表示没有条目
+
+    // 符号表中的一个条目
+    struct Binding {
+        SymbolEntry entry; // 符号信息
+        Symbol name;       // 符号名
+        uint32_t shadowed; // 被遮蔽的外层同名条目在entries中的下标，没有时为NONE
+    };
+
+    // 哈希表槽位，key为0表示空槽位
+    // 名字的全部条目都被弹出后槽位保留，head置为NONE，因此不需要删除标记
+    struct Slot {
+        uint32_t key;  // 名字的Symbol编号加1
+        uint32_t head; // 最内层条目在entries中的下标
+    };
+
+    std::deque<Binding> entries;      // 全部有效条目，按插入顺序排列
+    std::vector<Slot> slots;          // 开放寻址哈希表，大小为2的幂
+    size_t usedSlots;                 // 已占用的槽位个数
+    std::vector<uint32_t> scopeMarks; // 每个作用域的第一个条目在entries中的下标
+    const SymbolTable* parent;        // 只读的外层符号表，没有时为nullptr
+
+    // 查找名字所在槽位的下标，不存在时返回应插入的空槽位
+    size_t findSlot(Symbol name) const;
+    // 槽位占用超过一半时扩容并重新插入
+    void grow();
+
 public:
-    SymbolTable() { enterScope(); } // 构造时进入全局作用域
+    explicit SymbolTable(const SymbolTable* parent = nullptr);
     
     void enterScope();
     void exitScope();
-    bool insert(const std::string& name, SymbolEntry entry);
-    SymbolEntry* lookup(const std::string& name);
-    SymbolEntry* lookupCurrentScope(const std::string& name);
+    bool insert(Symbol name, SymbolEntry entry);
+    const SymbolEntry* lookup(Symbol name) const;
+    const SymbolEntry* lookupCurrentScope(Symbol name) const;
     
-    bool isEmpty() const { return scopes.empty(); }
-    size_t getCurrentScopeLevel() const { return scopes.size() - 1; }
+    bool isEmpty() const { return scopeMarks.empty(); }
+    size_t getCurrentScopeLevel() const { return scopeMarks.size() - 1; }
 };
\ No newline at end of file
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <variant>
+#include "interner.h"
 
-// Token类型枚举 - 定义SysY语言中所有可能的词法单元类型
-enum class TokenType {
+// Token类型枚举 - 定义SysY语言中所有可能的词法单元类型（占1字节）
+enum class TokenType : uint8_t {
     // 关键字：SysY语言的保留字
     INT, FLOAT, CONST, VOID, IF, ELSE, WHILE, BREAK, CONTINUE, RETURN,
     
@@ -28,24 +32,48 @@ enum class TokenType {
     END_OF_FILE, UNKNOWN
 };
 
-// Token结构体 - 表示从源代码中解析出的单个词法单元
+// Token结构体 - 表示从源代码中解析出的单个词法单元，紧凑布局共16字节
+// 原文通过偏移和长度引用源代码；错误信息不放在Token中，而是保存在旁路表里，由errorIndex引用
 struct Token {
-public:  // 公共访问修饰符
-    TokenType type;          // Token的类型
-    enum class ValueType { INT_VAL, FLOAT_VAL, STRING_VAL } valueType; // 值的类型
+private:
+    uint32_t typeAndLength;  // 低8位为Token类型，高24位为原文长度
+    
+public:
+    static constexpr uint32_t MAX_LENGTH = (1u << 24) - 1; // 原文长度上限
+    
+    uint32_t offset;         // 原文在源代码中的字节偏移
+    int line;                // Token所在的行号（用于错误报告）
     union {
         int intValue;        // 整数值（用于整数常量）
         float floatValue;    // 浮点数值（用于浮点常量）
+        Symbol symbol;       // 驻留后的标识符编号（用于标识符）
+        uint32_t errorIndex; // 错误信息在旁路表中的下标（用于UNKNOWN）
     };
-    std::string stringValue; // 字符串值（用于标识符、关键字等）
-    std::string errorMessage; // 错误信息（当Token类型为UNKNOWN时使用）
-    int line;               // Token所在的行号（用于错误报告）
-    int column;             // Token所在的列号（用于错误报告）
+    
+    Token() : typeAndLength(0), offset(0), line(0), errorIndex(0) {}
+    
+    // 获取Token的类型
+    TokenType type() const { return static_cast<TokenType>(typeAndLength & 0xFFu); }
+    // 设置Token的类型
+    void setType(TokenType value) { typeAndLength = (typeAndLength & ~0xFFu) | static_cast<uint32_t>(value); }
+    // 获取原文长度
+    uint32_t length() const { return typeAndLength >> 8; }
+    // 设置原文长度（调用者保证不超过MAX_LENGTH）
+    void setLength(uint32_t value) { typeAndLength = (typeAndLength & 0xFFu) | (value << 8); }
+    
+    // 以原始位模式读取值（整数、浮点数、标识符编号或错误下标）
+    uint32_t rawValue() const {
+        uint32_t raw;
+        std::memcpy(&raw, &intValue, sizeof(raw));
+        return raw;
+    }
+    // 以原始位模式写入值
+    void setRawValue(uint32_t raw) { std::memcpy(&intValue, &raw, sizeof(raw)); }
     
     // 将Token转换为字符串表示
     // 用于调试和输出词法分析结果
     std::string toString() const {
-        switch (type) {
+        switch (type()) {
             // 关键字
             case TokenType::INT: return "INTTK int";
             case TokenType::FLOAT: return "FLOAT float";
@@ -64,7 +92,7 @@ public:  // 公共访问修饰符
             case TokenType::VOID_TYPE: return "VOID_TYPE void";
             
             // 标识符和常量
-            case TokenType::IDENT: return "ID " + stringValue;
+            case TokenType::IDENT: return "ID " + std::string(symbol.str());
             case TokenType::INT_CONST: return "INTCON " + std::to_string(intValue);
             case TokenType::FLOAT_CONST: return "FLOATCON " + std::to_string(floatValue);
             
@@ -104,4 +132,6 @@ public:  // 公共访问修饰符
             default: return "UNKNOWN";
         }
     }
-};
\ No newline at end of file
+};
+
+static_assert(sizeof(Token) == 16, "Token should stay 16 bytes");
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include "token.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// TokenStream类 - 物化的Token缓冲区，按字段分列存储（structure of arrays）
+// 语法分析器最频繁读取的是Token类型，按列存储后类型数组每个Token只占1字节，
+// 逐个判断类型时一条缓存行可以覆盖64个Token；其余字段只在需要时按下标读取
+// 原文通过偏移和长度引用源代码，调用者需保证源代码在TokenStream之前不被释放
+class TokenStream {
+private:
+    std::string_view source;          // 源代码（不复制）
+    std::vector<TokenType> types;     // Token类型
+    std::vector<int> lines;           // 行号
+    std::vector<uint32_t> offsets;    // 原文在源代码中的偏移
+    std::vector<uint32_t> lengths;    // 原文长度
+    std::vector<uint32_t> payloads;   // 值的原始位模式（整数、浮点数、标识符编号或错误下标）
+    std::vector<std::string> errors;  // 错误信息，UNKNOWN Token的payload是其中的下标
+
+public:
+    TokenStream() = default;
+    explicit TokenStream(std::string_view source) : source(source) {}
+
+    // 追加一个Token
+    // 参数：token - 要追加的Token
+    //       errorMessage - UNKNOWN Token的错误信息，其他Token忽略
+    void push(const Token& token, std::string_view errorMessage = {});
+
+    // 预留count个Token的空间
+    void reserve(size_t count);
+    
+    // 调整Token个数，新增的Token由copyRange填写（用于并行合并）
+    void resize(size_t count);
+    
+    // 把other的全部错误信息追加到本缓冲区
+    // 返回：第一条错误信息在本缓冲区错误表中的下标
+    uint32_t appendErrors(const TokenStream& other);
+    
+    // 把other中[begin, end)的Token复制到本缓冲区从dst开始的位置
+    // 参数：lineDelta - 行号的修正量
+    //       errorBase - other的错误信息在本缓冲区错误表中的起始下标（由appendErrors返回）
+    //       symbolMap - 标识符编号的映射表（other使用局部驻留表时），为nullptr时不映射
+    // 不同线程可以并发复制到互不重叠的区间
+    void copyRange(size_t dst, const TokenStream& other, size_t begin, size_t end,
+                   int lineDelta, uint32_t errorBase, const std::vector<uint32_t>* symbolMap);
+    
+    // 查找第一个原文偏移不小于offset的Token
+    // 返回：该Token的下标，不存在时返回size()
+    size_t lowerBound(uint32_t offset) const;
+
+    // Token个数
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+
+    // 按下标读取各个字段
+    TokenType type(size_t index) const { return types[index]; }
+    int line(size_t index) const { return lines[index]; }
+    uint32_t offset(size_t index) const { return offsets[index]; }
+    Symbol symbol(size_t index) const { return Symbol(payloads[index]); }
+    int intValue(size_t index) const { return static_cast<int>(payloads[index]); }
+    float floatValue(size_t index) const {
+        float value;
+        std::memcpy(&value, &payloads[index], sizeof(value));
+        return value;
+    }
+    // 获取Token所在的列号（从1开始，按字节计算），只用于报告错误
+    int column(size_t index) const;
+    // 获取Token在源代码中的原文
+    std::string_view lexeme(size_t index) const { return source.substr(offsets[index], lengths[index]); }
+    // 获取UNKNOWN Token的错误信息，其他Token返回空串
+    std::string_view errorMessage(size_t index) const;
+
+    // 把第index个Token重新组装为Token对象（用于输出等非热点路径）
+    Token at(size_t index) const;
+
+    // Token缓冲区中已用元素占用的字节数（不含预留空间和错误信息）
+    size_t memoryBytes() const {
+        return size() * (sizeof(TokenType) + sizeof(int) + 3 * sizeof(uint32_t));
+    }
+};
@@ -0,0 +1,46 @@
+#include "../include/arena.h"
+#include <algorithm>
+#include <cstdlib>
+
+// 构造函数
+// 第一个内存块在第一次分配时才申请；块从小到大增长，只分配少量对象的Arena（如IR中的小函数）不会占用整块内存
+Arena::Arena()
+    : blocks(nullptr), nextBlockSize(MIN_BLOCK_SIZE), cursor(nullptr), limit(nullptr), allocations(0), bytes(0), blockCount(0) {}
+
+// 析构函数
+// 按块释放全部内存，不调用其中对象的析构函数
+Arena::~Arena() {
+    while (blocks != nullptr) {
+        Block* next = blocks->next;
+        std::free(blocks);
+        blocks = next;
+    }
+}
+
+// 申请新块并在其中分配
+// 超过普通块大小的请求单独占用一个块，并且不替换当前块，以免浪费当前块的剩余空间
+void* Arena::allocateSlow(size_t size, size_t align) {
+    size_t dataSize = std::max(nextBlockSize, size + align);
+    Block* block = static_cast<Block*>(std::malloc(sizeof(Block) + dataSize));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    block->size = dataSize;
+    blockCount++;
+
+    char* data = reinterpret_cast<char*>(block + 1);
+    uintptr_t address = (reinterpret_cast<uintptr_t>(data) + align - 1) & ~(uintptr_t(align) - 1);
+
+    if (dataSize > nextBlockSize && blocks != nullptr) {
+        // 大对象块插在当前块之后，当前块继续使用
+        block->next = blocks->next;
+        blocks->next = block;
+    } else {
+        block->next = blocks;
+        blocks = block;
+        nextBlockSize = std::min(nextBlockSize * 2, BLOCK_SIZE);
+        limit = data + dataSize;
+        cursor = reinterpret_cast<char*>(address + size);
+    }
+    return reinterpret_cast<void*>(address);
+}
@@ -42,6 +42,18 @@ void WhileStmt::accept(ASTVisitor& visitor) {
     visitor.visit(*this);
 }
 
+// break语句节点的accept方法实现
+// 调用访问者的visit方法，实现访问者模式
+void BreakStmt::accept(ASTVisitor& visitor) {
+    visitor.visit(*this);
+}
+
+// continue语句节点的accept方法实现
+// 调用访问者的visit方法，实现访问者模式
+void ContinueStmt::accept(ASTVisitor& visitor) {
+    visitor.visit(*this);
+}
+
 // return语句节点的accept方法实现
 // 调用访问者的visit方法，实现访问者模式
 void ReturnStmt::accept(ASTVisitor& visitor) {
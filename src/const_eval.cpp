@@ -0,0 +1,349 @@
+#include "../include/const_eval.h"
+#include <climits>
+#include <cstdint>
+
+namespace {
+
+// 整数运算按32位补码回绕
+int wrap(uint32_t value) {
+    return static_cast<int>(value);
+}
+
+// 对两个常量做二元运算（不含&&、||和赋值），不是常量表达式时返回false
+bool evaluateBinary(TokenType op, const ConstValue& left, const ConstValue& right, ConstValue& result) {
+    if (left.type == Type::FLOAT || right.type == Type::FLOAT) {
+        float a = left.asFloat();
+        float b = right.asFloat();
+        switch (op) {
+            case TokenType::PLUS: result = ConstValue::ofFloat(a + b); return true;
+            case TokenType::MINUS: result = ConstValue::ofFloat(a - b); return true;
+            case TokenType::MUL: result = ConstValue::ofFloat(a * b); return true;
+            case TokenType::DIV:
+                if (b == 0.0f) {
+                    return false;
+                }
+                result = ConstValue::ofFloat(a / b);
+                return true;
+            case TokenType::EQ: result = ConstValue::ofInt(a == b); return true;
+            case TokenType::NE: result = ConstValue::ofInt(a != b); return true;
+            case TokenType::LT: result = ConstValue::ofInt(a < b); return true;
+            case TokenType::GT: result = ConstValue::ofInt(a > b); return true;
+            case TokenType::LE: result = ConstValue::ofInt(a <= b); return true;
+            case TokenType::GE: result = ConstValue::ofInt(a >= b); return true;
+            default: return false; // float取模
+        }
+    }
+
+    int a = left.intValue;
+    int b = right.intValue;
+    uint32_t ua = static_cast<uint32_t>(a);
+    uint32_t ub = static_cast<uint32_t>(b);
+    switch (op) {
+        case TokenType::PLUS: result = ConstValue::ofInt(wrap(ua + ub)); return true;
+        case TokenType::MINUS: result = ConstValue::ofInt(wrap(ua - ub)); return true;
+        case TokenType::MUL: result = ConstValue::ofInt(wrap(ua * ub)); return true;
+        case TokenType::DIV:
+        case TokenType::MOD:
+            // 除数为0和INT_MIN / -1在运行时出错，不能在编译期求值
+            if (b == 0 || (a == INT_MIN && b == -1)) {
+                return false;
+            }
+            result = ConstValue::ofInt(op == TokenType::DIV ? a / b : a % b);
+            return true;
+        case TokenType::EQ: result = ConstValue::ofInt(a == b); return true;
+        case TokenType::NE: result = ConstValue::ofInt(a != b); return true;
+        case TokenType::LT: result = ConstValue::ofInt(a < b); return true;
+        case TokenType::GT: result = ConstValue::ofInt(a > b); return true;
+        case TokenType::LE: result = ConstValue::ofInt(a <= b); return true;
+        case TokenType::GE: result = ConstValue::ofInt(a >= b); return true;
+        default: return false;
+    }
+}
+
+// 对常量做一元运算
+ConstValue evaluateUnary(TokenType op, const ConstValue& operand) {
+    switch (op) {
+        case TokenType::MINUS:
+            if (operand.type == Type::FLOAT) {
+                return ConstValue::ofFloat(-operand.floatValue);
+            }
+            return ConstValue::ofInt(wrap(0u - static_cast<uint32_t>(operand.intValue)));
+        case TokenType::NOT:
+            return ConstValue::ofInt(!operand.isTrue());
+        default:
+            return operand; // 一元加
+    }
+}
+
+} // namespace
+
+// 把常量转换为指定类型
+bool ConstEvaluator::convert(ConstValue& value, Type type) {
+    if (type == value.type) {
+        return true;
+    }
+    if (type == Type::FLOAT) {
+        value = ConstValue::ofFloat(static_cast<float>(value.intValue));
+        return true;
+    }
+    if (type == Type::INT) {
+        float f = value.floatValue;
+        // 取反的比较同时排除NaN
+        if (!(f >= -2147483648.0f && f < 2147483648.0f)) {
+            return false;
+        }
+        value = ConstValue::ofInt(static_cast<int>(f));
+        return true;
+    }
+    return false;
+}
+
+// 生成与结果值相同的数字常量，表达式本身已是数字常量时不变
+Expr* ConstEvaluator::replacement(Expr* expr, const Result& result, Arena& arena) {
+    if (isa<NumberExpr>(expr)) {
+        return expr;
+    }
+    foldCount++;
+    if (result.value.type == Type::FLOAT) {
+        return arena.make<NumberExpr>(result.value.floatValue, expr->getLine());
+    }
+    return arena.make<NumberExpr>(result.value.intValue, expr->getLine());
+}
+
+// 生成表达式的结果
+// 子表达式的结果按源代码顺序在results末尾，全部取走；arena不为nullptr时，
+// 本表达式不是常量而子表达式是常量的，把子表达式替换为数字常量
+ConstEvaluator::Result ConstEvaluator::combine(Expr* expr, Arena* arena) {
+    switch (expr->getKind()) {
+        case NodeKind::VARIABLE_EXPR: {
+            // const变量的初始化表达式已经求值
+            Result result = results.back();
+            results.pop_back();
+            VarDef* varDef = cast<VarDef>(cast<VariableExpr>(expr)->getDecl());
+            if (result.constant && !convert(result.value, varDef->getDecl()->getType())) {
+                result.constant = false;
+            }
+            constants[varDef] = result;
+            return result;
+        }
+        case NodeKind::UNARY_EXPR: {
+            Result operand = results.back();
+            results.pop_back();
+            if (!operand.constant) {
+                return Result{false, ConstValue()};
+            }
+            return Result{true, evaluateUnary(cast<UnaryExpr>(expr)->getOp(), operand.value)};
+        }
+        case NodeKind::BINARY_EXPR: {
+            BinaryExpr* binary = cast<BinaryExpr>(expr);
+            Result right = results.back();
+            results.pop_back();
+            Result left = results.back();
+            results.pop_back();
+
+            Result result{false, ConstValue()};
+            TokenType op = binary->getOp();
+            if (op == TokenType::AND || op == TokenType::OR) {
+                // 左操作数已经决定结果时短路
+                bool shortCircuit = op == TokenType::OR;
+                if (left.constant && left.value.isTrue() == shortCircuit) {
+                    result = Result{true, ConstValue::ofInt(shortCircuit)};
+                } else if (left.constant && right.constant) {
+                    result = Result{true, ConstValue::ofInt(right.value.isTrue())};
+                }
+            } else if (op != TokenType::ASSIGN && left.constant && right.constant) {
+                result.constant = evaluateBinary(op, left.value, right.value, result.value);
+            }
+
+            if (arena != nullptr && !result.constant) {
+                if (left.constant && op != TokenType::ASSIGN) {
+                    binary->setLeft(replacement(binary->getLeft(), left, *arena));
+                }
+                if (right.constant) {
+                    binary->setRight(replacement(binary->getRight(), right, *arena));
+                }
+            }
+            return result;
+        }
+        case NodeKind::CALL_EXPR: {
+            CallExpr* call = cast<CallExpr>(expr);
+            const NodeList<Expr>& callArgs = call->getArgs();
+            size_t base = results.size() - callArgs.size();
+            if (arena != nullptr) {
+                // 实参列表不可修改，有实参被替换时生成新的列表
+                bool changed = false;
+                args.clear();
+                for (size_t i = 0; i < callArgs.size(); i++) {
+                    Expr* arg = callArgs[i];
+                    if (results[base + i].constant) {
+                        arg = replacement(arg, results[base + i], *arena);
+                    }
+                    changed |= arg != callArgs[i];
+                    args.push_back(arg);
+                }
+                if (changed) {
+                    call->setArgs(arena->copyList(args.data(), args.size()));
+                }
+            }
+            results.resize(base);
+            return Result{false, ConstValue()};
+        }
+        case NodeKind::INDEX_EXPR: {
+            IndexExpr* index = cast<IndexExpr>(expr);
+            Result indexResult = results.back();
+            results.pop_back();
+            results.pop_back(); // 数组表达式
+            if (arena != nullptr && indexResult.constant) {
+                index->setIndex(replacement(index->getIndex(), indexResult, *arena));
+            }
+            return Result{false, ConstValue()};
+        }
+        default:
+            return Result{false, ConstValue()};
+    }
+}
+
+// 求值
+// 显式栈上的后序遍历：内部表达式第一次出栈时把自己和子表达式压栈，子表达式都求值后再次出栈时生成结果。
+// 引用尚未求值的const变量时，先把变量记为非常量（防止自引用造成循环），
+// 再在栈上对它的初始化表达式求值；求值期间nested大于0，不修改其他语句中的表达式
+ConstEvaluator::Result ConstEvaluator::run(Expr* expr, Arena* arena) {
+    size_t nested = 0;
+    work.push_back(WorkItem{expr, false});
+    while (!work.empty()) {
+        WorkItem item = work.back();
+        work.pop_back();
+        Expr* current = item.expr;
+        if (item.expanded) {
+            if (current->getKind() == NodeKind::VARIABLE_EXPR) {
+                nested--;
+            }
+            results.push_back(combine(current, nested == 0 ? arena : nullptr));
+            continue;
+        }
+
+        switch (current->getKind()) {
+            case NodeKind::INT_LITERAL:
+                results.push_back(Result{true, ConstValue::ofInt(cast<NumberExpr>(current)->getIntValue())});
+                continue;
+            case NodeKind::FLOAT_LITERAL:
+                results.push_back(Result{true, ConstValue::ofFloat(cast<NumberExpr>(current)->getFloatValue())});
+                continue;
+            case NodeKind::VARIABLE_EXPR: {
+                VarDef* varDef = dyn_cast<VarDef>(cast<VariableExpr>(current)->getDecl());
+                if (varDef == nullptr || !varDef->getDecl()->getIsConst() || varDef->getIsArray() ||
+                    varDef->getInitExpr() == nullptr) {
+                    results.push_back(Result{false, ConstValue()});
+                    continue;
+                }
+                auto found = constants.find(varDef);
+                if (found != constants.end()) {
+                    results.push_back(found->second);
+                    continue;
+                }
+                constants.emplace(varDef, Result{false, ConstValue()});
+                nested++;
+                work.push_back(WorkItem{current, true});
+                work.push_back(WorkItem{varDef->getInitExpr(), false});
+                continue;
+            }
+            case NodeKind::UNARY_EXPR:
+                work.push_back(WorkItem{current, true});
+                work.push_back(WorkItem{cast<UnaryExpr>(current)->getOperand(), false});
+                continue;
+            case NodeKind::BINARY_EXPR: {
+                BinaryExpr* binary = cast<BinaryExpr>(current);
+                work.push_back(WorkItem{current, true});
+                work.push_back(WorkItem{binary->getRight(), false});
+                work.push_back(WorkItem{binary->getLeft(), false});
+                continue;
+            }
+            case NodeKind::CALL_EXPR: {
+                const NodeList<Expr>& callArgs = cast<CallExpr>(current)->getArgs();
+                work.push_back(WorkItem{current, true});
+                for (size_t i = callArgs.size(); i > 0; i--) {
+                    work.push_back(WorkItem{callArgs[i - 1], false});
+                }
+                continue;
+            }
+            case NodeKind::INDEX_EXPR: {
+                IndexExpr* index = cast<IndexExpr>(current);
+                work.push_back(WorkItem{current, true});
+                work.push_back(WorkItem{index->getIndex(), false});
+                work.push_back(WorkItem{index->getBase(), false});
+                continue;
+            }
+            default:
+                results.push_back(Result{false, ConstValue()});
+                continue;
+        }
+    }
+    Result result = results.back();
+    results.pop_back();
+    return result;
+}
+
+// 对表达式求值
+bool ConstEvaluator::evaluate(Expr* expr, ConstValue& value) {
+    Result result = run(expr, nullptr);
+    if (result.constant) {
+        value = result.value;
+    }
+    return result.constant;
+}
+
+// 常量折叠
+Expr* ConstEvaluator::fold(Expr* expr, Arena& arena) {
+    Result result = run(expr, &arena);
+    return result.constant ? replacement(expr, result, arena) : expr;
+}
+
+// 折叠变量定义的各维长度和初始化表达式
+// 各维长度的列表不可修改，有长度被替换时生成新的列表
+void ConstantFolder::visitVarDef(VarDef& node) {
+    const NodeList<Expr>& oldDims = node.getDims();
+    bool changed = false;
+    dims.clear();
+    for (Expr* dim : oldDims) {
+        Expr* folded = dim != nullptr ? evaluator.fold(dim, arena) : nullptr;
+        changed |= folded != dim;
+        dims.push_back(folded);
+    }
+    if (changed) {
+        node.setDims(arena.copyList(dims.data(), dims.size()));
+    }
+    if (node.getInitExpr()) {
+        node.setInitExpr(evaluator.fold(node.getInitExpr(), arena));
+    }
+}
+
+// 折叠if语句的条件
+void ConstantFolder::visitIfStmt(IfStmt& node) {
+    if (node.getCondition()) {
+        node.setCondition(evaluator.fold(node.getCondition(), arena));
+    }
+    dispatch(node.getThenStmt());
+    dispatch(node.getElseStmt());
+}
+
+// 折叠while语句的条件
+void ConstantFolder::visitWhileStmt(WhileStmt& node) {
+    if (node.getCondition()) {
+        node.setCondition(evaluator.fold(node.getCondition(), arena));
+    }
+    dispatch(node.getBody());
+}
+
+// 折叠返回值
+void ConstantFolder::visitReturnStmt(ReturnStmt& node) {
+    if (node.getExpr()) {
+        node.setExpr(evaluator.fold(node.getExpr(), arena));
+    }
+}
+
+// 折叠表达式语句
+void ConstantFolder::visitExprStmt(ExprStmt& node) {
+    if (node.getExpr()) {
+        node.setExpr(evaluator.fold(node.getExpr(), arena));
+    }
+}
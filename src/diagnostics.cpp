@@ -0,0 +1,216 @@
+#include "../include/diagnostics.h"
+#include <algorithm>
+#include <charconv>
+#include <numeric>
+
+// 构造函数
+DiagnosticEngine::DiagnosticEngine() : seen(16, EMPTY), usedSlots(0), errors(0), messageStart(0) {}
+
+// 诊断信息的哈希值
+size_t DiagnosticEngine::hashOf(const Diagnostic& entry) const {
+    size_t hash = std::hash<std::string_view>()(message(entry));
+    hash ^= (static_cast<size_t>(entry.kind) << 8 | entry.errorType) * 0x9E3779B97F4A7C15ull;
+    hash ^= static_cast<size_t>(static_cast<uint32_t>(entry.line)) * 0xC2B2AE3D27D4EB4Full;
+    hash ^= static_cast<size_t>(static_cast<uint32_t>(entry.column)) * 0x165667B19E3779F9ull;
+    return hash ^ (hash >> 29);
+}
+
+// 判断两条诊断信息是否完全相同
+bool DiagnosticEngine::sameAs(const Diagnostic& left, const Diagnostic& right) const {
+    return left.kind == right.kind && left.errorType == right.errorType && left.line == right.line &&
+           left.column == right.column && message(left) == message(right);
+}
+
+// 扩容
+// 重新插入全部诊断信息，REMOVED位置随之消失
+void DiagnosticEngine::growSeen() {
+    size_t size = seen.size();
+    while (entries.size() * 2 >= size) {
+        size *= 2;
+    }
+    seen.assign(size, EMPTY);
+    size_t mask = size - 1;
+    for (uint32_t index = 0; index < entries.size(); index++) {
+        size_t slot = hashOf(entries[index]) & mask;
+        while (seen[slot] != EMPTY) {
+            slot = (slot + 1) & mask;
+        }
+        seen[slot] = index;
+    }
+    usedSlots = entries.size();
+}
+
+// 在缓冲区末尾追加整数
+static void appendNumber(std::string& buffer, long long value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+// 拼接整数
+void DiagnosticEngine::append(long long value) {
+    appendNumber(text, value);
+}
+
+// 记录一条诊断信息
+// 在去重表中线性探测：遇到完全相同的诊断信息时丢弃刚拼接的说明文字，遇到空位时记录
+void DiagnosticEngine::commit(DiagKind kind, uint8_t errorType, int line, int column) {
+    uint32_t length = static_cast<uint32_t>(text.size()) - messageStart;
+    Diagnostic entry{kind, errorType, line, column, messageStart, length};
+    if ((usedSlots + 1) * 2 > seen.size()) {
+        growSeen();
+    }
+    size_t mask = seen.size() - 1;
+    size_t slot = hashOf(entry) & mask;
+    while (seen[slot] != EMPTY) {
+        if (seen[slot] != REMOVED && sameAs(entries[seen[slot]], entry)) {
+            text.resize(messageStart); // 重复
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    seen[slot] = static_cast<uint32_t>(entries.size());
+    usedSlots++;
+    entries.push_back(entry);
+    if (kind != DiagKind::WARNING) {
+        errors++;
+    }
+}
+
+// 合并其他引擎的诊断信息
+void DiagnosticEngine::merge(const DiagnosticEngine& other, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const Diagnostic& entry = other.entries[i];
+        messageStart = static_cast<uint32_t>(text.size());
+        text.append(other.message(entry));
+        commit(entry.kind, entry.errorType, entry.line, entry.column);
+    }
+}
+
+// 撤销count之后的诊断信息
+// 去重表中对应的位置标记为REMOVED，不打断其他诊断信息的探测序列；
+// 说明文字按报告顺序存放在文字池中，截断到第count条的起始位置即可
+void DiagnosticEngine::truncate(size_t count) {
+    if (count >= entries.size()) {
+        return;
+    }
+    size_t mask = seen.size() - 1;
+    for (size_t index = count; index < entries.size(); index++) {
+        size_t slot = hashOf(entries[index]) & mask;
+        while (seen[slot] != index) {
+            slot = (slot + 1) & mask;
+        }
+        seen[slot] = REMOVED;
+        if (entries[index].kind != DiagKind::WARNING) {
+            errors--;
+        }
+    }
+    text.resize(entries[count].messageOffset);
+    entries.resize(count);
+}
+
+// 在JSON字符串中转义说明文字
+static void appendJsonString(std::string& buffer, std::string_view value) {
+    static const char HEX[] = "0123456789abcdef";
+    buffer.push_back('"');
+    for (char c : value) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            buffer.push_back('\\');
+            buffer.push_back(c);
+        } else if (byte < 0x20) {
+            buffer.append("\\u00");
+            buffer.push_back(HEX[byte >> 4]);
+            buffer.push_back(HEX[byte & 0x0F]);
+        } else {
+            buffer.push_back(c);
+        }
+    }
+    buffer.push_back('"');
+}
+
+// 错误类型的文字：词法错误为A，语法错误为B，语义错误为类型编号
+static void appendErrorType(std::string& buffer, const Diagnostic& entry) {
+    switch (entry.kind) {
+        case DiagKind::LEXICAL: buffer.push_back('A'); break;
+        case DiagKind::SYNTAX: buffer.push_back('B'); break;
+        default: appendNumber(buffer, entry.errorType); break;
+    }
+}
+
+// 输出全部诊断信息
+// 文本格式与实验要求一致："Error type N at line L : 说明"，警告为"Warning: 说明"；
+// JSON格式为一个数组，每行一个对象，未知的列号和警告的类型为null
+void DiagnosticEngine::render(std::ostream& out, DiagFormat format) const {
+    std::vector<uint32_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t left, uint32_t right) {
+        const Diagnostic& a = entries[left];
+        const Diagnostic& b = entries[right];
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+
+    std::string buffer;
+    buffer.reserve(text.size() + entries.size() * (format == DiagFormat::JSON ? 96 : 32));
+    if (format == DiagFormat::JSON) {
+        buffer.append("[");
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        const Diagnostic& entry = entries[order[i]];
+        if (format == DiagFormat::TEXT) {
+            if (entry.kind == DiagKind::WARNING) {
+                buffer.append("Warning: ");
+            } else {
+                buffer.append("Error type ");
+                appendErrorType(buffer, entry);
+                buffer.append(" at line ");
+                appendNumber(buffer, entry.line);
+                buffer.append(" : ");
+            }
+            buffer.append(message(entry));
+            buffer.push_back('\n');
+            continue;
+        }
+
+        static const char* const KIND_NAMES[] = {"lexical", "syntax", "semantic", "warning"};
+        buffer.append(i == 0 ? "\n" : ",\n");
+        buffer.append("  {\"severity\": ");
+        buffer.append(entry.kind == DiagKind::WARNING ? "\"warning\"" : "\"error\"");
+        buffer.append(", \"kind\": \"");
+        buffer.append(KIND_NAMES[static_cast<size_t>(entry.kind)]);
+        buffer.append("\", \"type\": ");
+        if (entry.kind == DiagKind::WARNING) {
+            buffer.append("null");
+        } else {
+            buffer.push_back('"');
+            appendErrorType(buffer, entry);
+            buffer.push_back('"');
+        }
+        buffer.append(", \"line\": ");
+        appendNumber(buffer, entry.line);
+        buffer.append(", \"column\": ");
+        if (entry.column > 0) {
+            appendNumber(buffer, entry.column);
+        } else {
+            buffer.append("null");
+        }
+        buffer.append(", \"message\": ");
+        appendJsonString(buffer, message(entry));
+        buffer.push_back('}');
+    }
+    if (format == DiagFormat::JSON) {
+        buffer.append(order.empty() ? "]\n" : "\n]\n");
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+}
+
+// 清空全部诊断信息
+void DiagnosticEngine::clear() {
+    seen.assign(16, EMPTY);
+    usedSlots = 0;
+    entries.clear();
+    text.clear();
+    errors = 0;
+    messageStart = 0;
+}
@@ -0,0 +1,276 @@
+#include "../include/dominators.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// 控制流图的后继，按基本块编号存为CSR数组
+void collectSuccessors(Function& function, std::vector<uint32_t>& offsets, std::vector<uint32_t>& targets,
+                       std::vector<BasicBlock*>& nodeBlocks) {
+    function.renumberBlocks();
+    size_t blockCount = function.getBlockCount();
+    offsets.assign(blockCount + 1, 0);
+    nodeBlocks.resize(blockCount);
+    targets.clear();
+    for (BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        nodeBlocks[block->getIndex()] = block;
+        for (uint32_t i = 0; i < block->getSuccessorCount(); i++) {
+            targets.push_back(block->getSuccessor(i)->getIndex());
+        }
+        offsets[block->getIndex() + 1] = static_cast<uint32_t>(targets.size());
+    }
+}
+
+} // namespace
+
+// 计算支配树
+void DominatorTreeBase::build(uint32_t nodeCount, uint32_t root, const std::vector<uint32_t>& offsets,
+                              const std::vector<uint32_t>& targets, const std::vector<BasicBlock*>& nodeBlocks) {
+    // 从根出发做深度优先遍历，得到先序、深度优先树中的父结点和后序；rpoIndex暂时记录结点的先序编号
+    rpoIndex.assign(nodeCount, UNDEFINED);
+    std::vector<uint32_t> postorder;
+    postorder.reserve(nodeCount);
+    std::vector<uint32_t> parents; // 先序编号到父结点的先序编号
+    parents.reserve(nodeCount);
+    std::vector<std::pair<uint32_t, uint32_t>> stack; // 结点和下一条待访问的出边
+    rpoIndex[root] = 0;
+    parents.push_back(0);
+    stack.push_back({root, offsets[root]});
+    while (!stack.empty()) {
+        uint32_t node = stack.back().first;
+        uint32_t edge = stack.back().second;
+        if (edge < offsets[node + 1]) {
+            stack.back().second++;
+            uint32_t target = targets[edge];
+            if (rpoIndex[target] == UNDEFINED) {
+                rpoIndex[target] = static_cast<uint32_t>(parents.size());
+                parents.push_back(rpoIndex[node]);
+                stack.push_back({target, offsets[target]});
+            }
+            continue;
+        }
+        postorder.push_back(node);
+        stack.pop_back();
+    }
+
+    // 逆后序编号，同时记录先序编号与逆后序编号的对应
+    uint32_t count = static_cast<uint32_t>(postorder.size());
+    rpoBlocks.resize(count);
+    std::vector<uint32_t> preToRpo(count);
+    std::vector<uint32_t> rpoToPre(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t node = postorder[count - 1 - i];
+        preToRpo[rpoIndex[node]] = i;
+        rpoToPre[i] = rpoIndex[node];
+        rpoIndex[node] = i;
+        rpoBlocks[i] = nodeBlocks[node];
+    }
+
+    // 以逆后序编号表示的前驱（只含可达结点）
+    predOffsets.assign(count + 1, 0);
+    for (uint32_t node = 0; node < nodeCount; node++) {
+        if (rpoIndex[node] == UNDEFINED) {
+            continue;
+        }
+        for (uint32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+            predOffsets[rpoIndex[targets[edge]] + 1]++;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        predOffsets[i + 1] += predOffsets[i];
+    }
+    preds.resize(predOffsets[count]);
+    std::vector<uint32_t> cursor(predOffsets.begin(), predOffsets.end() - 1);
+    for (uint32_t node = 0; node < nodeCount; node++) {
+        if (rpoIndex[node] == UNDEFINED) {
+            continue;
+        }
+        for (uint32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+            preds[cursor[rpoIndex[targets[edge]]]++] = rpoIndex[node];
+        }
+    }
+
+    // SEMI-NCA，以下都用先序编号表示结点
+    // 第一步按先序编号从大到小求半支配者：前驱编号更小时就是前驱本身，否则是前驱在已处理的深度优先树森林中
+    // 到树根的路径上半支配者最小的结点的半支配者；查找时做路径压缩（ancestor指向森林中的祖先，label为路径上的最小者）
+    std::vector<uint32_t> semi(count);
+    std::vector<uint32_t> label(count);
+    std::vector<uint32_t> ancestor(count, UNDEFINED);
+    std::vector<uint32_t> path;
+    for (uint32_t v = 0; v < count; v++) {
+        semi[v] = v;
+        label[v] = v;
+    }
+    for (uint32_t v = count; v-- > 1;) {
+        uint32_t block = preToRpo[v];
+        for (uint32_t i = predOffsets[block]; i < predOffsets[block + 1]; i++) {
+            uint32_t pred = rpoToPre[preds[i]];
+            if (ancestor[pred] != UNDEFINED) {
+                // 压缩pred到森林树根之间的路径：自上而下把祖先的label和ancestor合并下来
+                path.clear();
+                for (uint32_t node = pred; ancestor[ancestor[node]] != UNDEFINED; node = ancestor[node]) {
+                    path.push_back(node);
+                }
+                for (size_t k = path.size(); k-- > 0;) {
+                    uint32_t node = path[k];
+                    uint32_t parent = ancestor[node];
+                    if (semi[label[parent]] < semi[label[node]]) {
+                        label[node] = label[parent];
+                    }
+                    ancestor[node] = ancestor[parent];
+                }
+            }
+            semi[v] = std::min(semi[v], semi[label[pred]]);
+        }
+        ancestor[v] = parents[v];
+    }
+
+    // 第二步按先序编号从小到大求直接支配者：从父结点沿已求出的支配者链向上，第一个编号不大于半支配者的结点
+    // 就是直接支配者（半支配者与父结点在支配树中的最近公共祖先）
+    std::vector<uint32_t> preIdoms(count, 0);
+    for (uint32_t v = 1; v < count; v++) {
+        uint32_t idom = parents[v];
+        while (idom > semi[v]) {
+            idom = preIdoms[idom];
+        }
+        preIdoms[v] = idom;
+    }
+    idoms.assign(count, 0);
+    for (uint32_t v = 1; v < count; v++) {
+        idoms[preToRpo[v]] = preToRpo[preIdoms[v]];
+    }
+
+    // 支配树的子结点，按逆后序排列
+    childOffsets.assign(count + 1, 0);
+    for (uint32_t block = 1; block < count; block++) {
+        childOffsets[idoms[block] + 1]++;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        childOffsets[i + 1] += childOffsets[i];
+    }
+    children.resize(count > 0 ? count - 1 : 0);
+    cursor.assign(childOffsets.begin(), childOffsets.end() - 1);
+    std::vector<uint32_t> childIndices(children.size());
+    for (uint32_t block = 1; block < count; block++) {
+        uint32_t position = cursor[idoms[block]]++;
+        children[position] = rpoBlocks[block];
+        childIndices[position] = block;
+    }
+
+    // 支配树的深度优先遍历：记录进入序号和子树中最大的进入序号
+    dfsIn.assign(count, 0);
+    dfsOut.assign(count, 0);
+    if (count == 0) {
+        return;
+    }
+    uint32_t counter = 0;
+    stack.clear();
+    dfsIn[0] = counter++;
+    stack.push_back({0, childOffsets[0]});
+    while (!stack.empty()) {
+        uint32_t block = stack.back().first;
+        uint32_t position = stack.back().second;
+        if (position < childOffsets[block + 1]) {
+            stack.back().second++;
+            uint32_t child = childIndices[position];
+            dfsIn[child] = counter++;
+            stack.push_back({child, childOffsets[child]});
+            continue;
+        }
+        dfsOut[block] = counter - 1;
+        stack.pop_back();
+    }
+}
+
+// 以入口块为根的支配树
+DominatorTree::DominatorTree(Function& function) {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<BasicBlock*> nodeBlocks;
+    collectSuccessors(function, offsets, targets, nodeBlocks);
+    if (function.getEntry() != nullptr) {
+        build(static_cast<uint32_t>(nodeBlocks.size()), 0, offsets, targets, nodeBlocks);
+    }
+}
+
+// 后支配树：把控制流图的边反向，再增加编号为blockCount的虚拟出口，它的后继是全部没有后继的基本块（返回块）
+PostDominatorTree::PostDominatorTree(Function& function) {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<BasicBlock*> nodeBlocks;
+    collectSuccessors(function, offsets, targets, nodeBlocks);
+    uint32_t blockCount = static_cast<uint32_t>(nodeBlocks.size());
+    uint32_t exit = blockCount;
+
+    std::vector<uint32_t> reverseOffsets(blockCount + 2, 0);
+    for (uint32_t edge = 0; edge < targets.size(); edge++) {
+        reverseOffsets[targets[edge] + 1]++;
+    }
+    for (uint32_t block = 0; block < blockCount; block++) {
+        if (offsets[block] == offsets[block + 1]) {
+            reverseOffsets[exit + 1]++;
+        }
+    }
+    for (uint32_t i = 0; i <= blockCount; i++) {
+        reverseOffsets[i + 1] += reverseOffsets[i];
+    }
+    std::vector<uint32_t> reverseTargets(reverseOffsets[blockCount + 1]);
+    std::vector<uint32_t> cursor(reverseOffsets.begin(), reverseOffsets.end() - 1);
+    for (uint32_t block = 0; block < blockCount; block++) {
+        for (uint32_t edge = offsets[block]; edge < offsets[block + 1]; edge++) {
+            reverseTargets[cursor[targets[edge]]++] = block;
+        }
+        if (offsets[block] == offsets[block + 1]) {
+            reverseTargets[cursor[exit]++] = block;
+        }
+    }
+    nodeBlocks.push_back(nullptr);
+    build(blockCount + 1, exit, reverseOffsets, reverseTargets, nodeBlocks);
+}
+
+// 计算支配边界：先统计每个结点的边界大小，再填入，两遍走相同的路径
+// mark记录结点的边界最近加入的汇合点：同一个汇合点的前驱走到已标记的结点时，
+// 从它到直接支配者的一段已经由前面的前驱走过，直接停下，每个结点对每个汇合点只经过一次
+DominanceFrontier::DominanceFrontier(const DominatorTreeBase& tree) : tree(tree) {
+    uint32_t count = static_cast<uint32_t>(tree.rpoBlocks.size());
+    const uint32_t UNDEFINED = DominatorTreeBase::UNDEFINED;
+    offsets.assign(count + 1, 0);
+    std::vector<uint32_t> mark(count, UNDEFINED);
+    std::vector<uint32_t> cursor;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            for (uint32_t i = 0; i < count; i++) {
+                offsets[i + 1] += offsets[i];
+            }
+            frontier.resize(offsets[count]);
+            cursor.assign(offsets.begin(), offsets.end() - 1);
+            mark.assign(count, UNDEFINED);
+        }
+        for (uint32_t join = 0; join < count; join++) {
+            uint32_t first = tree.predOffsets[join];
+            uint32_t last = tree.predOffsets[join + 1];
+            // 只有一个前驱的非根结点，前驱就是它的直接支配者，不必处理；根的前驱都来自回边
+            if (last - first < 2 && join != 0) {
+                continue;
+            }
+            // 根没有直接支配者，前驱一直走到根（包括根）为止
+            uint32_t stop = join == 0 ? UNDEFINED : tree.idoms[join];
+            for (uint32_t i = first; i < last; i++) {
+                uint32_t runner = tree.preds[i];
+                while (runner != stop && mark[runner] != join) {
+                    mark[runner] = join;
+                    if (pass == 0) {
+                        offsets[runner + 1]++;
+                    } else {
+                        frontier[cursor[runner]++] = tree.rpoBlocks[join];
+                    }
+                    if (runner == 0) {
+                        break;
+                    }
+                    runner = tree.idoms[runner];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,510 @@
+#include "../include/flat_ast.h"
+#include <sstream>
+
+// FlatAstBuilder类 - 把指针形式的语法树转换为扁平编码
+// 用显式栈代替递归做后序遍历：内部节点被访问两次，第一次（展开）把自己和子节点压入工作栈，
+// 第二次（生成）时子节点都已生成，从结果栈中取出它们的下标，再生成自己；叶子节点在展开时直接生成
+class FlatAstBuilder : public ASTVisitor {
+private:
+    // 工作栈中的一项
+    struct WorkItem {
+        ASTNode* node; // 待处理的节点
+        bool expanded; // 子节点是否已压栈
+    };
+
+    FlatAst& ast;                    // 正在生成的扁平编码
+    std::vector<WorkItem> work;      // 工作栈
+    std::vector<NodeIndex> results;  // 已生成但尚未被父节点取走的节点下标
+    bool expanding;                  // 当前是展开还是生成
+
+    // 展开内部节点：先压入节点自己，子节点生成完后再次访问它
+    void expand(ASTNode& node) {
+        work.push_back(WorkItem{&node, true});
+    }
+
+    // 把子节点压入工作栈，空指针表示不存在的子节点，直接跳过
+    void push(ASTNode* child) {
+        if (child != nullptr) {
+            work.push_back(WorkItem{child, false});
+        }
+    }
+
+    // 把列表中的子节点逆序压栈，使它们按原顺序生成
+    template <typename T>
+    void pushList(const NodeList<T>& items) {
+        for (size_t i = items.size(); i > 0; i--) {
+            push(items[i - 1]);
+        }
+    }
+
+    // 取出子节点的下标，必须与push的顺序相反
+    NodeIndex pop(ASTNode* child) {
+        if (child == nullptr) {
+            return NO_NODE;
+        }
+        NodeIndex index = results.back();
+        results.pop_back();
+        return index;
+    }
+
+    // 取出列表中的子节点，在extra池中写入[个数, 下标...]，返回偏移
+    template <typename T>
+    uint32_t popList(const NodeList<T>& items) {
+        size_t count = 0;
+        for (T* item : items) {
+            if (item != nullptr) {
+                count++;
+            }
+        }
+        uint32_t offset = static_cast<uint32_t>(ast.extra.size());
+        ast.extra.push_back(static_cast<uint32_t>(count));
+        ast.extra.insert(ast.extra.end(), results.end() - count, results.end());
+        results.resize(results.size() - count);
+        return offset;
+    }
+
+    // 在extra池中写入两个值，返回偏移
+    uint32_t extraPair(uint32_t first, uint32_t second) {
+        uint32_t offset = static_cast<uint32_t>(ast.extra.size());
+        ast.extra.push_back(first);
+        ast.extra.push_back(second);
+        return offset;
+    }
+
+    // 生成一个节点，并把下标留在结果栈中供父节点取用
+    void emit(NodeKind kind, uint8_t tag, int line, uint32_t lhs, uint32_t rhs) {
+        results.push_back(static_cast<NodeIndex>(ast.kinds.size()));
+        ast.kinds.push_back(kind);
+        ast.tags.push_back(tag);
+        ast.lines.push_back(line);
+        ast.lhs.push_back(lhs);
+        ast.rhs.push_back(rhs);
+    }
+
+    static uint8_t typeTag(Type type) {
+        return static_cast<uint8_t>(type);
+    }
+
+public:
+    explicit FlatAstBuilder(FlatAst& ast) : ast(ast), expanding(false) {}
+
+    // 从根节点开始转换
+    void run(CompUnit& root) {
+        work.push_back(WorkItem{&root, false});
+        while (!work.empty()) {
+            WorkItem item = work.back();
+            work.pop_back();
+            expanding = !item.expanded;
+            item.node->accept(*this);
+        }
+    }
+
+    void visit(CompUnit& node) override {
+        if (expanding) {
+            expand(node);
+            pushList(node.getFuncDefs());
+            pushList(node.getDecls());
+            return;
+        }
+        uint32_t funcDefs = popList(node.getFuncDefs());
+        uint32_t decls = popList(node.getDecls());
+        emit(NodeKind::COMP_UNIT, 0, node.getLine(), decls, funcDefs);
+    }
+
+    void visit(FuncDef& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getBody());
+            pushList(node.getParams());
+            return;
+        }
+        NodeIndex body = pop(node.getBody());
+        uint32_t params = popList(node.getParams());
+        emit(NodeKind::FUNC_DEF, typeTag(node.getReturnType()), node.getLine(),
+             node.getName().id, extraPair(params, body));
+    }
+
+    void visit(VarDecl& node) override {
+        if (expanding) {
+            expand(node);
+            pushList(node.getVarDefs());
+            return;
+        }
+        uint32_t varDefs = popList(node.getVarDefs());
+        uint8_t tag = typeTag(node.getType()) | (node.getIsConst() ? FlatAst::CONST_FLAG : 0);
+        emit(NodeKind::VAR_DECL, tag, node.getLine(), varDefs, 0);
+    }
+
+    void visit(IfStmt& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getElseStmt());
+            push(node.getThenStmt());
+            push(node.getCondition());
+            return;
+        }
+        NodeIndex elseStmt = pop(node.getElseStmt());
+        NodeIndex thenStmt = pop(node.getThenStmt());
+        NodeIndex condition = pop(node.getCondition());
+        emit(NodeKind::IF_STMT, 0, node.getLine(), condition, extraPair(thenStmt, elseStmt));
+    }
+
+    void visit(WhileStmt& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getBody());
+            push(node.getCondition());
+            return;
+        }
+        NodeIndex body = pop(node.getBody());
+        NodeIndex condition = pop(node.getCondition());
+        emit(NodeKind::WHILE_STMT, 0, node.getLine(), condition, body);
+    }
+
+    void visit(BreakStmt& node) override {
+        emit(NodeKind::BREAK_STMT, 0, node.getLine(), 0, 0);
+    }
+
+    void visit(ContinueStmt& node) override {
+        emit(NodeKind::CONTINUE_STMT, 0, node.getLine(), 0, 0);
+    }
+
+    void visit(ReturnStmt& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getExpr());
+            return;
+        }
+        NodeIndex expr = pop(node.getExpr());
+        emit(NodeKind::RETURN_STMT, 0, node.getLine(), expr, 0);
+    }
+
+    void visit(BinaryExpr& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getRight());
+            push(node.getLeft());
+            return;
+        }
+        NodeIndex right = pop(node.getRight());
+        NodeIndex left = pop(node.getLeft());
+        emit(NodeKind::BINARY_EXPR, static_cast<uint8_t>(node.getOp()), node.getLine(), left, right);
+    }
+
+    void visit(UnaryExpr& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getOperand());
+            return;
+        }
+        NodeIndex operand = pop(node.getOperand());
+        emit(NodeKind::UNARY_EXPR, static_cast<uint8_t>(node.getOp()), node.getLine(), operand, 0);
+    }
+
+    void visit(CallExpr& node) override {
+        if (expanding) {
+            expand(node);
+            pushList(node.getArgs());
+            return;
+        }
+        uint32_t args = popList(node.getArgs());
+        emit(NodeKind::CALL_EXPR, 0, node.getLine(), node.getCallee().id, args);
+    }
+
+    void visit(IndexExpr& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getIndex());
+            push(node.getBase());
+            return;
+        }
+        NodeIndex index = pop(node.getIndex());
+        NodeIndex base = pop(node.getBase());
+        emit(NodeKind::INDEX_EXPR, 0, node.getLine(), base, index);
+    }
+
+    void visit(NumberExpr& node) override {
+        if (node.getType() == Type::FLOAT) {
+            float value = node.getFloatValue();
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            emit(NodeKind::FLOAT_LITERAL, typeTag(Type::FLOAT), node.getLine(), bits, 0);
+        } else {
+            emit(NodeKind::INT_LITERAL, typeTag(Type::INT), node.getLine(),
+                 static_cast<uint32_t>(node.getIntValue()), 0);
+        }
+    }
+
+    void visit(VariableExpr& node) override {
+        emit(NodeKind::VARIABLE_EXPR, 0, node.getLine(), node.getName().id, 0);
+    }
+
+    void visit(Block& node) override {
+        if (expanding) {
+            expand(node);
+            pushList(node.getStatements());
+            return;
+        }
+        uint32_t statements = popList(node.getStatements());
+        emit(NodeKind::BLOCK, 0, node.getLine(), statements, 0);
+    }
+
+    void visit(VarDef& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getInitExpr());
+            pushList(node.getDims());
+            return;
+        }
+        NodeIndex initExpr = pop(node.getInitExpr());
+        uint32_t dims = popList(node.getDims());
+        emit(NodeKind::VAR_DEF, node.getIsArray() ? FlatAst::ARRAY_FLAG : 0, node.getLine(),
+             node.getName().id, extraPair(dims, initExpr));
+    }
+
+    void visit(FuncFParam& node) override {
+        uint8_t tag = typeTag(node.getType()) | (node.getIsArray() ? FlatAst::ARRAY_FLAG : 0);
+        emit(NodeKind::FUNC_PARAM, tag, node.getLine(), node.getName().id,
+             static_cast<uint32_t>(node.getArraySize()));
+    }
+
+    void visit(ExprStmt& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getExpr());
+            return;
+        }
+        NodeIndex expr = pop(node.getExpr());
+        emit(NodeKind::EXPR_STMT, 0, node.getLine(), expr, 0);
+    }
+
+    void visit(DeclStmt& node) override {
+        if (expanding) {
+            expand(node);
+            push(node.getDecl());
+            return;
+        }
+        NodeIndex decl = pop(node.getDecl());
+        emit(NodeKind::DECL_STMT, 0, node.getLine(), decl, 0);
+    }
+};
+
+// 由指针形式的语法树生成扁平编码
+FlatAst FlatAst::build(CompUnit& root, size_t nodeHint) {
+    FlatAst ast;
+    ast.kinds.reserve(nodeHint);
+    ast.tags.reserve(nodeHint);
+    ast.lines.reserve(nodeHint);
+    ast.lhs.reserve(nodeHint);
+    ast.rhs.reserve(nodeHint);
+    FlatAstBuilder builder(ast);
+    builder.run(root);
+    return ast;
+}
+
+namespace {
+
+// 比较中工作栈的一项：指针形式的节点和它在扁平编码中的下标
+struct NodePair {
+    ASTNode* node;
+    NodeIndex index;
+};
+
+// FlatAstChecker类 - 逐个节点比较扁平编码和指针形式的语法树
+// 从两边的根节点出发，用显式栈同时遍历：每对节点比较种类、tag、行号和操作数，
+// 再把对应的子节点（单个子节点和列表中的各项）配对压栈；子节点的下标必须小于父节点（后序排列）
+class FlatAstChecker {
+private:
+    const FlatAst& ast;
+    std::vector<NodePair> work; // 工作栈
+    std::ostringstream error;   // 第一处不一致的描述
+    NodeIndex current;          // 正在比较的节点
+
+    // 记录不一致，返回false
+    bool fail(const char* what) {
+        error << "node " << current << " (kind " << static_cast<int>(ast.kind(current)) << ", line "
+              << ast.line(current) << "): " << what;
+        return false;
+    }
+
+    bool expect(bool condition, const char* what) {
+        return condition || fail(what);
+    }
+
+    // 比较单个子节点：指针为空时下标必须是NO_NODE
+    bool child(ASTNode* node, NodeIndex index) {
+        if (node == nullptr) {
+            return expect(index == NO_NODE, "child should be absent");
+        }
+        if (index == NO_NODE || index >= current) {
+            return fail("child index is not before its parent");
+        }
+        work.push_back(NodePair{node, index});
+        return true;
+    }
+
+    // 比较子节点列表：扁平编码中只保存非空的子节点
+    template <typename T>
+    bool children(const NodeList<T>& items, NodeRange range) {
+        size_t next = 0;
+        for (T* item : items) {
+            if (item == nullptr) {
+                continue;
+            }
+            if (next == range.size()) {
+                return fail("child list is too short");
+            }
+            if (!child(item, range[next++])) {
+                return false;
+            }
+        }
+        return expect(next == range.size(), "child list is too long");
+    }
+
+    bool operands(uint8_t tag, uint32_t lhs, uint32_t rhs) {
+        return expect(ast.tag(current) == tag, "tag differs") && expect(ast.left(current) == lhs, "lhs differs") &&
+               expect(ast.right(current) == rhs, "rhs differs");
+    }
+
+    bool tagAndLeft(uint8_t tag, uint32_t lhs) {
+        return expect(ast.tag(current) == tag, "tag differs") && expect(ast.left(current) == lhs, "lhs differs");
+    }
+
+    static uint8_t typeTag(Type type) {
+        return static_cast<uint8_t>(type);
+    }
+
+    // 比较一对节点，并把子节点配对压栈
+    bool compare(ASTNode* node) {
+        if (!expect(ast.kind(current) == node->getKind(), "kind differs") ||
+            !expect(ast.line(current) == node->getLine(), "line differs")) {
+            return false;
+        }
+        switch (node->getKind()) {
+            case NodeKind::COMP_UNIT: {
+                CompUnit* unit = cast<CompUnit>(node);
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       children(unit->getDecls(), ast.children(current)) &&
+                       children(unit->getFuncDefs(), ast.funcDefs(current));
+            }
+            case NodeKind::FUNC_DEF: {
+                FuncDef* funcDef = cast<FuncDef>(node);
+                return tagAndLeft(typeTag(funcDef->getReturnType()), funcDef->getName().id) &&
+                       children(funcDef->getParams(), ast.params(current)) &&
+                       child(funcDef->getBody(), ast.body(current));
+            }
+            case NodeKind::FUNC_PARAM: {
+                FuncFParam* param = cast<FuncFParam>(node);
+                uint8_t tag = typeTag(param->getType()) | (param->getIsArray() ? FlatAst::ARRAY_FLAG : 0);
+                return operands(tag, param->getName().id, static_cast<uint32_t>(param->getArraySize()));
+            }
+            case NodeKind::VAR_DECL: {
+                VarDecl* varDecl = cast<VarDecl>(node);
+                uint8_t tag = typeTag(varDecl->getType()) | (varDecl->getIsConst() ? FlatAst::CONST_FLAG : 0);
+                return expect(ast.tag(current) == tag, "tag differs") &&
+                       expect(ast.right(current) == 0, "rhs differs") &&
+                       children(varDecl->getVarDefs(), ast.children(current));
+            }
+            case NodeKind::VAR_DEF: {
+                VarDef* varDef = cast<VarDef>(node);
+                return tagAndLeft(varDef->getIsArray() ? FlatAst::ARRAY_FLAG : 0, varDef->getName().id) &&
+                       children(varDef->getDims(), ast.dims(current)) &&
+                       child(varDef->getInitExpr(), ast.initExpr(current));
+            }
+            case NodeKind::BLOCK:
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       children(cast<Block>(node)->getStatements(), ast.children(current));
+            case NodeKind::DECL_STMT:
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       child(cast<DeclStmt>(node)->getDecl(), ast.left(current));
+            case NodeKind::EXPR_STMT:
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       child(cast<ExprStmt>(node)->getExpr(), ast.left(current));
+            case NodeKind::IF_STMT: {
+                IfStmt* ifStmt = cast<IfStmt>(node);
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       child(ifStmt->getCondition(), ast.left(current)) &&
+                       child(ifStmt->getThenStmt(), ast.thenBranch(current)) &&
+                       child(ifStmt->getElseStmt(), ast.elseBranch(current));
+            }
+            case NodeKind::WHILE_STMT: {
+                WhileStmt* whileStmt = cast<WhileStmt>(node);
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       child(whileStmt->getCondition(), ast.left(current)) &&
+                       child(whileStmt->getBody(), ast.right(current));
+            }
+            case NodeKind::BREAK_STMT:
+            case NodeKind::CONTINUE_STMT:
+                return operands(0, 0, 0);
+            case NodeKind::RETURN_STMT:
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       child(cast<ReturnStmt>(node)->getExpr(), ast.left(current));
+            case NodeKind::BINARY_EXPR: {
+                BinaryExpr* binary = cast<BinaryExpr>(node);
+                return expect(ast.op(current) == binary->getOp(), "operator differs") &&
+                       child(binary->getLeft(), ast.left(current)) &&
+                       child(binary->getRight(), ast.right(current));
+            }
+            case NodeKind::UNARY_EXPR: {
+                UnaryExpr* unary = cast<UnaryExpr>(node);
+                return expect(ast.op(current) == unary->getOp(), "operator differs") &&
+                       child(unary->getOperand(), ast.left(current));
+            }
+            case NodeKind::CALL_EXPR: {
+                CallExpr* call = cast<CallExpr>(node);
+                return tagAndLeft(0, call->getCallee().id) && children(call->getArgs(), ast.args(current));
+            }
+            case NodeKind::INDEX_EXPR: {
+                IndexExpr* index = cast<IndexExpr>(node);
+                return expect(ast.tag(current) == 0, "tag differs") &&
+                       child(index->getBase(), ast.left(current)) &&
+                       child(index->getIndex(), ast.right(current));
+            }
+            case NodeKind::INT_LITERAL:
+                return operands(typeTag(Type::INT), static_cast<uint32_t>(cast<NumberExpr>(node)->getIntValue()), 0);
+            case NodeKind::FLOAT_LITERAL: {
+                float value = cast<NumberExpr>(node)->getFloatValue();
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return operands(typeTag(Type::FLOAT), bits, 0);
+            }
+            case NodeKind::VARIABLE_EXPR:
+                return operands(0, cast<VariableExpr>(node)->getName().id, 0);
+        }
+        return fail("unknown node kind");
+    }
+
+public:
+    explicit FlatAstChecker(const FlatAst& ast) : ast(ast), current(0) {}
+
+    // 比较整棵树，返回第一处不一致的描述，完全一致时返回空串
+    std::string run(CompUnit& root) {
+        if (ast.size() == 0) {
+            return "flat AST is empty";
+        }
+        size_t visited = 0;
+        work.push_back(NodePair{&root, ast.root()});
+        while (!work.empty()) {
+            NodePair pair = work.back();
+            work.pop_back();
+            current = pair.index;
+            visited++;
+            if (!compare(pair.node)) {
+                return error.str();
+            }
+        }
+        if (visited != ast.size()) {
+            error << visited << " nodes reachable from the root, but the flat AST has " << ast.size();
+            return error.str();
+        }
+        return std::string();
+    }
+};
+
+} // namespace
+
+// 与指针形式的语法树比较
+std::string FlatAst::verify(CompUnit& root) const {
+    FlatAstChecker checker(*this);
+    return checker.run(root);
+}
@@ -0,0 +1,38 @@
+#include "../include/interner.h"
+
+// 获取标识符的名字
+std::string_view Symbol::str() const {
+    return StringInterner::global().name(*this);
+}
+
+// 输出标识符的名字
+std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+    return os << symbol.str();
+}
+
+// 驻留表构造函数
+// 预先驻留空名字，使编号0表示空名字
+StringInterner::StringInterner() {
+    intern("");
+}
+
+// 获取进程范围的驻留表
+// 函数内静态变量的初始化是线程安全的，但之后的驻留操作需要调用者保证不会并发
+StringInterner& StringInterner::global() {
+    static StringInterner instance;
+    return instance;
+}
+
+// 驻留名字
+// 名字已存在时返回原编号，否则复制一份保存并分配新编号
+Symbol StringInterner::intern(std::string_view name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return Symbol(it->second);
+    }
+
+    uint32_t id = static_cast<uint32_t>(names.size());
+    names.emplace_back(name);
+    ids.emplace(names.back(), id);
+    return Symbol(id);
+}
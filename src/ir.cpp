@@ -0,0 +1,690 @@
+#include "../include/ir.h"
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// 把本值的全部使用改为使用value
+void Value::replaceAllUsesWith(Value* value) {
+    while (uses != nullptr) {
+        uses->set(value);
+    }
+}
+
+// 把Use加入所用值的链表头部
+void Use::link() {
+    if (value == nullptr) {
+        return;
+    }
+    next = value->uses;
+    prev = &value->uses;
+    if (next != nullptr) {
+        next->prev = &next;
+    }
+    value->uses = this;
+}
+
+// 把Use从所用值的链表中摘除
+void Use::unlink() {
+    if (value == nullptr) {
+        return;
+    }
+    *prev = next;
+    if (next != nullptr) {
+        next->prev = prev;
+    }
+    next = nullptr;
+    prev = nullptr;
+}
+
+// 改为使用newValue
+void Use::set(Value* newValue) {
+    unlink();
+    value = newValue;
+    link();
+}
+
+// φ函数：添加一个前驱
+// 容量不足时在Arena中分配两倍大小的新数组，把原有的Use逐个移过去（重新链接到各自的值）
+void Instruction::addIncoming(Value* value, BasicBlock* block, Arena& arena) {
+    if (operandCount == capacity) {
+        uint32_t newCapacity = capacity == 0 ? 2 : capacity * 2;
+        Use* newOperands = arena.allocateArray<Use>(newCapacity);
+        BasicBlock** newBlocks = arena.allocateArray<BasicBlock*>(newCapacity);
+        for (uint32_t i = 0; i < newCapacity; i++) {
+            new (&newOperands[i]) Use();
+            newOperands[i].setUser(this);
+        }
+        for (uint32_t i = 0; i < operandCount; i++) {
+            newOperands[i].set(operands[i].get());
+            operands[i].set(nullptr);
+            newBlocks[i] = blocks[i];
+        }
+        operands = newOperands;
+        blocks = newBlocks;
+        capacity = newCapacity;
+    }
+    operands[operandCount].set(value);
+    blocks[operandCount] = block;
+    operandCount++;
+    blockCount++;
+}
+
+// φ函数：删除第index个前驱，最后一个前驱移到它的位置
+void Instruction::removeIncoming(uint32_t index) {
+    uint32_t lastIndex = operandCount - 1;
+    operands[index].set(operands[lastIndex].get());
+    blocks[index] = blocks[lastIndex];
+    operands[lastIndex].set(nullptr);
+    operandCount--;
+    blockCount--;
+}
+
+// φ函数：来自前驱块block的值
+Value* Instruction::getIncomingValueFor(const BasicBlock* block) const {
+    for (uint32_t i = 0; i < blockCount; i++) {
+        if (blocks[i] == block) {
+            return operands[i].get();
+        }
+    }
+    return nullptr;
+}
+
+// 清除全部操作数的使用
+void Instruction::dropOperands() {
+    for (uint32_t i = 0; i < operandCount; i++) {
+        operands[i].set(nullptr);
+    }
+}
+
+// 从基本块中摘除指令并清除操作数
+void Instruction::eraseFromParent() {
+    dropOperands();
+    parent->remove(this);
+}
+
+// 把指令插入到before之前
+void BasicBlock::insert(Instruction* inst, Instruction* before) {
+    inst->parent = this;
+    inst->next = before;
+    inst->prev = before != nullptr ? before->prev : last;
+    if (inst->prev != nullptr) {
+        inst->prev->next = inst;
+    } else {
+        first = inst;
+    }
+    if (before != nullptr) {
+        before->prev = inst;
+    } else {
+        last = inst;
+    }
+}
+
+// 摘除指令
+void BasicBlock::remove(Instruction* inst) {
+    if (inst->prev != nullptr) {
+        inst->prev->next = inst->next;
+    } else {
+        first = inst->next;
+    }
+    if (inst->next != nullptr) {
+        inst->next->prev = inst->prev;
+    } else {
+        last = inst->prev;
+    }
+    inst->parent = nullptr;
+    inst->prev = nullptr;
+    inst->next = nullptr;
+}
+
+// 构造函数
+Function::Function(Symbol name, IRType returnType)
+    : name(name), returnType(returnType), first(nullptr), last(nullptr), blockCount(0) {}
+
+// 添加形参
+Argument* Function::addArgument(IRType type, Symbol name) {
+    Argument* arg = arena.make<Argument>(type, name, static_cast<unsigned>(args.size()));
+    args.push_back(arg);
+    return arg;
+}
+
+// 在末尾创建一个新的基本块
+BasicBlock* Function::createBlock() {
+    BasicBlock* block = arena.make<BasicBlock>(this);
+    block->index = static_cast<uint32_t>(blockCount);
+    block->prev = last;
+    if (last != nullptr) {
+        last->next = block;
+    } else {
+        first = block;
+    }
+    last = block;
+    blockCount++;
+    return block;
+}
+
+// 删除基本块
+void Function::eraseBlock(BasicBlock* block) {
+    for (Instruction* inst = block->first; inst != nullptr; inst = inst->getNext()) {
+        inst->dropOperands();
+    }
+    if (block->prev != nullptr) {
+        block->prev->next = block->next;
+    } else {
+        first = block->next;
+    }
+    if (block->next != nullptr) {
+        block->next->prev = block->prev;
+    } else {
+        last = block->prev;
+    }
+    block->prev = nullptr;
+    block->next = nullptr;
+    blockCount--;
+}
+
+// 重新给基本块编号
+void Function::renumberBlocks() {
+    uint32_t index = 0;
+    for (BasicBlock* block = first; block != nullptr; block = block->next) {
+        block->index = index++;
+    }
+}
+
+// 按给定顺序重排基本块，删除其余的基本块
+void Function::reorderBlocks(const std::vector<BasicBlock*>& order) {
+    for (BasicBlock* block = first; block != nullptr; block = block->next) {
+        block->index = UINT32_MAX;
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i]->index = static_cast<uint32_t>(i);
+    }
+    for (BasicBlock* block = first; block != nullptr; block = block->next) {
+        if (block->index != UINT32_MAX) {
+            continue;
+        }
+        for (uint32_t i = 0; i < block->getSuccessorCount(); i++) {
+            BasicBlock* successor = block->getSuccessor(i);
+            if (successor->index == UINT32_MAX) {
+                continue;
+            }
+            for (Instruction* inst = successor->first; inst != nullptr && inst->getOpcode() == Opcode::PHI;
+                 inst = inst->getNext()) {
+                for (uint32_t j = inst->getBlockCount(); j-- > 0;) {
+                    if (inst->getBlock(j) == block) {
+                        inst->removeIncoming(j);
+                    }
+                }
+            }
+        }
+    }
+    for (BasicBlock* block = first; block != nullptr; block = block->next) {
+        if (block->index != UINT32_MAX) {
+            continue;
+        }
+        for (Instruction* inst = block->first; inst != nullptr; inst = inst->getNext()) {
+            inst->dropOperands();
+        }
+    }
+    BasicBlock* previous = nullptr;
+    for (BasicBlock* block : order) {
+        block->prev = previous;
+        block->next = nullptr;
+        if (previous != nullptr) {
+            previous->next = block;
+        }
+        previous = block;
+    }
+    first = order.empty() ? nullptr : order.front();
+    last = previous;
+    blockCount = order.size();
+}
+
+// 整数常量
+Constant* Function::getConstant(int value) {
+    Constant*& constant = intConstants[value];
+    if (constant == nullptr) {
+        constant = arena.make<Constant>(value);
+    }
+    return constant;
+}
+
+// 浮点数常量，按位模式区分（0.0和-0.0是不同的常量）
+Constant* Function::getConstant(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Constant*& constant = floatConstants[bits];
+    if (constant == nullptr) {
+        constant = arena.make<Constant>(value);
+    }
+    return constant;
+}
+
+// 创建全局变量
+GlobalVariable* Module::createGlobal(Symbol name, IRType elementType, uint32_t count, bool isArray) {
+    GlobalVariable* global = arena.make<GlobalVariable>(name, elementType, count, isArray);
+    globals.push_back(global);
+    return global;
+}
+
+// 创建函数
+Function* Module::createFunction(Symbol name, IRType returnType) {
+    functions.push_back(std::make_unique<Function>(name, returnType));
+    return functions.back().get();
+}
+
+// 分配并插入一条指令
+Instruction* IRBuilder::create(Opcode opcode, IRType type, uint32_t operandCount, uint32_t blockCount) {
+    Arena& arena = function->getArena();
+    Instruction* inst = arena.make<Instruction>(opcode, type);
+    uint32_t capacity = operandCount > blockCount ? operandCount : blockCount;
+    if (capacity > 0) {
+        inst->operands = arena.allocateArray<Use>(capacity);
+        for (uint32_t i = 0; i < capacity; i++) {
+            new (&inst->operands[i]) Use();
+            inst->operands[i].setUser(inst);
+        }
+    }
+    // 只有跳转和φ函数需要blocks数组
+    if (blockCount > 0 || (opcode == Opcode::PHI && capacity > 0)) {
+        inst->blocks = arena.allocateArray<BasicBlock*>(capacity);
+    }
+    inst->capacity = capacity;
+    inst->operandCount = operandCount;
+    inst->blockCount = blockCount;
+    block->insert(inst, before);
+    return inst;
+}
+
+// 二元算术运算，结果类型与操作数相同
+Instruction* IRBuilder::createBinary(Opcode opcode, Value* left, Value* right) {
+    Instruction* inst = create(opcode, left->getType(), 2, 0);
+    inst->setOperand(0, left);
+    inst->setOperand(1, right);
+    return inst;
+}
+
+// 取负：整数为0 - x，浮点数为fneg
+Instruction* IRBuilder::createNeg(Value* operand) {
+    if (operand->getType() == IRType::I32) {
+        return createBinary(Opcode::SUB, function->getConstant(0), operand);
+    }
+    Instruction* inst = create(Opcode::FNEG, IRType::F32, 1, 0);
+    inst->setOperand(0, operand);
+    return inst;
+}
+
+// 比较，按操作数类型选择ICMP或FCMP，结果为i32
+Instruction* IRBuilder::createCmp(CmpPredicate predicate, Value* left, Value* right) {
+    Opcode opcode = left->getType() == IRType::F32 ? Opcode::FCMP : Opcode::ICMP;
+    Instruction* inst = create(opcode, IRType::I32, 2, 0);
+    inst->predicate = predicate;
+    inst->setOperand(0, left);
+    inst->setOperand(1, right);
+    return inst;
+}
+
+// 在栈上分配count个type类型的元素，结果为地址
+Instruction* IRBuilder::createAlloca(IRType type, uint32_t count, bool isArray, Symbol name) {
+    Instruction* inst = create(Opcode::ALLOCA, IRType::PTR, 0, 0);
+    inst->allocatedType = type;
+    inst->allocaCount = count;
+    inst->allocatedArray = isArray;
+    inst->name = name;
+    return inst;
+}
+
+// 从地址读取一个type类型的值
+Instruction* IRBuilder::createLoad(IRType type, Value* address) {
+    Instruction* inst = create(Opcode::LOAD, type, 1, 0);
+    inst->setOperand(0, address);
+    return inst;
+}
+
+// 把值写入地址
+Instruction* IRBuilder::createStore(Value* value, Value* address) {
+    Instruction* inst = create(Opcode::STORE, IRType::VOID, 2, 0);
+    inst->setOperand(0, value);
+    inst->setOperand(1, address);
+    return inst;
+}
+
+// 元素地址：base + index * 元素大小
+Instruction* IRBuilder::createGep(Value* base, Value* index) {
+    Instruction* inst = create(Opcode::GEP, IRType::PTR, 2, 0);
+    inst->setOperand(0, base);
+    inst->setOperand(1, index);
+    return inst;
+}
+
+// 函数调用
+Instruction* IRBuilder::createCall(Function* callee, Value* const* args, size_t argCount) {
+    Instruction* inst = create(Opcode::CALL, callee->getReturnType(), static_cast<uint32_t>(argCount), 0);
+    inst->callee = callee;
+    for (size_t i = 0; i < argCount; i++) {
+        inst->setOperand(static_cast<uint32_t>(i), args[i]);
+    }
+    return inst;
+}
+
+// φ函数：创建时没有前驱，由addIncoming逐个添加
+Instruction* IRBuilder::createPhi(IRType type, uint32_t capacity) {
+    Instruction* inst = create(Opcode::PHI, type, capacity, 0);
+    inst->operandCount = 0;
+    return inst;
+}
+
+// 无条件跳转
+Instruction* IRBuilder::createBr(BasicBlock* target) {
+    Instruction* inst = create(Opcode::BR, IRType::VOID, 0, 1);
+    inst->blocks[0] = target;
+    return inst;
+}
+
+// 条件跳转
+Instruction* IRBuilder::createCondBr(Value* condition, BasicBlock* trueBlock, BasicBlock* falseBlock) {
+    Instruction* inst = create(Opcode::CONDBR, IRType::VOID, 1, 2);
+    inst->setOperand(0, condition);
+    inst->blocks[0] = trueBlock;
+    inst->blocks[1] = falseBlock;
+    return inst;
+}
+
+// 返回，value为nullptr时返回void
+Instruction* IRBuilder::createRet(Value* value) {
+    Instruction* inst = create(Opcode::RET, IRType::VOID, value != nullptr ? 1 : 0, 0);
+    if (value != nullptr) {
+        inst->setOperand(0, value);
+    }
+    return inst;
+}
+
+namespace {
+
+// 类型名
+const char* typeName(IRType type) {
+    switch (type) {
+        case IRType::VOID: return "void";
+        case IRType::I32: return "i32";
+        case IRType::F32: return "float";
+        case IRType::PTR: return "ptr";
+    }
+    return "?";
+}
+
+// 操作码名
+const char* opcodeName(Opcode opcode) {
+    static const char* const NAMES[] = {
+        "add", "sub", "mul", "sdiv", "srem", "fadd", "fsub", "fmul", "fdiv", "frem", "fneg",
+        "icmp", "fcmp", "alloca", "load", "store", "gep", "call", "phi", "br", "br", "ret"};
+    return NAMES[static_cast<size_t>(opcode)];
+}
+
+// 比较谓词名
+const char* predicateName(CmpPredicate predicate) {
+    static const char* const NAMES[] = {"eq", "ne", "lt", "gt", "le", "ge"};
+    return NAMES[static_cast<size_t>(predicate)];
+}
+
+// 在缓冲区末尾追加整数
+void appendNumber(std::string& buffer, long long value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+// 在缓冲区末尾追加浮点数：能精确还原的最短形式，整数值补上".0"以区别于整数常量
+void appendFloat(std::string& buffer, float value) {
+    char digits[32];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    std::string_view text(digits, static_cast<size_t>(end - digits));
+    buffer.append(text);
+    if (text.find_first_of(".eina") == std::string_view::npos) {
+        buffer.append(".0");
+    }
+}
+
+} // namespace
+
+// 函数的输出：值按形参、指令的顺序编号为%0、%1...（编号记录在Value::number中），基本块按链表顺序命名为bb0、bb1...
+// 输出整个模块时所有函数共用一个FunctionPrinter
+class FunctionPrinter {
+private:
+    std::string& buffer;
+    std::unordered_map<const BasicBlock*, uint32_t> blockNumbers; // 基本块的编号
+
+    // 输出一个值：常量直接输出，全局变量为@名字，其余为%编号
+    void appendValue(const Value* value) {
+        if (value == nullptr) {
+            buffer.append("<null>");
+            return;
+        }
+        switch (value->getKind()) {
+            case ValueKind::CONSTANT: {
+                const Constant* constant = static_cast<const Constant*>(value);
+                if (constant->getType() == IRType::F32) {
+                    appendFloat(buffer, constant->getFloatValue());
+                } else {
+                    appendNumber(buffer, constant->getIntValue());
+                }
+                return;
+            }
+            case ValueKind::GLOBAL:
+                buffer.push_back('@');
+                buffer.append(static_cast<const GlobalVariable*>(value)->getName().str());
+                return;
+            default:
+                buffer.push_back('%');
+                appendNumber(buffer, value->number);
+                return;
+        }
+    }
+
+    // 输出"类型 值"
+    void appendTypedValue(const Value* value) {
+        buffer.append(typeName(value != nullptr ? value->getType() : IRType::VOID));
+        buffer.push_back(' ');
+        appendValue(value);
+    }
+
+    // 输出基本块名
+    void appendBlock(const BasicBlock* block) {
+        buffer.append("%bb");
+        auto found = blockNumbers.find(block);
+        appendNumber(buffer, found != blockNumbers.end() ? found->second : 999999);
+    }
+
+    void appendInstruction(const Instruction& inst);
+
+public:
+    explicit FunctionPrinter(std::string& buffer) : buffer(buffer) {}
+
+    void print(const Function& function);
+};
+
+// 输出一条指令
+void FunctionPrinter::appendInstruction(const Instruction& inst) {
+    buffer.append("  ");
+    if (inst.getType() != IRType::VOID) {
+        appendValue(&inst);
+        buffer.append(" = ");
+    }
+    Opcode opcode = inst.getOpcode();
+    buffer.append(opcodeName(opcode));
+    switch (opcode) {
+        case Opcode::ICMP:
+        case Opcode::FCMP:
+            buffer.push_back(' ');
+            buffer.append(predicateName(inst.getPredicate()));
+            buffer.push_back(' ');
+            appendTypedValue(inst.getOperand(0));
+            buffer.append(", ");
+            appendValue(inst.getOperand(1));
+            break;
+        case Opcode::ALLOCA:
+            buffer.push_back(' ');
+            buffer.append(typeName(inst.getAllocatedType()));
+            if (inst.isArrayAlloca()) {
+                buffer.append(", ");
+                appendNumber(buffer, inst.getAllocaCount());
+            }
+            if (!inst.getName().empty()) {
+                buffer.append("    ; ");
+                buffer.append(inst.getName().str());
+            }
+            break;
+        case Opcode::LOAD:
+            buffer.push_back(' ');
+            buffer.append(typeName(inst.getType()));
+            buffer.append(", ");
+            appendTypedValue(inst.getOperand(0));
+            break;
+        case Opcode::STORE:
+        case Opcode::GEP:
+            buffer.push_back(' ');
+            appendTypedValue(inst.getOperand(0));
+            buffer.append(", ");
+            appendTypedValue(inst.getOperand(1));
+            break;
+        case Opcode::CALL:
+            buffer.push_back(' ');
+            buffer.append(typeName(inst.getType()));
+            buffer.append(" @");
+            buffer.append(inst.getCallee()->getName().str());
+            buffer.push_back('(');
+            for (uint32_t i = 0; i < inst.getOperandCount(); i++) {
+                if (i > 0) {
+                    buffer.append(", ");
+                }
+                appendTypedValue(inst.getOperand(i));
+            }
+            buffer.push_back(')');
+            break;
+        case Opcode::PHI:
+            buffer.push_back(' ');
+            buffer.append(typeName(inst.getType()));
+            for (uint32_t i = 0; i < inst.getOperandCount(); i++) {
+                buffer.append(i == 0 ? " [ " : ", [ ");
+                appendValue(inst.getOperand(i));
+                buffer.append(", ");
+                appendBlock(inst.getBlock(i));
+                buffer.append(" ]");
+            }
+            break;
+        case Opcode::BR:
+            buffer.append(" label ");
+            appendBlock(inst.getBlock(0));
+            break;
+        case Opcode::CONDBR:
+            buffer.push_back(' ');
+            appendTypedValue(inst.getOperand(0));
+            buffer.append(", label ");
+            appendBlock(inst.getBlock(0));
+            buffer.append(", label ");
+            appendBlock(inst.getBlock(1));
+            break;
+        case Opcode::RET:
+            buffer.push_back(' ');
+            if (inst.getOperandCount() == 0) {
+                buffer.append("void");
+            } else {
+                appendTypedValue(inst.getOperand(0));
+            }
+            break;
+        default:
+            // 算术运算
+            buffer.push_back(' ');
+            appendTypedValue(inst.getOperand(0));
+            for (uint32_t i = 1; i < inst.getOperandCount(); i++) {
+                buffer.append(", ");
+                appendValue(inst.getOperand(i));
+            }
+            break;
+    }
+    buffer.push_back('\n');
+}
+
+// 输出整个函数
+void FunctionPrinter::print(const Function& function) {
+    blockNumbers.clear();
+    uint32_t next = 0;
+    for (const Argument* arg : function.getArgs()) {
+        arg->number = next++;
+    }
+    uint32_t blockIndex = 0;
+    for (const BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        blockNumbers[block] = blockIndex++;
+        for (const Instruction* inst = block->getFirst(); inst != nullptr; inst = inst->getNext()) {
+            if (inst->getType() != IRType::VOID) {
+                inst->number = next++;
+            }
+        }
+    }
+
+    buffer.append("define ");
+    buffer.append(typeName(function.getReturnType()));
+    buffer.append(" @");
+    buffer.append(function.getName().str());
+    buffer.push_back('(');
+    for (size_t i = 0; i < function.getArgs().size(); i++) {
+        if (i > 0) {
+            buffer.append(", ");
+        }
+        appendTypedValue(function.getArgs()[i]);
+    }
+    buffer.append(") {\n");
+    for (const BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        if (block != function.getEntry()) {
+            buffer.push_back('\n');
+        }
+        buffer.append("bb");
+        appendNumber(buffer, blockNumbers[block]);
+        buffer.append(":\n");
+        for (const Instruction* inst = block->getFirst(); inst != nullptr; inst = inst->getNext()) {
+            appendInstruction(*inst);
+        }
+    }
+    buffer.append("}\n");
+}
+
+// 以文本形式输出一个函数
+void printFunction(const Function& function, std::ostream& out) {
+    std::string buffer;
+    FunctionPrinter(buffer).print(function);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+// 以文本形式输出整个模块，在一个缓冲区中生成全部输出，只写一次输出流
+void Module::print(std::ostream& out) const {
+    std::string buffer;
+    for (const GlobalVariable* global : globals) {
+        buffer.push_back('@');
+        buffer.append(global->getName().str());
+        buffer.append(" = global ");
+        if (global->getIsArray()) {
+            buffer.push_back('[');
+            appendNumber(buffer, global->getCount());
+            buffer.append(" x ");
+            buffer.append(typeName(global->getElementType()));
+            buffer.append("] zeroinitializer\n");
+            continue;
+        }
+        buffer.append(typeName(global->getElementType()));
+        buffer.push_back(' ');
+        if (global->getElementType() == IRType::F32) {
+            appendFloat(buffer, global->getFloatInit());
+        } else {
+            appendNumber(buffer, global->getIntInit());
+        }
+        buffer.push_back('\n');
+    }
+    FunctionPrinter printer(buffer);
+    for (const auto& function : functions) {
+        if (!buffer.empty()) {
+            buffer.push_back('\n');
+        }
+        printer.print(*function);
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+}
@@ -0,0 +1,547 @@
+#include "../include/ir_lowering.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// 语法树的类型对应的IR类型
+IRType irTypeOf(Type type) {
+    switch (type) {
+        case Type::INT: return IRType::I32;
+        case Type::FLOAT: return IRType::F32;
+        case Type::VOID: return IRType::VOID;
+    }
+    return IRType::VOID;
+}
+
+} // namespace
+
+// 翻译整个编译单元
+std::unique_ptr<Module> IRLowering::lower(CompUnit& unit) {
+    std::unique_ptr<Module> module = std::make_unique<Module>();
+    IRLowering lowering(*module);
+    lowering.dispatch(&unit);
+    return module;
+}
+
+// 构造函数
+IRLowering::IRLowering(Module& module)
+    : module(module), function(nullptr), builder(nullptr), lastAlloca(nullptr), globalStrideCount(0) {}
+
+// 访问编译单元：先生成全局变量，再创建全部函数（调用可以引用任何函数），最后逐个翻译函数体
+void IRLowering::visitCompUnit(CompUnit& node) {
+    dispatchList(node.getDecls());
+    globalStrideCount = strides.size();
+    for (FuncDef* def : node.getFuncDefs()) {
+        Function* irFunction = module.createFunction(def->getName(), irTypeOf(def->getReturnType()));
+        for (FuncFParam* param : def->getParams()) {
+            irFunction->addArgument(param->getIsArray() ? IRType::PTR : irTypeOf(param->getType()), param->getName());
+        }
+        functions[def] = irFunction;
+    }
+    dispatchList(node.getFuncDefs());
+}
+
+// 访问函数定义
+// 标量形参先存入alloca，与局部变量一样通过load/store访问；数组形参本身就是首元素的地址
+void IRLowering::visitFuncDef(FuncDef& node) {
+    function = functions[&node];
+    builder = IRBuilder(function);
+    lastAlloca = nullptr;
+    locals.clear();
+    strides.resize(globalStrideCount);
+    builder.setInsertPoint(function->createBlock());
+
+    const NodeList<FuncFParam>& params = node.getParams();
+    for (size_t i = 0; i < params.size(); i++) {
+        FuncFParam* param = params[i];
+        Argument* arg = function->getArgs()[i];
+        IRType type = irTypeOf(param->getType());
+        if (param->getIsArray()) {
+            uint32_t size = param->getArraySize() > 0 ? static_cast<uint32_t>(param->getArraySize()) : 0;
+            addStorage(param, arg, type, {size});
+        } else {
+            Instruction* address = createAlloca(type, 1, false, param->getName());
+            builder.createStore(arg, address);
+            addStorage(param, address, type, {});
+        }
+    }
+
+    dispatch(node.getBody());
+
+    // 执行到函数末尾时返回：void函数直接返回，其余返回0
+    if (builder.getBlock()->getTerminator() == nullptr) {
+        switch (function->getReturnType()) {
+            case IRType::I32: builder.createRet(function->getConstant(0)); break;
+            case IRType::F32: builder.createRet(function->getConstant(0.0f)); break;
+            default: builder.createRet(nullptr); break;
+        }
+    }
+    finishFunction();
+    function = nullptr;
+}
+
+// 访问变量声明
+// 全局变量的初始值在编译期求出；局部变量在入口块分配，初始化表达式在声明的位置求值并写入
+void IRLowering::visitVarDecl(VarDecl& node) {
+    IRType type = irTypeOf(node.getType());
+    std::vector<uint32_t> dims;
+    for (VarDef* def : node.getVarDefs()) {
+        dims.clear();
+        uint32_t count = 1;
+        for (Expr* dim : def->getDims()) {
+            dims.push_back(dimensionOf(dim));
+            count *= dims.back();
+        }
+
+        if (function == nullptr) {
+            GlobalVariable* global = module.createGlobal(def->getName(), type, count, def->getIsArray());
+            ConstValue value;
+            if (!def->getIsArray() && def->getInitExpr() && evaluator.evaluate(def->getInitExpr(), value) &&
+                ConstEvaluator::convert(value, node.getType())) {
+                if (value.type == Type::FLOAT) {
+                    global->setInit(value.floatValue);
+                } else {
+                    global->setInit(value.intValue);
+                }
+            }
+            addStorage(def, global, type, dims);
+            continue;
+        }
+
+        Instruction* address = createAlloca(type, count, def->getIsArray(), def->getName());
+        addStorage(def, address, type, dims);
+        if (!def->getIsArray() && def->getInitExpr()) {
+            builder.createStore(lowerExpr(def->getInitExpr(), Mode::VALUE), address);
+        }
+    }
+}
+
+// 访问语句块：前一条语句结束了基本块（如return）时，后面的语句放在新的不可达基本块中
+void IRLowering::visitBlock(Block& node) {
+    for (Stmt* stmt : node.getStatements()) {
+        ensureOpenBlock();
+        dispatch(stmt);
+    }
+}
+
+// 访问表达式语句
+void IRLowering::visitExprStmt(ExprStmt& node) {
+    if (node.getExpr()) {
+        lowerExpr(node.getExpr(), Mode::VALUE);
+    }
+}
+
+// 访问if语句：条件跳转到then块或else块（没有else时为if之后的块），两个分支结束后汇合
+void IRLowering::visitIfStmt(IfStmt& node) {
+    BasicBlock* thenBlock = function->createBlock();
+    BasicBlock* elseBlock = node.getElseStmt() ? function->createBlock() : nullptr;
+    BasicBlock* mergeBlock = function->createBlock();
+    lowerExpr(node.getCondition(), Mode::COND, thenBlock, elseBlock ? elseBlock : mergeBlock);
+
+    builder.setInsertPoint(thenBlock);
+    dispatch(node.getThenStmt());
+    if (builder.getBlock()->getTerminator() == nullptr) {
+        builder.createBr(mergeBlock);
+    }
+    if (elseBlock) {
+        builder.setInsertPoint(elseBlock);
+        dispatch(node.getElseStmt());
+        if (builder.getBlock()->getTerminator() == nullptr) {
+            builder.createBr(mergeBlock);
+        }
+    }
+    builder.setInsertPoint(mergeBlock);
+}
+
+// 访问while语句：条件块为真时进入循环体，循环体结束后回到条件块，为假时离开循环
+void IRLowering::visitWhileStmt(WhileStmt& node) {
+    BasicBlock* condBlock = function->createBlock();
+    BasicBlock* bodyBlock = function->createBlock();
+    BasicBlock* exitBlock = function->createBlock();
+    builder.createBr(condBlock);
+
+    builder.setInsertPoint(condBlock);
+    lowerExpr(node.getCondition(), Mode::COND, bodyBlock, exitBlock);
+
+    builder.setInsertPoint(bodyBlock);
+    loops.push_back(Loop{condBlock, exitBlock});
+    dispatch(node.getBody());
+    loops.pop_back();
+    if (builder.getBlock()->getTerminator() == nullptr) {
+        builder.createBr(condBlock);
+    }
+    builder.setInsertPoint(exitBlock);
+}
+
+// 访问break语句：跳转到最内层循环之后的块，后面的语句放在新的不可达基本块中（见visitBlock）
+void IRLowering::visitBreakStmt(BreakStmt&) {
+    builder.createBr(loops.back().exitBlock);
+}
+
+// 访问continue语句：跳转到最内层循环的条件块
+void IRLowering::visitContinueStmt(ContinueStmt&) {
+    builder.createBr(loops.back().condBlock);
+}
+
+// 访问return语句
+void IRLowering::visitReturnStmt(ReturnStmt& node) {
+    Value* value = node.getExpr() ? lowerExpr(node.getExpr(), Mode::VALUE) : nullptr;
+    builder.createRet(value);
+}
+
+// 在入口块开头分配变量，全部alloca按声明顺序排在入口块最前面
+Instruction* IRLowering::createAlloca(IRType type, uint32_t count, bool isArray, Symbol name) {
+    IRBuilder entryBuilder(function);
+    Instruction* before = lastAlloca ? lastAlloca->getNext() : function->getEntry()->getFirst();
+    if (before) {
+        entryBuilder.setInsertPoint(before);
+    } else {
+        entryBuilder.setInsertPoint(function->getEntry());
+    }
+    lastAlloca = entryBuilder.createAlloca(type, count, isArray, name);
+    return lastAlloca;
+}
+
+// 登记变量的存储位置，按各维长度算出行优先的步长
+void IRLowering::addStorage(const ASTNode* decl, Value* address, IRType elementType,
+                            const std::vector<uint32_t>& dims) {
+    Storage slot;
+    slot.address = address;
+    slot.elementType = elementType;
+    slot.strideBegin = static_cast<uint32_t>(strides.size());
+    slot.rank = static_cast<uint32_t>(dims.size());
+    strides.resize(strides.size() + dims.size());
+    uint32_t stride = 1;
+    for (size_t i = dims.size(); i-- > 0;) {
+        strides[slot.strideBegin + i] = stride;
+        stride *= dims[i];
+    }
+    (function ? locals : globals)[decl] = slot;
+}
+
+// 变量的存储位置：先查当前函数的局部变量，再查全局变量
+const IRLowering::Storage& IRLowering::storageOf(const ASTNode* decl) {
+    auto found = locals.find(decl);
+    return found != locals.end() ? found->second : globals[decl];
+}
+
+// 数组一维的长度，语义分析已经保证它是非负的整型常量
+uint32_t IRLowering::dimensionOf(Expr* dim) {
+    ConstValue value;
+    if (dim && evaluator.evaluate(dim, value) && value.type == Type::INT && value.intValue > 0) {
+        return static_cast<uint32_t>(value.intValue);
+    }
+    return 0;
+}
+
+// 当前基本块已经结束时，开始一个新的基本块
+void IRLowering::ensureOpenBlock() {
+    if (builder.getBlock()->getTerminator() != nullptr) {
+        builder.setInsertPoint(function->createBlock());
+    }
+}
+
+// 翻译表达式
+Value* IRLowering::lowerExpr(Expr* expr, Mode mode, BasicBlock* trueBlock, BasicBlock* falseBlock) {
+    size_t base = frames.size();
+    frames.push_back({mode, 0, expr, trueBlock, falseBlock, nullptr});
+    while (frames.size() > base) {
+        step();
+    }
+    if (mode == Mode::COND) {
+        return nullptr;
+    }
+    Value* result = values.back();
+    values.pop_back();
+    return result;
+}
+
+// 处理工作栈顶的一项：子表达式尚未翻译时把它们压栈（第一个子表达式在栈顶），否则取出它们的值生成指令
+// 二元运算先只压左操作数，左操作数翻译完再压右操作数，左结合的长链在栈中每层只占一项
+void IRLowering::step() {
+    Frame frame = frames.back();
+    size_t top = frames.size() - 1;
+    if (frame.mode == Mode::COND) {
+        stepCondition(frame);
+        return;
+    }
+    Expr* expr = frame.expr;
+    switch (expr->getKind()) {
+        case NodeKind::INT_LITERAL:
+            frames.pop_back();
+            values.push_back(function->getConstant(cast<NumberExpr>(expr)->getIntValue()));
+            return;
+        case NodeKind::FLOAT_LITERAL:
+            frames.pop_back();
+            values.push_back(function->getConstant(cast<NumberExpr>(expr)->getFloatValue()));
+            return;
+        case NodeKind::VARIABLE_EXPR: {
+            // 数组名的值是首元素的地址
+            const Storage& slot = storageOf(cast<VariableExpr>(expr)->getDecl());
+            frames.pop_back();
+            if (frame.mode == Mode::ADDRESS || slot.rank > 0) {
+                values.push_back(slot.address);
+            } else {
+                values.push_back(builder.createLoad(slot.elementType, slot.address));
+            }
+            return;
+        }
+        case NodeKind::INDEX_EXPR: {
+            IndexExpr& node = *cast<IndexExpr>(expr);
+            size_t begin = indices.size();
+            VariableExpr* array = collectIndices(node);
+            size_t count = indices.size() - begin;
+            if (frame.stage == 0) {
+                frames[top].stage = 1;
+                for (size_t i = indices.size(); i > begin; i--) {
+                    frames.push_back({Mode::VALUE, 0, indices[i - 1], nullptr, nullptr, nullptr});
+                }
+                indices.resize(begin);
+                return;
+            }
+            indices.resize(begin);
+            frames.pop_back();
+            const Storage& slot = storageOf(array->getDecl());
+            bool isElement = false;
+            Value* address = elementAddress(slot, count, isElement);
+            if (frame.mode == Mode::VALUE && isElement) {
+                values.push_back(builder.createLoad(slot.elementType, address));
+            } else {
+                values.push_back(address);
+            }
+            return;
+        }
+        case NodeKind::UNARY_EXPR: {
+            UnaryExpr& node = *cast<UnaryExpr>(expr);
+            if (frame.stage == 0) {
+                frames[top].stage = 1;
+                frames.push_back({Mode::VALUE, 0, node.getOperand(), nullptr, nullptr, nullptr});
+                return;
+            }
+            frames.pop_back();
+            Value* operand = values.back();
+            values.pop_back();
+            if (node.getOp() == TokenType::MINUS) {
+                operand = builder.createNeg(operand);
+            } else if (node.getOp() == TokenType::NOT) {
+                Value* zero = operand->getType() == IRType::F32 ? static_cast<Value*>(function->getConstant(0.0f))
+                                                                 : function->getConstant(0);
+                operand = builder.createCmp(CmpPredicate::EQ, operand, zero);
+            }
+            values.push_back(operand);
+            return;
+        }
+        case NodeKind::CALL_EXPR: {
+            CallExpr& node = *cast<CallExpr>(expr);
+            const NodeList<Expr>& args = node.getArgs();
+            if (frame.stage == 0) {
+                frames[top].stage = 1;
+                for (size_t i = args.size(); i > 0; i--) {
+                    frames.push_back({Mode::VALUE, 0, args[i - 1], nullptr, nullptr, nullptr});
+                }
+                return;
+            }
+            frames.pop_back();
+            size_t first = values.size() - args.size();
+            Instruction* call = builder.createCall(functions[node.getDecl()], values.data() + first, args.size());
+            values.resize(first);
+            values.push_back(call);
+            return;
+        }
+        case NodeKind::BINARY_EXPR: {
+            BinaryExpr& node = *cast<BinaryExpr>(expr);
+            TokenType op = node.getOp();
+            if (op == TokenType::AND || op == TokenType::OR) {
+                // 作为值的逻辑运算：按条件跳转到为真、为假两个块，再在汇合处用φ函数选出1或0
+                if (frame.stage == 0) {
+                    BasicBlock* trueBlock = function->createBlock();
+                    BasicBlock* falseBlock = function->createBlock();
+                    frames[top].stage = 1;
+                    frames[top].trueBlock = trueBlock;
+                    frames[top].falseBlock = falseBlock;
+                    frames.push_back({Mode::COND, 0, expr, trueBlock, falseBlock, nullptr});
+                    return;
+                }
+                frames.pop_back();
+                BasicBlock* mergeBlock = function->createBlock();
+                builder.setInsertPoint(frame.trueBlock);
+                builder.createBr(mergeBlock);
+                builder.setInsertPoint(frame.falseBlock);
+                builder.createBr(mergeBlock);
+                builder.setInsertPoint(mergeBlock);
+                Instruction* phi = builder.createPhi(IRType::I32, 2);
+                phi->addIncoming(function->getConstant(1), frame.trueBlock, function->getArena());
+                phi->addIncoming(function->getConstant(0), frame.falseBlock, function->getArena());
+                values.push_back(phi);
+                return;
+            }
+            if (frame.stage == 0) {
+                // 赋值先求左侧的地址，再求右侧的值
+                frames[top].stage = 1;
+                Mode leftMode = op == TokenType::ASSIGN ? Mode::ADDRESS : Mode::VALUE;
+                frames.push_back({leftMode, 0, node.getLeft(), nullptr, nullptr, nullptr});
+                return;
+            }
+            if (frame.stage == 1) {
+                frames[top].stage = 2;
+                frames.push_back({Mode::VALUE, 0, node.getRight(), nullptr, nullptr, nullptr});
+                return;
+            }
+            frames.pop_back();
+            Value* right = values.back();
+            values.pop_back();
+            Value* left = values.back();
+            values.pop_back();
+            values.push_back(lowerBinary(op, left, right));
+            return;
+        }
+        default:
+            frames.pop_back();
+            values.push_back(function->getConstant(0));
+            return;
+    }
+}
+
+// 翻译条件
+void IRLowering::stepCondition(Frame frame) {
+    size_t top = frames.size() - 1;
+    Expr* expr = frame.expr;
+    if (BinaryExpr* binary = dyn_cast<BinaryExpr>(expr)) {
+        TokenType op = binary->getOp();
+        if (op == TokenType::AND || op == TokenType::OR) {
+            // a && b：a为真时才计算b；a || b：a为假时才计算b
+            if (frame.stage == 0) {
+                BasicBlock* rightBlock = function->createBlock();
+                frames[top].stage = 1;
+                frames[top].rightBlock = rightBlock;
+                if (op == TokenType::AND) {
+                    frames.push_back({Mode::COND, 0, binary->getLeft(), rightBlock, frame.falseBlock, nullptr});
+                } else {
+                    frames.push_back({Mode::COND, 0, binary->getLeft(), frame.trueBlock, rightBlock, nullptr});
+                }
+                return;
+            }
+            builder.setInsertPoint(frame.rightBlock);
+            frames[top] = {Mode::COND, 0, binary->getRight(), frame.trueBlock, frame.falseBlock, nullptr};
+            return;
+        }
+    }
+    if (UnaryExpr* unary = dyn_cast<UnaryExpr>(expr)) {
+        if (unary->getOp() == TokenType::NOT) {
+            frames[top] = {Mode::COND, 0, unary->getOperand(), frame.falseBlock, frame.trueBlock, nullptr};
+            return;
+        }
+    }
+    if (frame.stage == 0) {
+        frames[top].stage = 1;
+        frames.push_back({Mode::VALUE, 0, expr, nullptr, nullptr, nullptr});
+        return;
+    }
+    frames.pop_back();
+    Value* condition = values.back();
+    values.pop_back();
+    // 常量条件直接跳转，不可达的分支在函数翻译结束时删除
+    if (Constant* constant = dyn_cast<Constant>(condition)) {
+        bool isTrue = constant->getType() == IRType::F32 ? constant->getFloatValue() != 0.0f
+                                                          : constant->getIntValue() != 0;
+        builder.createBr(isTrue ? frame.trueBlock : frame.falseBlock);
+        return;
+    }
+    if (condition->getType() == IRType::F32) {
+        condition = builder.createCmp(CmpPredicate::NE, condition, function->getConstant(0.0f));
+    }
+    builder.createCondBr(condition, frame.trueBlock, frame.falseBlock);
+}
+
+// 二元运算：操作数类型相同（语义分析保证），按类型选择整数或浮点运算
+Value* IRLowering::lowerBinary(TokenType op, Value* left, Value* right) {
+    bool isFloat = left->getType() == IRType::F32;
+    switch (op) {
+        case TokenType::ASSIGN:
+            builder.createStore(right, left);
+            return right;
+        case TokenType::PLUS: return builder.createBinary(isFloat ? Opcode::FADD : Opcode::ADD, left, right);
+        case TokenType::MINUS: return builder.createBinary(isFloat ? Opcode::FSUB : Opcode::SUB, left, right);
+        case TokenType::MUL: return builder.createBinary(isFloat ? Opcode::FMUL : Opcode::MUL, left, right);
+        case TokenType::DIV: return builder.createBinary(isFloat ? Opcode::FDIV : Opcode::SDIV, left, right);
+        case TokenType::MOD: return builder.createBinary(isFloat ? Opcode::FREM : Opcode::SREM, left, right);
+        case TokenType::EQ: return builder.createCmp(CmpPredicate::EQ, left, right);
+        case TokenType::NE: return builder.createCmp(CmpPredicate::NE, left, right);
+        case TokenType::LT: return builder.createCmp(CmpPredicate::LT, left, right);
+        case TokenType::GT: return builder.createCmp(CmpPredicate::GT, left, right);
+        case TokenType::LE: return builder.createCmp(CmpPredicate::LE, left, right);
+        case TokenType::GE: return builder.createCmp(CmpPredicate::GE, left, right);
+        default: return left;
+    }
+}
+
+// 收集数组下标：a[i][j]是以a[i]为基址的下标表达式，沿基址向内收集后反转为源代码顺序
+VariableExpr* IRLowering::collectIndices(IndexExpr& node) {
+    size_t begin = indices.size();
+    Expr* current = &node;
+    while (IndexExpr* index = dyn_cast<IndexExpr>(current)) {
+        indices.push_back(index->getIndex());
+        current = index->getBase();
+    }
+    std::reverse(indices.begin() + static_cast<std::ptrdiff_t>(begin), indices.end());
+    return cast<VariableExpr>(current);
+}
+
+// 下标的乘法和加法
+Value* IRLowering::combineIndex(Opcode opcode, Value* left, Value* right) {
+    Constant* leftConstant = dyn_cast<Constant>(left);
+    Constant* rightConstant = dyn_cast<Constant>(right);
+    if (leftConstant && rightConstant) {
+        uint32_t a = static_cast<uint32_t>(leftConstant->getIntValue());
+        uint32_t b = static_cast<uint32_t>(rightConstant->getIntValue());
+        return function->getConstant(static_cast<int>(opcode == Opcode::MUL ? a * b : a + b));
+    }
+    return builder.createBinary(opcode, left, right);
+}
+
+// 计算元素地址：线性下标为各维下标乘以该维步长之和
+Value* IRLowering::elementAddress(const Storage& slot, size_t indexCount, bool& isElement) {
+    size_t first = values.size() - indexCount;
+    Value* linear = nullptr;
+    for (size_t i = 0; i < indexCount; i++) {
+        Value* term = values[first + i];
+        uint32_t stride = i < slot.rank ? strides[slot.strideBegin + i] : 1;
+        if (stride != 1) {
+            term = combineIndex(Opcode::MUL, term, function->getConstant(static_cast<int>(stride)));
+        }
+        linear = linear ? combineIndex(Opcode::ADD, linear, term) : term;
+    }
+    values.resize(first);
+    isElement = indexCount >= slot.rank;
+    return builder.createGep(slot.address, linear);
+}
+
+// 函数翻译结束：从入口块出发做深度优先遍历，可达的基本块按逆后序排列，其余删除
+void IRLowering::finishFunction() {
+    function->renumberBlocks();
+    std::vector<uint8_t> visited(function->getBlockCount(), 0);
+    std::vector<std::pair<BasicBlock*, uint32_t>> stack;
+    std::vector<BasicBlock*> order;
+    stack.push_back({function->getEntry(), 0});
+    visited[function->getEntry()->getIndex()] = 1;
+    while (!stack.empty()) {
+        BasicBlock* block = stack.back().first;
+        uint32_t next = stack.back().second;
+        uint32_t count = block->getSuccessorCount();
+        if (next < count) {
+            // 后继按从后往前的顺序访问，逆后序中第一个后继（then块、循环体）排在前面
+            stack.back().second++;
+            BasicBlock* successor = block->getSuccessor(count - 1 - next);
+            if (!visited[successor->getIndex()]) {
+                visited[successor->getIndex()] = 1;
+                stack.push_back({successor, 0});
+            }
+            continue;
+        }
+        order.push_back(block);
+        stack.pop_back();
+    }
+    std::reverse(order.begin(), order.end());
+    function->reorderBlocks(order);
+}
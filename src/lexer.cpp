@@ -1,6 +1,12 @@
 #include "../include/token.h"
 #include "../include/Lexer.h"
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <cstdlib>
 #include <cstring>
@@ -8,8 +14,10 @@
 
 // 词法分析器构造函数
 // 初始化词法分析器的状态，包括源代码、当前位置、行号和列号
-Lexer::Lexer(const std::string& source) 
-    : source(source), position(0), line(1), column(1) {
+Lexer::Lexer(std::string_view source, size_t firstLine) 
+    : source(source), position(0), line(firstLine), column(1),
+      kernels(&ScanKernels::get(ScanKernels::bestAvailable())), interner(&StringInterner::global()),
+      lookaheadHead(0), lookaheadCount(0) {
     if (!source.empty()) {
         currentChar = source[position];
     } else {
@@ -29,161 +37,419 @@ void Lexer::advance() {
     }
 }
 
+// 预览下一个字符
+// 越过源代码末尾时返回'\0'
+char Lexer::peek() {
+    return position + 1 < source.size() ? source[position + 1] : '\0';
+}
+
+// 移动到指定位置
+// 批量扫描内核返回后调用，根据扫描中遇到的换行更新行号和列号
+void Lexer::moveTo(size_t newPosition, const ScanLines& lines) {
+    if (lines.count > 0) {
+        line += lines.count;
+        column = newPosition - (position + lines.lastNewline);
+    } else {
+        column += newPosition - position;
+    }
+    position = newPosition;
+    currentChar = position < source.size() ? source[position] : '\0';
+}
+
 // 跳过空白字符
 // 处理空格、制表符、换行符等空白字符，并更新行号和列号
 void Lexer::skipWhitespace() {
-    while (currentChar != '\0' && isspace(currentChar)) {
-        if (currentChar == '\n') {
-            line++;
-            column = 1;
+    ScanLines lines;
+    size_t length = kernels->skipWhitespace(source.data() + position, source.size() - position, lines);
+    moveTo(position + length, lines);
+}
+
+// 跳过注释
+// 处理连续出现的空白字符、单行注释和多行注释，停在下一个Token的首字符上
+void Lexer::skipComment() {
+    while (true) {
+        skipWhitespace();
+        if (currentChar != '/') {
+            return;
+        }
+        
+        char next = peek();
+        if (next == '/') {
+            // 单行注释：停在行尾的换行符上，换行由下一轮skipWhitespace处理
+            size_t length = kernels->findLineEnd(source.data() + position, source.size() - position);
+            moveTo(position + length, ScanLines());
+        } else if (next == '*') {
+            // 多行注释：跳过"/*"后查找"*/"，未闭合时停在源代码末尾
+            ScanLines lines;
+            size_t bodyStart = position + 2;
+            size_t length = kernels->findBlockCommentEnd(source.data() + bodyStart, source.size() - bodyStart, lines);
+            lines.lastNewline += 2;
+            moveTo(bodyStart + length, lines);
         } else {
-            column++;
+            return;
         }
-        advance();
     }
 }
 
 // 解析数字常量
-// 处理整数和浮点数常量，并返回相应的Token对象
+// 由scanNumber直接在源代码上识别常量，只有非法常量需要构造错误信息
 Token Lexer::parseNumber() {
     Token token;
-    token.type = TokenType::INT_CONST;
     token.line = line;
-    token.valueType = Token::ValueType::INT_VAL;
     
-    std::string numStr;
+    size_t start = position; // 常量原文的起始位置
+    NumberLiteral literal = scanNumber(source.data() + position, source.size() - position);
+    moveTo(position + literal.length, ScanLines());
     
-    // 检查是否是八进制数（以0开头，后面跟0-7的数字）
-    if (currentChar == '0') {
-        numStr += currentChar;
-        advance();
-        
-        // 检查八进制数是否包含非法字符（8-9）
-        while (currentChar != '\0' && isdigit(currentChar)) {
-            if (currentChar >= '8') {
-                // 非法八进制数
-                token.type = TokenType::UNKNOWN;
-                // 保存完整的错误数值（包括所有已解析的部分和非法字符）
-                numStr += currentChar;
-                token.errorMessage = "illegal octal number '" + numStr + "'";
-                advance();
-                return token;
+    token.setType(literal.type);
+    if (literal.type == TokenType::UNKNOWN) {
+        // 保存完整的错误数值（包括所有已解析的部分和非法字符）
+        setError(token, std::string(literal.error) + " '" + std::string(source.substr(start, literal.length)) + "'");
+    } else if (literal.type == TokenType::FLOAT_CONST) {
+        token.floatValue = literal.floatValue;
+    } else {
+        token.intValue = literal.intValue;
+    }
+    
+    finishToken(token, start);
+    return token;
+}
+
+namespace {
+
+// 关键字表项
+struct KeywordEntry {
+    std::string_view text;               // 关键字原文
+    TokenType type = TokenType::IDENT;   // 对应的Token类型
+};
+
+// SysY的全部关键字
+constexpr KeywordEntry KEYWORDS[] = {
+    {"int", TokenType::INT},       {"float", TokenType::FLOAT},   {"void", TokenType::VOID},
+    {"const", TokenType::CONST},   {"if", TokenType::IF},         {"else", TokenType::ELSE},
+    {"while", TokenType::WHILE},   {"break", TokenType::BREAK},   {"continue", TokenType::CONTINUE},
+    {"return", TokenType::RETURN},
+};
+
+constexpr size_t KEYWORD_TABLE_SIZE = 16;
+constexpr size_t KEYWORD_MIN_LENGTH = 2;
+constexpr size_t KEYWORD_MAX_LENGTH = 8;
+
+// 关键字完美哈希：由首字符、末字符和长度计算，对上面的关键字集合没有冲突
+constexpr size_t keywordHash(std::string_view word) {
+    return (static_cast<unsigned char>(word.front()) * 5u +
+            static_cast<unsigned char>(word.back()) + word.size()) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+// 在编译期生成哈希表，空槽位的text为空，不会与任何候选匹配
+constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> buildKeywordTable() {
+    std::array<KeywordEntry, KEYWORD_TABLE_SIZE> table{};
+    for (const auto& keyword : KEYWORDS) {
+        table[keywordHash(keyword.text)] = keyword;
+    }
+    return table;
+}
+
+constexpr auto KEYWORD_TABLE = buildKeywordTable();
+
+// 编译期检查哈希确实无冲突（每个关键字都留在了自己的槽位中）
+constexpr bool keywordHashIsPerfect() {
+    for (const auto& keyword : KEYWORDS) {
+        if (KEYWORD_TABLE[keywordHash(keyword.text)].text != keyword.text) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(keywordHashIsPerfect(), "keyword hash has collisions, adjust keywordHash()");
+
+} // namespace
+
+// 关键字分类
+// 长度不在关键字范围内的直接判为标识符，否则查完美哈希表，只与唯一的候选关键字比较一次
+// 空槽位的text长度为0，不会与任何候选单词匹配
+TokenType Lexer::classifyKeyword(std::string_view word) {
+    if (word.size() < KEYWORD_MIN_LENGTH || word.size() > KEYWORD_MAX_LENGTH) {
+        return TokenType::IDENT;
+    }
+    const KeywordEntry& entry = KEYWORD_TABLE[keywordHash(word)];
+    if (entry.text.size() != word.size() || std::memcmp(entry.text.data(), word.data(), word.size()) != 0) {
+        return TokenType::IDENT;
+    }
+    return entry.type;
+}
+
+namespace {
+
+// 判断是否为十进制数字
+inline bool isDecimalDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// 判断是否为十六进制数字
+inline bool isHexDigit(char c) {
+    return isDecimalDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// 十六进制数字的值
+inline uint32_t hexDigitValue(char c) {
+    if (isDecimalDigit(c)) {
+        return c - '0';
+    }
+    return (c | 0x20) - 'a' + 10;
+}
+
+// 判断十六进制整数之后的字符是否合法：源代码结束、空白、运算符或分隔符
+inline bool canFollowHex(char c) {
+    return c == '\0' || isspace(static_cast<unsigned char>(c)) || strchr("+-*/=<>!;(),[]{} ", c) != nullptr;
+}
+
+// 构造非法常量的扫描结果
+Lexer::NumberLiteral illegalNumber(size_t length, const char* error) {
+    Lexer::NumberLiteral literal;
+    literal.type = TokenType::UNKNOWN;
+    literal.length = length;
+    literal.intValue = 0;
+    literal.error = error;
+    return literal;
+}
+
+// 构造整数常量的扫描结果，value超出32位时按溢出处理
+Lexer::NumberLiteral intNumber(size_t length, uint64_t value, uint64_t limit) {
+    if (value > limit) {
+        return illegalNumber(length, "integer constant out of range");
+    }
+    Lexer::NumberLiteral literal;
+    literal.type = TokenType::INT_CONST;
+    literal.length = length;
+    literal.intValue = static_cast<int>(static_cast<uint32_t>(value));
+    literal.error = nullptr;
+    return literal;
+}
+
+// 判断超出double范围的浮点数是下溢（数量级为负）还是上溢，digits指向有效数字（十六进制跳过0x前缀）
+// 数量级 = 第一个非零数字相对小数点的位置 + 指数；十六进制每位数字占4个二进制位，指数以2为底
+bool floatUnderflows(const char* digits, const char* end, bool hex) {
+    long magnitude = 0;
+    bool seenPoint = false;
+    bool seenNonZero = false;
+    const char* p = digits;
+    for (; p < end && ((hex ? isHexDigit(*p) : isDecimalDigit(*p)) || *p == '.'); ++p) {
+        if (*p == '.') {
+            seenPoint = true;
+        } else if (!seenNonZero) {
+            if (*p != '0') {
+                seenNonZero = true;
+                magnitude = seenPoint ? magnitude - 1 : 0;
+            } else if (seenPoint) {
+                magnitude--;
             }
-            numStr += currentChar;
-            advance();
+        } else if (!seenPoint) {
+            magnitude++;
+        }
+    }
+    long exponent = 0;
+    bool negative = false;
+    if (p < end && (hex ? (*p == 'p' || *p == 'P') : (*p == 'e' || *p == 'E'))) {
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negative = *p == '-';
+            ++p;
         }
+        for (; p < end && exponent < 100000; ++p) {
+            exponent = exponent * 10 + (*p - '0');
+        }
+    }
+    return magnitude * (hex ? 4 : 1) + (negative ? -exponent : exponent) < 0;
+}
+
+// 构造浮点常量的扫描结果：按double解析后再转换为float，与atof一致
+// 十进制和十六进制写法一样：下溢时取0，上溢时按非法常量处理
+Lexer::NumberLiteral floatNumber(const char* text, size_t length, bool hex) {
+    double value = 0.0;
+    const char* begin = hex ? text + 2 : text;
+    auto result = std::from_chars(begin, text + length, value,
+                                  hex ? std::chars_format::hex : std::chars_format::general);
+    if (result.ec == std::errc::result_out_of_range) {
+        if (!floatUnderflows(begin, text + length, hex)) {
+            return illegalNumber(length, "floating constant out of range");
+        }
+        value = 0.0;
+    } else if (result.ec != std::errc() || result.ptr != text + length) {
+        return illegalNumber(length, hex ? "illegal hexadecimal number" : "illegal floating constant");
+    }
+    if (std::fabs(value) > std::numeric_limits<float>::max()) {
+        return illegalNumber(length, "floating constant out of range");
+    }
+    
+    Lexer::NumberLiteral literal;
+    literal.type = TokenType::FLOAT_CONST;
+    literal.length = length;
+    literal.floatValue = static_cast<float>(value);
+    literal.error = nullptr;
+    return literal;
+}
+
+} // namespace
+
+// 扫描数字常量
+// 整数在扫描的同时用64位累加器求值，超过32位即记为溢出，浮点数用std::from_chars转换
+Lexer::NumberLiteral Lexer::scanNumber(const char* text, size_t size) {
+    auto at = [&](size_t index) { return index < size ? text[index] : '\0'; };
+    size_t i = 0;
+    
+    // 十六进制：0x后跟十六进制数字，带小数点或p指数时为十六进制浮点数
+    if (at(0) == '0' && (at(1) == 'x' || at(1) == 'X')) {
+        i = 2;
+        uint64_t value = 0;
+        while (isHexDigit(at(i))) {
+            value = std::min<uint64_t>(value * 16 + hexDigitValue(at(i)), UINT64_MAX / 16);
+            i++;
+        }
+        size_t intDigits = i - 2;
         
-        // 检查是否是十六进制数（以0x或0X开头）
-        if ((currentChar == 'x' || currentChar == 'X') && numStr == "0") {
-            numStr += currentChar;
-            advance();
-            
-            // 检查十六进制数是否包含非法字符（不是0-9、a-f、A-F）
-            while (currentChar != '\0' && 
-                   (isdigit(currentChar) || 
-                    (currentChar >= 'a' && currentChar <= 'f') || 
-                    (currentChar >= 'A' && currentChar <= 'F'))) {
-                numStr += currentChar;
-                advance();
+        if (at(i) == '.' || at(i) == 'p' || at(i) == 'P') {
+            size_t fracDigits = 0;
+            if (at(i) == '.') {
+                i++;
+                while (isHexDigit(at(i))) {
+                    i++;
+                    fracDigits++;
+                }
             }
-            
-            // 如果十六进制数后面跟的不是有效的十六进制字符，说明是非法十六进制数
-            if (currentChar != '\0' && 
-                !isdigit(currentChar) && 
-                !(currentChar >= 'a' && currentChar <= 'f') && 
-                !(currentChar >= 'A' && currentChar <= 'F') && 
-                !isspace(currentChar) && 
-                !strchr("+-*/=<>!;(),[]{} ", currentChar)) {
-                // 非法十六进制数
-                token.type = TokenType::UNKNOWN;
-                // 保存完整的错误数值（包括所有已解析的部分和非法字符）
-                numStr += currentChar;
-                token.errorMessage = "illegal hexadecimal number '" + numStr + "'";
-                advance();
-                return token;
+            // 十六进制浮点数必须有数字和p指数
+            if (intDigits + fracDigits == 0 || (at(i) != 'p' && at(i) != 'P')) {
+                return illegalNumber(i, "illegal hexadecimal number");
             }
-            
-            token.intValue = std::stoi(numStr, nullptr, 16);
-        } else {
-            token.intValue = std::stoi(numStr, nullptr, 8);
-        }
-    } else {
-        // 十进制数
-        while (currentChar != '\0' && isdigit(currentChar)) {
-            numStr += currentChar;
-            advance();
+            i++;
+            if (at(i) == '+' || at(i) == '-') {
+                i++;
+            }
+            if (!isDecimalDigit(at(i))) {
+                return illegalNumber(i, "illegal hexadecimal number");
+            }
+            while (isDecimalDigit(at(i))) {
+                i++;
+            }
+            return floatNumber(text, i, true);
         }
         
-        // 检查是否是浮点数
-        if (currentChar == '.') {
-            token.type = TokenType::FLOAT_CONST;
-            token.valueType = Token::ValueType::FLOAT_VAL;
-            numStr += '.';
-            advance();
-            
-            while (currentChar != '\0' && isdigit(currentChar)) {
-                numStr += currentChar;
-                advance();
+        // 十六进制整数后面跟的不是有效字符，说明是非法十六进制数（包括该字符）
+        if (!canFollowHex(at(i))) {
+            return illegalNumber(i + 1, "illegal hexadecimal number");
+        }
+        if (intDigits == 0) {
+            return illegalNumber(i, "illegal hexadecimal number");
+        }
+        return intNumber(i, value, UINT32_MAX);
+    }
+    
+    // 十进制浮点数：数字序列后跟小数点或指数（".5"、"1."、"1e5"、"1.5e-3"）
+    while (isDecimalDigit(at(i))) {
+        i++;
+    }
+    size_t intEnd = i;
+    bool isFloat = false;
+    if (at(i) == '.') {
+        isFloat = true;
+        i++;
+        while (isDecimalDigit(at(i))) {
+            i++;
+        }
+    }
+    if (at(i) == 'e' || at(i) == 'E') {
+        // 只有完整的指数才属于常量，否则指数标记留给后面的Token
+        size_t k = i + 1;
+        if (at(k) == '+' || at(k) == '-') {
+            k++;
+        }
+        if (isDecimalDigit(at(k))) {
+            isFloat = true;
+            while (isDecimalDigit(at(k))) {
+                k++;
             }
-            
-            token.floatValue = atof(numStr.c_str());
-        } else {
-            token.intValue = atoi(numStr.c_str());
+            i = k;
+        }
+    }
+    if (isFloat) {
+        return floatNumber(text, i, false);
+    }
+    
+    // 八进制整数：以0开头，出现8或9时到该数字为止按非法八进制数处理
+    uint64_t value = 0;
+    if (at(0) == '0') {
+        for (size_t k = 1; k < intEnd; ++k) {
+            if (at(k) >= '8') {
+                return illegalNumber(k + 1, "illegal octal number");
+            }
+            value = std::min<uint64_t>(value * 8 + (at(k) - '0'), UINT64_MAX / 16);
         }
+        return intNumber(intEnd, value, UINT32_MAX);
     }
     
-    return token;
+    // 十进制整数：允许2147483648，以便表示-2147483648
+    for (size_t k = 0; k < intEnd; ++k) {
+        value = std::min<uint64_t>(value * 10 + (at(k) - '0'), UINT64_MAX / 16);
+    }
+    return intNumber(intEnd, value, static_cast<uint64_t>(INT32_MAX) + 1);
 }
 
 // 解析标识符或关键字
 // 处理标识符（变量名、函数名等），并检查是否是关键字
 Token Lexer::parseIdentifier() {
     Token token;
-    token.type = TokenType::IDENT;
     token.line = line;
-    token.valueType = Token::ValueType::STRING_VAL;
     
-    std::string idStr;
-    while (currentChar != '\0' && (isalnum(currentChar) || currentChar == '_')) {
-        idStr += currentChar;
-        advance();
-    }
+    // 标识符直接引用源代码中的原文，不逐字符复制
+    size_t start = position;
+    size_t length = kernels->scanIdentifier(source.data() + position, source.size() - position);
+    moveTo(position + length, ScanLines());
     
-    token.stringValue = idStr;
+    std::string_view idStr = source.substr(start, position - start);
     
     // 检查是否是关键字
-    if (idStr == "int") {
-        token.type = TokenType::INT;
-    } else if (idStr == "float") {
-        token.type = TokenType::FLOAT;
-    } else if (idStr == "void") {
-        token.type = TokenType::VOID;
-    } else if (idStr == "if") {
-        token.type = TokenType::IF;
-    } else if (idStr == "else") {
-        token.type = TokenType::ELSE;
-    } else if (idStr == "while") {
-        token.type = TokenType::WHILE;
-    } else if (idStr == "return") {
-        token.type = TokenType::RETURN;
+    token.setType(classifyKeyword(idStr));
+    if (token.type() == TokenType::IDENT) {
+        // 普通标识符：在词法分析阶段驻留，后续阶段只比较编号
+        token.symbol = interner->intern(idStr);
     }
     
+    finishToken(token, start);
     return token;
 }
 
+// 选择批量扫描内核的指令集级别
+void Lexer::setScanIsa(ScanIsa isa) {
+    kernels = &ScanKernels::get(isa);
+}
+
 // 获取下一个Token
-// 跳过空白字符，然后根据当前字符类型调用相应的解析函数
+// 优先从预览窗口中取出已扫描的Token，窗口为空时再扫描源代码
 Token Lexer::getNextToken() {
-    skipWhitespace();
+    if (lookaheadCount > 0) {
+        Token token = std::move(lookahead[lookaheadHead]);
+        lookaheadHead = (lookaheadHead + 1) % MAX_LOOKAHEAD;
+        lookaheadCount--;
+        return token;
+    }
+    
+    return scanToken();
+}
+
+// 扫描下一个Token
+// 跳过空白字符，然后根据当前字符类型调用相应的解析函数
+Token Lexer::scanToken() {
+    skipComment();
     
     if (currentChar == '\0') {
         Token token;
-        token.type = TokenType::END_OF_FILE;
+        token.setType(TokenType::END_OF_FILE);
         token.line = line;
+        finishToken(token, position);
         return token;
     }
     
-    if (isdigit(currentChar)) {
+    if (isdigit(currentChar) || (currentChar == '.' && isdigit(peek()))) {
         return parseNumber();
     }
     
@@ -194,153 +460,191 @@ Token Lexer::getNextToken() {
     // 处理运算符和分隔符
     Token token;
     token.line = line;
+    size_t start = position;
     
     switch (currentChar) {
         case '=':
             advance();
             if (currentChar == '=') {
-                token.type = TokenType::EQ; // 等于运算符
+                token.setType(TokenType::EQ); // 等于运算符
                 advance();
             } else {
-                token.type = TokenType::ASSIGN; // 赋值运算符
+                token.setType(TokenType::ASSIGN); // 赋值运算符
             }
             break;
         case '+':
-            token.type = TokenType::PLUS; // 加法运算符
+            token.setType(TokenType::PLUS); // 加法运算符
             advance();
             break;
         case '-':
-            token.type = TokenType::MINUS; // 减法运算符
+            token.setType(TokenType::MINUS); // 减法运算符
             advance();
             break;
         case '*':
-            token.type = TokenType::MUL; // 乘法运算符
+            token.setType(TokenType::MUL); // 乘法运算符
             advance();
             break;
         case '/':
+            token.setType(TokenType::DIV); // 除法运算符（注释已在skipComment中跳过）
             advance();
-            if (currentChar == '/') {
-                // 处理单行注释
-                while (currentChar != '\0' && currentChar != '\n') {
-                    advance();
-                }
-                return getNextToken(); // 注释处理完后继续获取下一个Token
-            } else if (currentChar == '*') {
-                // 处理多行注释
-                advance();
-                while (currentChar != '\0') {
-                    if (currentChar == '*' && source[position + 1] == '/') {
-                        advance();
-                        advance();
-                        break; // 找到注释结束符
-                    }
-                    if (currentChar == '\n') {
-                        line++;
-                        column = 1;
-                    }
-                    advance();
-                }
-                return getNextToken(); // 注释处理完后继续获取下一个Token
-            } else {
-                token.type = TokenType::DIV; // 除法运算符
-            }
             break;
         case '<':
             advance();
             if (currentChar == '=') {
-                token.type = TokenType::LE; // 小于等于运算符
+                token.setType(TokenType::LE); // 小于等于运算符
                 advance();
             } else {
-                token.type = TokenType::LT; // 小于运算符
+                token.setType(TokenType::LT); // 小于运算符
             }
             break;
         case '>':
             advance();
             if (currentChar == '=') {
-                token.type = TokenType::GE; // 大于等于运算符
+                token.setType(TokenType::GE); // 大于等于运算符
                 advance();
             } else {
-                token.type = TokenType::GT; // 大于运算符
+                token.setType(TokenType::GT); // 大于运算符
             }
             break;
+        case '%':
+            token.setType(TokenType::MOD); // 取模运算符
+            advance();
+            break;
         case '!':
             advance();
             if (currentChar == '=') {
-                token.type = TokenType::NE; // 不等于运算符
+                token.setType(TokenType::NE); // 不等于运算符
+                advance();
+            } else {
+                token.setType(TokenType::NOT); // 逻辑非运算符
+            }
+            break;
+        case '&':
+            advance();
+            if (currentChar == '&') {
+                token.setType(TokenType::AND); // 逻辑与运算符
                 advance();
             } else {
-                token.type = TokenType::UNKNOWN; // 无效的Token
-                token.errorMessage = "Invalid character '!'";
-                advance(); // 前进到下一个字符，避免无限循环
+                setError(token, "Invalid character '&'"); // 单独的'&'不是SysY的运算符
+            }
+            break;
+        case '|':
+            advance();
+            if (currentChar == '|') {
+                token.setType(TokenType::OR); // 逻辑或运算符
+                advance();
+            } else {
+                setError(token, "Invalid character '|'"); // 单独的'|'不是SysY的运算符
             }
             break;
         case ';':
-            token.type = TokenType::SEMICOLON; // 分号分隔符
+            token.setType(TokenType::SEMICOLON); // 分号分隔符
             advance();
             break;
         case ',':
-            token.type = TokenType::COMMA; // 逗号分隔符
+            token.setType(TokenType::COMMA); // 逗号分隔符
             advance();
             break;
         case '(':
-            token.type = TokenType::LPAREN; // 左括号
+            token.setType(TokenType::LPAREN); // 左括号
             advance();
             break;
         case ')':
-            token.type = TokenType::RPAREN; // 右括号
+            token.setType(TokenType::RPAREN); // 右括号
             advance();
             break;
         case '[':
-            token.type = TokenType::LBRACKET; // 左方括号
+            token.setType(TokenType::LBRACKET); // 左方括号
             advance();
             break;
         case ']':
-            token.type = TokenType::RBRACKET; // 右方括号
+            token.setType(TokenType::RBRACKET); // 右方括号
             advance();
             break;
         case '{':
-            token.type = TokenType::LBRACE; // 左花括号
+            token.setType(TokenType::LBRACE); // 左花括号
             advance();
             break;
         case '}':
-            token.type = TokenType::RBRACE; // 右花括号
+            token.setType(TokenType::RBRACE); // 右花括号
             advance();
             break;
         default:
-            token.type = TokenType::UNKNOWN; // 无效的Token
-            token.errorMessage = "Invalid character '" + std::string(1, currentChar) + "'";
+            setError(token, "Invalid character '" + std::string(1, currentChar) + "'"); // 无效的Token
             advance(); // 前进到下一个字符，避免无限循环
     }
     
+    finishToken(token, start);
     return token;
 }
 
-// 预取下一个Token（不改变词法分析器状态）
-// 保存当前状态，获取下一个Token，然后恢复状态
-Token Lexer::peekToken() {
+// 一次性扫描全部源代码
+// 循环获取Token直到文件结束，结果缓冲区同时用于Token输出和语法分析，避免重复词法分析
+TokenStream Lexer::tokenize() {
+    TokenStream tokens(source);
+    tokens.reserve(source.size() / 4 + 1);
+    
+    while (true) {
+        Token token = getNextToken();
+        if (token.type() == TokenType::UNKNOWN) {
+            tokens.push(token, getErrorMessage(token));
+        } else {
+            tokens.push(token);
+        }
+        if (token.type() == TokenType::END_OF_FILE) {
+            break;
+        }
+    }
+    
+    return tokens;
+}
+
+// 记录词法错误
+// 把Token标记为UNKNOWN，错误信息存入旁路表，Token中只保存表中的下标
+void Lexer::setError(Token& token, std::string message) {
+    token.setType(TokenType::UNKNOWN);
+    token.errorIndex = static_cast<uint32_t>(errorMessages.size());
+    errorMessages.push_back(std::move(message));
+}
+
+// 补全Token的原文位置
+// 原文长度或偏移超过Token能表示的上限时，整个Token按错误处理
+void Lexer::finishToken(Token& token, size_t start) {
+    size_t length = position - start;
+    if (start > UINT32_MAX) {
+        setError(token, "source file too large");
+        length = 0;
+        start = 0;
+    } else if (length > Token::MAX_LENGTH) {
+        setError(token, "token too long");
+        length = 0;
+    }
+    token.offset = static_cast<uint32_t>(start);
+    token.setLength(static_cast<uint32_t>(length));
+}
+
+// 获取UNKNOWN Token的错误信息
+const std::string& Lexer::getErrorMessage(const Token& token) const {
+    return errorMessages.at(token.errorIndex);
+}
+
+// 预取下一个Token（不消耗Token）
+const Token& Lexer::peekToken() {
     return peekToken(1);
 }
 
-// 预取第n个Token（不改变词法分析器状态）
-// 保存当前状态，循环获取n个Token，然后恢复状态
-Token Lexer::peekToken(int n) {
-    // 保存当前的lexer状态
-    size_t savedPosition = position;
-    size_t savedLine = line;
-    size_t savedColumn = column;
-    char savedCurrentChar = currentChar;
-    
-    // 获取第n个token
-    Token token;
-    for (int i = 0; i < n; ++i) {
-        token = getNextToken();
+// 预取第n个Token（不消耗Token）
+// 窗口中不足n个Token时才继续扫描，已扫描的Token不会被重新扫描
+const Token& Lexer::peekToken(int n) {
+    if (n < 1 || static_cast<size_t>(n) > MAX_LOOKAHEAD) {
+        throw std::out_of_range("peekToken: lookahead " + std::to_string(n) +
+                                " exceeds window size " + std::to_string(MAX_LOOKAHEAD));
     }
     
-    // 恢复lexer状态
-    position = savedPosition;
-    line = savedLine;
-    column = savedColumn;
-    currentChar = savedCurrentChar;
+    while (lookaheadCount < static_cast<size_t>(n)) {
+        lookahead[(lookaheadHead + lookaheadCount) % MAX_LOOKAHEAD] = scanToken();
+        lookaheadCount++;
+    }
     
-    return token;
-}
\ No newline at end of file
+    return lookahead[(lookaheadHead + n - 1) % MAX_LOOKAHEAD];
+}
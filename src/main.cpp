@@ -1,118 +1,285 @@
-#include <iostream>
 #include <fstream>
+#include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "../include/source_buffer.h"
 #include "../include/Lexer.h"
+#include "../include/streaming_lexer.h"
+#include "../include/parallel_lexer.h"
+#ifdef SYSY_HAVE_FLEX
+#include "../include/flex_scanner.h"
+#endif
 #include "../include/Parser.h"
+#include "../include/flat_ast.h"
 #include "../include/semantic_analyzer.h"
+#include "../include/const_eval.h"
+#include "../include/ir_lowering.h"
+#include "../include/passes.h"
 #include "../include/print_visitor.h"
+#include "../include/diagnostics.h"
+
+// 流式扫描一遍输入
+// 参数：input - 输入流
+//       printTokens - 是否输出词法单元列表
+//       printErrors - 是否输出词法错误
+// 返回：是否遇到词法错误
+static bool streamTokens(std::istream& input, bool printTokens, bool printErrors) {
+    StreamingLexer lexer(input);
+    bool hasError = false;
+    while (true) {
+        Token token = lexer.getNextToken();
+        if (token.type() == TokenType::END_OF_FILE) {
+            break;
+        }
+        if (token.type() == TokenType::UNKNOWN) {
+            if (printErrors) {
+                std::cout << "Error type A at line " << token.line << " : " << lexer.getErrorMessage() << '\n';
+            }
+            hasError = true;
+        } else if (printTokens) {
+            std::cout << token.toString() << '\n';
+        }
+    }
+    return hasError;
+}
+
+// 流式输出词法单元列表（--stream）
+// 按块读取输入，边扫描边输出，内存占用与输入大小无关；只做词法分析，不进行语法和语义分析
+// 普通文件扫描两遍：第一遍只检查词法错误，没有错误时第二遍输出词法单元，结果与默认模式一致；
+// 标准输入无法重读，词法单元和错误按出现顺序交错输出
+static int dumpTokensStreaming(const std::string& filename) {
+    std::ios::sync_with_stdio(false);
+    
+    if (filename == "-") {
+        bool hasError = streamTokens(std::cin, true, true);
+        std::cout.flush();
+        return hasError ? 1 : 0;
+    }
+    
+    std::ifstream checkInput(filename, std::ios::binary);
+    if (!checkInput) {
+        std::cerr << "Error: Could not open file \"" << filename << "\"" << std::endl;
+        return 1;
+    }
+    if (streamTokens(checkInput, false, true)) {
+        std::cout.flush();
+        return 1;
+    }
+    
+    std::ifstream dumpInput(filename, std::ios::binary);
+    streamTokens(dumpInput, true, false);
+    std::cout.flush();
+    return 0;
+}
 
 // 编译器主函数
 // 负责处理命令行参数、读取源代码文件、执行编译流程并输出结果
 int main(int argc, char* argv[]) {
-    // 检查命令行参数数量是否正确
-    if (argc != 2) {
-        std::cerr << "Usage: sysy_compiler <input_file>" << std::endl;
+    // 解析命令行参数
+    bool streamMode = false;         // --stream：流式输出词法单元列表
+    bool emitIr = false;             // --emit-ir：不输出词法单元列表，改为输出中间代码
+    std::string lexerBackend = "hand"; // --lexer=hand|flex：词法分析后端
+    std::string diagFormat = "text";   // --diagnostics=text|json：错误信息的输出格式
+    int optLevel = 0;                  // -O0|-O1|-O2：中端优化级别
+    std::string printAfter;            // -print-after=<pass|all>：在指定的Pass之后输出函数的中间代码
+    bool timePasses = false;           // -time-passes：输出各Pass和分析的耗时
+    bool verifyFlatAst = false;        // --verify-flat-ast：只做语法分析，检查扁平编码与语法树一致
+    unsigned threadCount = 0;          // --threads=N：语义分析最多使用的线程数，0表示使用硬件线程数
+    std::string filename;
+    bool badArgs = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stream") {
+            streamMode = true;
+        } else if (arg == "--emit-ir") {
+            emitIr = true;
+        } else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+            optLevel = arg[2] - '0';
+        } else if (arg.rfind("-print-after=", 0) == 0) {
+            printAfter = arg.substr(13);
+            if (printAfter != "all" && createPass(printAfter) == nullptr) {
+                badArgs = true;
+            }
+        } else if (arg == "-time-passes") {
+            timePasses = true;
+        } else if (arg == "--verify-flat-ast") {
+            verifyFlatAst = true;
+        } else if (arg.rfind("--lexer=", 0) == 0) {
+            lexerBackend = arg.substr(8);
+        } else if (arg.rfind("--diagnostics=", 0) == 0) {
+            diagFormat = arg.substr(14);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            std::string count = arg.substr(10);
+            if (count.empty() || count.size() > 4 ||
+                count.find_first_not_of("0123456789") != std::string::npos) {
+                badArgs = true;
+            } else {
+                threadCount = static_cast<unsigned>(std::stoul(count));
+            }
+        } else if (filename.empty()) {
+            filename = arg;
+        } else {
+            badArgs = true;
+        }
+    }
+    if (lexerBackend != "hand" && lexerBackend != "flex") {
+        badArgs = true;
+    }
+    if (diagFormat != "text" && diagFormat != "json") {
+        badArgs = true;
+    }
+    DiagFormat format = diagFormat == "json" ? DiagFormat::JSON : DiagFormat::TEXT;
+    
+    // 检查命令行参数是否正确
+    if (badArgs || filename.empty()) {
+        std::cerr << "Usage: sysy_compiler [--stream] [--emit-ir] [-O0|-O1|-O2] [-print-after=<pass|all>] [-time-passes] [--verify-flat-ast] [--lexer=hand|flex] [--diagnostics=text|json] [--threads=N] <input_file | ->" << std::endl;
         return 1; // 错误码1表示参数错误
     }
-
-    std::string filename = argv[1];
-    std::ifstream file(filename);
+    
+#ifndef SYSY_HAVE_FLEX
+    if (lexerBackend == "flex") {
+        std::cerr << "Error: the flex lexer backend was not built (configure with -DSYSY_WITH_FLEX=ON and flex installed)" << std::endl;
+        return 1;
+    }
+#endif
+    
+    // 流式模式：只输出词法单元列表（只支持手写词法分析器）
+    if (streamMode) {
+        if (emitIr) {
+            std::cerr << "Error: --stream cannot be combined with --emit-ir" << std::endl;
+            return 1;
+        }
+        if (lexerBackend != "hand") {
+            std::cerr << "Error: --stream only supports --lexer=hand" << std::endl;
+            return 1;
+        }
+        return dumpTokensStreaming(filename);
+    }
+    
+    // 打开源文件：普通文件直接映射到内存，"-"表示从标准输入读取
+    std::unique_ptr<SourceBuffer> sourceBuffer = SourceBuffer::open(filename);
 
     // 检查文件是否成功打开
-    if (!file.is_open()) {
+    if (!sourceBuffer) {
         std::cerr << "Error: Could not open file \"" << filename << "\"" << std::endl;
         return 1; // 错误码1表示文件打开失败
     }
 
-    // 读取文件内容到字符串
-    std::string source((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
-
-    file.close(); // 关闭文件
+    // 源代码视图，词法分析器和所有Token都直接引用这块内存
+    std::string_view source = sourceBuffer->text();
 
-    // 创建词法分析器实例
-    Lexer lexer(source);
-    
-    // 遍历所有Token，检查是否有词法错误
-    bool hasError = false;
-    std::vector<Token> tokens;
-    Token token;
+    // 一次性生成Token缓冲区，Token输出和语法分析共用这份结果
+    // 手写词法分析器对大文件按块在多个线程上并行分析，结果与顺序分析完全一致
+    TokenStream tokens;
+#ifdef SYSY_HAVE_FLEX
+    if (lexerBackend == "flex") {
+        FlexScanner scanner(source);
+        tokens = scanner.tokenize();
+    } else
+#endif
+    {
+        ParallelLexer lexer(source);
+        tokens = lexer.tokenize();
+    }
     
-    while (true) {
-        token = lexer.getNextToken();
-        
-        if (token.type == TokenType::END_OF_FILE) {
-            break;
-        }
-        
-        if (token.type == TokenType::UNKNOWN) {
-            // 词法错误，按照实验要求输出错误信息
-            if (token.errorMessage.empty()) {
-                std::cout << "Error type A at line " << token.line << " : Invalid token" << std::endl;
-            } else {
-                std::cout << "Error type A at line " << token.line << " : " << token.errorMessage << std::endl;
-            }
-            hasError = true;
-        } else {
-            // 没有词法错误，保存Token信息
-            tokens.push_back(token);
+    // 遍历所有Token，收集词法错误
+    DiagnosticEngine lexicalErrors;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens.type(i) == TokenType::UNKNOWN) {
+            std::string_view errorMessage = tokens.errorMessage(i);
+            lexicalErrors.report(DiagKind::LEXICAL, 0, tokens.line(i), tokens.column(i),
+                                 errorMessage.empty() ? std::string_view("Invalid token") : errorMessage);
         }
     }
     
-    // 如果有词法错误，返回错误码1
-    if (hasError) {
+    // 如果有词法错误，按照实验要求输出错误信息，返回错误码1
+    // 检查扁平编码时继续分析，错误恢复得到的语法树也要比较
+    if (lexicalErrors.hasErrors() && !verifyFlatAst) {
+        lexicalErrors.render(std::cout, format);
         return 1;
     }
     
     // 如果没有词法错误，继续执行语法和语义分析
-    // 输出词法单元列表
-    for (const auto& t : tokens) {
-        std::cout << t.toString() << std::endl;
-    }
-    try {
-        // 重置词法分析器
-        Lexer lexer2(source);
-        
-        // 创建语法分析器实例
-        Parser parser(lexer2);
-        
-        // 执行语法分析，生成编译单元
-        auto compUnit = parser.parse();
-
-        // 创建语义分析器实例
-        SemanticAnalyzer analyzer;
-        
-        // 执行语义分析
-        compUnit->accept(analyzer);
-        
-        // 不打印语法树，只保留错误输出
-
-        // 编译成功，不输出额外提示，只输出词法单元列表
-    } catch (const std::exception& e) {
-        // 捕获并处理编译过程中的异常
-        std::string errorMsg = e.what();
-        size_t firstColon = errorMsg.find(':');
-        if (firstColon != std::string::npos) {
-            // 提取错误类型
-            std::string errorType = errorMsg.substr(0, firstColon);
-            size_t secondColon = errorMsg.find(':', firstColon + 1);
-            if (secondColon != std::string::npos) {
-                // 提取行号
-                std::string lineStr = errorMsg.substr(firstColon + 1, secondColon - firstColon - 1);
-                // 提取错误说明
-                std::string description = errorMsg.substr(secondColon + 1);
-                // 按照实验要求的格式输出错误信息
-                std::cout << "Error type " << errorType << " at line " << lineStr << " : " << description << std::endl;
-            } else {
-                // 无法解析的异常格式
-                std::cout << "Error: " << errorMsg << std::endl;
+    // 输出词法单元列表（输出中间代码或检查扁平编码时不输出）
+    std::ios::sync_with_stdio(false);
+    if (!emitIr && !verifyFlatAst) {
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            if (tokens.type(i) != TokenType::END_OF_FILE) {
+                std::cout << tokens.at(i).toString() << '\n';
             }
-        } else {
-            // 无法解析的异常格式
-            std::cout << "Error: " << errorMsg << std::endl;
         }
+        std::cout.flush();
+    }
+    // 语法树节点全部分配在这个Arena中，编译结束时整体释放
+    Arena astArena;
+    
+    // 创建语法分析器实例，直接读取已生成的Token缓冲区
+    Parser parser(tokens, astArena);
+    
+    // 执行语法分析，生成编译单元
+    CompUnit* compUnit = parser.parse();
+    
+    // 检查扁平编码：有语法错误时同样比较，不一致时输出第一处差异并返回错误码1
+    if (verifyFlatAst) {
+        FlatAst flat = FlatAst::build(*compUnit, astArena.allocationCount());
+        std::string mismatch = flat.verify(*compUnit);
+        if (!mismatch.empty()) {
+            std::cerr << "Error: flat AST differs from the syntax tree at " << mismatch << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    // 按照实验要求的格式输出全部语法错误，有语法错误时不再进行语义分析
+    if (parser.hasErrors()) {
+        parser.getDiagnostics().render(std::cout, format);
         return 1; // 错误码1表示编译失败
     }
-
+    
+    // 创建语义分析器实例
+    SemanticAnalyzer analyzer(threadCount);
+    
+    // 执行语义分析（静态分派，见ast_visitor.h）
+    analyzer.dispatch(compUnit);
+    
+    // 语义错误和警告按位置排序后输出到标准错误
+    if (!analyzer.getDiagnostics().empty() || format == DiagFormat::JSON) {
+        analyzer.getDiagnostics().render(std::cerr, format);
+    }
+    
+    // 没有语义错误时做常量折叠，名字解析和类型检查的结果都已确定
+    if (!analyzer.getDiagnostics().hasErrors()) {
+        ConstantFolder folder(astArena);
+        folder.dispatch(compUnit);
+    }
+    
+    // 中端：翻译为中间代码并按优化级别运行Pass；-print-after和-time-passes的结果输出到标准错误
+    // 只输出中间代码时有语义错误无法翻译，返回错误码1
+    bool runMiddleEnd = emitIr || optLevel > 0 || timePasses || !printAfter.empty();
+    if (runMiddleEnd && !analyzer.getDiagnostics().hasErrors()) {
+        std::unique_ptr<Module> module = IRLowering::lower(*compUnit);
+        PassManager passManager;
+        addOptimizationPipeline(passManager, optLevel);
+        if (!printAfter.empty()) {
+            passManager.setPrintAfter(printAfter, std::cerr);
+        }
+        passManager.setTimePasses(timePasses);
+        passManager.run(*module);
+        if (timePasses) {
+            passManager.printTimeReport(std::cerr);
+        }
+        if (emitIr) {
+            module->print(std::cout);
+            return 0;
+        }
+    } else if (emitIr) {
+        return 1;
+    }
+    
+    // 不打印语法树，只保留错误输出
+    
+    // 编译成功，不输出额外提示，只输出词法单元列表
     return 0; // 返回0表示编译成功
 }
\ No newline at end of file
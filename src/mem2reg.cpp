@@ -0,0 +1,269 @@
+#include "../include/passes.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// alloca能否提升：标量，并且只被load读取、被store作为地址写入（地址没有被传给其他指令）
+bool isPromotable(const Instruction* alloca) {
+    if (alloca->isArrayAlloca()) {
+        return false;
+    }
+    for (Use* use = alloca->getUses(); use != nullptr; use = use->getNext()) {
+        Instruction* user = use->getUser();
+        if (user->getOpcode() == Opcode::LOAD) {
+            continue;
+        }
+        if (user->getOpcode() == Opcode::STORE && &user->getOperandUse(1) == use) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+// 未初始化的局部变量的值：SysY没有规定，取0
+Value* zeroOf(Function& function, IRType type) {
+    return type == IRType::F32 ? function.getConstant(0.0f) : function.getConstant(0);
+}
+
+// 把(键, 值)对按键分组为CSR数组：items[offsets[k]..offsets[k+1])为键k的值，组内保持原来的顺序
+template <typename T>
+void groupByKey(const std::vector<std::pair<uint32_t, T>>& pairs, size_t keyCount, std::vector<uint32_t>& offsets,
+                std::vector<T>& items) {
+    offsets.assign(keyCount + 1, 0);
+    for (const auto& pair : pairs) {
+        offsets[pair.first + 1]++;
+    }
+    for (size_t i = 0; i < keyCount; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    items.resize(pairs.size());
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& pair : pairs) {
+        items[cursor[pair.first]++] = pair.second;
+    }
+}
+
+// 支配树上深度优先遍历的栈帧
+struct RenameFrame {
+    BasicBlock* block;
+    NodeList<BasicBlock> children;
+    size_t next;    // 下一个要访问的子结点
+    size_t undoTop; // 进入本块时撤销记录的长度
+};
+
+} // namespace
+
+// 把可以提升的alloca换成SSA值
+// 1. 扫描一遍函数，对每个变量记录有store的基本块（定值块），以及在块内store之前就有load的基本块（向上暴露的使用）；
+// 2. 从向上暴露的使用沿前驱反向传播，求出变量在入口处活跃的基本块；
+// 3. 从定值块出发求迭代支配边界，只在变量活跃的基本块放置φ函数（剪枝的SSA，不产生无用的φ函数）；
+// 4. 沿支配树深度优先遍历重命名：load替换为当前值，store更新当前值后删除，并为后继块的φ函数填入来源；
+//    离开基本块时按撤销记录恢复当前值，遍历用显式栈，不会因为支配树很深而栈溢出
+bool PromoteMemToRegPass::run(Function& function, AnalysisManager& analyses) {
+    BasicBlock* entry = function.getEntry();
+    if (entry == nullptr) {
+        return false;
+    }
+    // 可以提升的alloca按地址排序，load和store的地址操作数用二分查找得到变量编号
+    std::vector<Instruction*> allocas;
+    for (Instruction* inst = entry->getFirst(); inst != nullptr; inst = inst->getNext()) {
+        if (inst->getOpcode() == Opcode::ALLOCA && isPromotable(inst)) {
+            allocas.push_back(inst);
+        }
+    }
+    if (allocas.empty()) {
+        return false;
+    }
+    std::sort(allocas.begin(), allocas.end());
+    auto promotedIndex = [&](Value* address) -> uint32_t {
+        Instruction* inst = dyn_cast<Instruction>(address);
+        if (inst == nullptr || inst->getOpcode() != Opcode::ALLOCA) {
+            return UINT32_MAX;
+        }
+        auto it = std::lower_bound(allocas.begin(), allocas.end(), inst);
+        return it != allocas.end() && *it == inst ? static_cast<uint32_t>(it - allocas.begin()) : UINT32_MAX;
+    };
+
+    DominatorTree& domTree = analyses.getDominatorTree(function);
+    DominanceFrontier& frontier = analyses.getDominanceFrontier(function);
+    size_t blockCount = function.getBlockCount();
+    size_t allocaCount = allocas.size();
+
+    // 定值块和向上暴露的使用所在的块，先记录为(变量, 基本块)对，再按变量分组
+    std::vector<std::pair<uint32_t, uint32_t>> defPairs;
+    std::vector<std::pair<uint32_t, uint32_t>> usePairs;
+    std::vector<uint32_t> storedIn(allocaCount, UINT32_MAX);  // 本块中是否已经store过
+    std::vector<uint32_t> exposedIn(allocaCount, UINT32_MAX); // 本块是否已经记录为向上暴露的使用
+    std::vector<BasicBlock*> blocks(blockCount);
+    std::vector<uint32_t> predOffsets(blockCount + 1, 0);
+    for (BasicBlock* block = entry; block != nullptr; block = block->getNext()) {
+        uint32_t index = block->getIndex();
+        blocks[index] = block;
+        for (uint32_t i = 0; i < block->getSuccessorCount(); i++) {
+            predOffsets[block->getSuccessor(i)->getIndex() + 1]++;
+        }
+        for (Instruction* inst = block->getFirst(); inst != nullptr; inst = inst->getNext()) {
+            if (inst->getOpcode() == Opcode::LOAD) {
+                uint32_t a = promotedIndex(inst->getOperand(0));
+                if (a != UINT32_MAX && storedIn[a] != index && exposedIn[a] != index) {
+                    usePairs.push_back({a, index});
+                    exposedIn[a] = index;
+                }
+            } else if (inst->getOpcode() == Opcode::STORE) {
+                uint32_t a = promotedIndex(inst->getOperand(1));
+                if (a != UINT32_MAX && storedIn[a] != index) {
+                    defPairs.push_back({a, index});
+                    storedIn[a] = index;
+                }
+            }
+        }
+    }
+    std::vector<uint32_t> defOffsets;
+    std::vector<uint32_t> defBlocks;
+    groupByKey(defPairs, allocaCount, defOffsets, defBlocks);
+    std::vector<uint32_t> useOffsets;
+    std::vector<uint32_t> useBlocks;
+    groupByKey(usePairs, allocaCount, useOffsets, useBlocks);
+    // 前驱，按基本块编号存为CSR数组
+    for (size_t i = 0; i < blockCount; i++) {
+        predOffsets[i + 1] += predOffsets[i];
+    }
+    std::vector<uint32_t> preds(predOffsets[blockCount]);
+    std::vector<uint32_t> cursor(predOffsets.begin(), predOffsets.end() - 1);
+    for (BasicBlock* block = entry; block != nullptr; block = block->getNext()) {
+        for (uint32_t i = 0; i < block->getSuccessorCount(); i++) {
+            preds[cursor[block->getSuccessor(i)->getIndex()]++] = block->getIndex();
+        }
+    }
+
+    // 放置φ函数。各标记数组以变量编号加1作为时间戳，换变量时不必清空
+    std::vector<std::pair<uint32_t, std::pair<Instruction*, uint32_t>>> placedPhis; // (基本块, (φ函数, 变量))
+    std::vector<uint32_t> isDef(blockCount, 0);
+    std::vector<uint32_t> liveIn(blockCount, 0);
+    std::vector<uint32_t> hasPhi(blockCount, 0);
+    std::vector<uint32_t> worklist;
+    IRBuilder builder(&function);
+    for (uint32_t a = 0; a < allocaCount; a++) {
+        if (useOffsets[a] == useOffsets[a + 1]) {
+            continue;
+        }
+        uint32_t stamp = a + 1;
+        for (uint32_t i = defOffsets[a]; i < defOffsets[a + 1]; i++) {
+            isDef[defBlocks[i]] = stamp;
+        }
+        // 活跃性：从向上暴露的使用沿前驱传播，遇到定值块停止
+        worklist.assign(useBlocks.begin() + useOffsets[a], useBlocks.begin() + useOffsets[a + 1]);
+        for (uint32_t block : worklist) {
+            liveIn[block] = stamp;
+        }
+        while (!worklist.empty()) {
+            uint32_t block = worklist.back();
+            worklist.pop_back();
+            for (uint32_t i = predOffsets[block]; i < predOffsets[block + 1]; i++) {
+                uint32_t pred = preds[i];
+                if (isDef[pred] != stamp && liveIn[pred] != stamp) {
+                    liveIn[pred] = stamp;
+                    worklist.push_back(pred);
+                }
+            }
+        }
+        // 迭代支配边界
+        worklist.assign(defBlocks.begin() + defOffsets[a], defBlocks.begin() + defOffsets[a + 1]);
+        while (!worklist.empty()) {
+            uint32_t block = worklist.back();
+            worklist.pop_back();
+            for (BasicBlock* join : frontier.get(blocks[block])) {
+                uint32_t index = join->getIndex();
+                if (hasPhi[index] == stamp) {
+                    continue;
+                }
+                hasPhi[index] = stamp;
+                if (liveIn[index] == stamp) {
+                    if (join->getFirst() != nullptr) {
+                        builder.setInsertPoint(join->getFirst());
+                    } else {
+                        builder.setInsertPoint(join);
+                    }
+                    Instruction* phi = builder.createPhi(allocas[a]->getAllocatedType(),
+                                                         predOffsets[index + 1] - predOffsets[index]);
+                    placedPhis.push_back({index, {phi, a}});
+                }
+                if (isDef[index] != stamp) {
+                    worklist.push_back(index);
+                }
+            }
+        }
+    }
+    std::vector<uint32_t> phiOffsets;
+    std::vector<std::pair<Instruction*, uint32_t>> blockPhis;
+    groupByKey(placedPhis, blockCount, phiOffsets, blockPhis);
+
+    // 重命名
+    std::vector<Value*> current(allocaCount);
+    for (uint32_t a = 0; a < allocaCount; a++) {
+        current[a] = zeroOf(function, allocas[a]->getAllocatedType());
+    }
+    std::vector<std::pair<uint32_t, Value*>> undo; // 被覆盖的当前值
+    std::vector<RenameFrame> stack;
+    auto enter = [&](BasicBlock* block) {
+        size_t undoTop = undo.size();
+        for (uint32_t i = phiOffsets[block->getIndex()]; i < phiOffsets[block->getIndex() + 1]; i++) {
+            undo.push_back({blockPhis[i].second, current[blockPhis[i].second]});
+            current[blockPhis[i].second] = blockPhis[i].first;
+        }
+        Instruction* next = nullptr;
+        for (Instruction* inst = block->getFirst(); inst != nullptr; inst = next) {
+            next = inst->getNext();
+            if (inst->getOpcode() == Opcode::LOAD) {
+                uint32_t a = promotedIndex(inst->getOperand(0));
+                if (a != UINT32_MAX) {
+                    inst->replaceAllUsesWith(current[a]);
+                    inst->eraseFromParent();
+                }
+            } else if (inst->getOpcode() == Opcode::STORE) {
+                uint32_t a = promotedIndex(inst->getOperand(1));
+                if (a != UINT32_MAX) {
+                    undo.push_back({a, current[a]});
+                    current[a] = inst->getOperand(0);
+                    inst->eraseFromParent();
+                }
+            }
+        }
+        for (uint32_t i = 0; i < block->getSuccessorCount(); i++) {
+            uint32_t successor = block->getSuccessor(i)->getIndex();
+            for (uint32_t j = phiOffsets[successor]; j < phiOffsets[successor + 1]; j++) {
+                blockPhis[j].first->addIncoming(current[blockPhis[j].second], block, function.getArena());
+            }
+        }
+        stack.push_back(RenameFrame{block, domTree.getChildren(block), 0, undoTop});
+    };
+    enter(entry);
+    while (!stack.empty()) {
+        RenameFrame& frame = stack.back();
+        if (frame.next < frame.children.size()) {
+            enter(frame.children[frame.next++]);
+            continue;
+        }
+        while (undo.size() > frame.undoTop) {
+            current[undo.back().first] = undo.back().second;
+            undo.pop_back();
+        }
+        stack.pop_back();
+    }
+
+    // 不可达基本块中剩下的访问，然后删除alloca
+    for (Instruction* alloca : allocas) {
+        while (alloca->hasUses()) {
+            Instruction* user = alloca->getUses()->getUser();
+            if (user->getOpcode() == Opcode::LOAD) {
+                user->replaceAllUsesWith(zeroOf(function, alloca->getAllocatedType()));
+            }
+            user->eraseFromParent();
+        }
+        alloca->eraseFromParent();
+    }
+    return true;
+}
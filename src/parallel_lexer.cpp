@@ -0,0 +1,248 @@
+#include "../include/parallel_lexer.h"
+#include "../include/Lexer.h"
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 一块源代码的推测性分析结果
+struct ChunkResult {
+    size_t begin = 0;         // 块的起始偏移（总是某一行的行首）
+    size_t end = 0;           // 块的结束偏移
+    TokenStream tokens;       // 起始偏移落在[begin, end)中的Token，行号从1开始相对块首计算，标识符使用局部编号
+    StringInterner interner;  // 局部驻留表
+    Token stop;               // 第一个起始偏移不小于end的Token（或提前遇到的END_OF_FILE），偏移为绝对偏移
+    size_t newlines = 0;      // [begin, end)中的换行符个数
+};
+
+// 合并时复制的一段Token
+struct Piece {
+    const TokenStream* tokens;              // 来源
+    size_t origin;                          // 来源块的下标，重新分析的Token为块的个数
+    size_t begin;                           // 来源中的起始下标
+    size_t end;                             // 来源中的结束下标
+    int lineDelta;                          // 行号修正量
+    uint32_t errorBase;                     // 来源的错误信息在结果中的起始下标
+    const StringInterner* interner;         // 来源使用的局部驻留表
+    std::vector<uint32_t>* symbolMap;       // 来源的局部编号到全局编号的映射
+    size_t dst;                             // 在结果中的起始下标
+    std::vector<uint32_t> firstUses;        // 本段中出现的局部编号，按第一次出现的顺序
+};
+
+// 对每一段调用func，第一段在当前线程处理，其余各段各用一个线程
+template <typename Func>
+void forEachPiece(std::vector<Piece>& pieces, Func func) {
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < pieces.size(); ++i) {
+        workers.emplace_back([&func, &pieces, i]() { func(pieces[i]); });
+    }
+    func(pieces[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// 分析一块源代码
+// 词法分析器看到的是从块首到源代码末尾的全部内容，跨越块尾的Token可以完整扫描
+void lexChunk(std::string_view source, ChunkResult& chunk) {
+    chunk.newlines = static_cast<size_t>(
+        std::count(source.begin() + chunk.begin, source.begin() + chunk.end, '\n'));
+    
+    Lexer lexer(source.substr(chunk.begin));
+    lexer.setInterner(chunk.interner);
+    chunk.tokens = TokenStream(source);
+    chunk.tokens.reserve((chunk.end - chunk.begin) / 4 + 1);
+    
+    while (true) {
+        Token token = lexer.getNextToken();
+        token.offset += static_cast<uint32_t>(chunk.begin);
+        if (token.type() == TokenType::END_OF_FILE || token.offset >= chunk.end) {
+            chunk.stop = token;
+            return;
+        }
+        if (token.type() == TokenType::UNKNOWN) {
+            chunk.tokens.push(token, lexer.getErrorMessage(token));
+        } else {
+            chunk.tokens.push(token);
+        }
+    }
+}
+
+} // namespace
+
+// 构造函数
+ParallelLexer::ParallelLexer(std::string_view source, unsigned threadCount)
+    : source(source), threadCount(threadCount) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+// 并行扫描全部源代码
+// 1. 在名义切分点之后的第一个换行处切块，各线程推测性地分析自己的块
+// 2. 顺序合并：按前一块停下的Token确定后一块从哪个Token开始使用，对不齐的部分重新顺序分析
+// 3. 各线程找出自己负责的部分中标识符第一次出现的顺序，再按段的顺序把它们驻留到全局驻留表，
+//    使全局编号的分配顺序与顺序分析时相同
+// 4. 各线程把自己负责的部分复制到结果中，同时修正行号并把局部标识符编号映射为全局编号
+TokenStream ParallelLexer::tokenize() {
+    size_t chunkLimit = std::min<size_t>(threadCount, source.size() / MIN_CHUNK_SIZE);
+    if (chunkLimit <= 1 || source.size() > UINT32_MAX) {
+        Lexer lexer(source);
+        return lexer.tokenize();
+    }
+    
+    // 切块：块首总是行首
+    std::vector<size_t> starts = {0};
+    for (size_t i = 1; i < chunkLimit; ++i) {
+        size_t nominal = std::max(source.size() / chunkLimit * i, starts.back());
+        size_t newline = source.find('\n', nominal);
+        if (newline == std::string_view::npos || newline + 1 >= source.size()) {
+            break;
+        }
+        if (newline + 1 > starts.back()) {
+            starts.push_back(newline + 1);
+        }
+    }
+    
+    std::vector<ChunkResult> chunks(starts.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunks[i].begin = starts[i];
+        chunks[i].end = i + 1 < starts.size() ? starts[i + 1] : source.size();
+    }
+    
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            workers.emplace_back(lexChunk, source, std::ref(chunks[i]));
+        }
+        lexChunk(source, chunks[0]);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    // 顺序合并：next是到目前为止正确分析出的下一个Token（绝对偏移、绝对行号）
+    TokenStream repair(source);     // 重新顺序分析得到的Token，使用绝对行号
+    StringInterner repairInterner;  // 重新分析时使用的局部驻留表
+    std::vector<Piece> pieces;
+    std::vector<bool> used(chunks.size(), false);
+    std::optional<Lexer> relexer; // 未对齐时从next起顺序分析的词法分析器
+    uint32_t relexBase = 0;       // relexer的源代码在整个源代码中的偏移
+    size_t repairBegin = 0;       // 当前尚未归入pieces的重新分析Token的起始下标
+    
+    auto closeRepair = [&]() {
+        if (repair.size() > repairBegin) {
+            pieces.push_back({&repair, chunks.size(), repairBegin, repair.size(), 0, 0, &repairInterner, nullptr, 0, {}});
+            repairBegin = repair.size();
+        }
+    };
+    
+    pieces.push_back({&chunks[0].tokens, 0, 0, chunks[0].tokens.size(), 0, 0, &chunks[0].interner, nullptr, 0, {}});
+    used[0] = true;
+    Token next = chunks[0].stop;
+    int lineDelta = 0;
+    
+    for (size_t i = 1; i < chunks.size() && next.type() != TokenType::END_OF_FILE; ++i) {
+        ChunkResult& chunk = chunks[i];
+        lineDelta += static_cast<int>(chunks[i - 1].newlines);
+        
+        while (true) {
+            // 检查next是否与本块的某个Token（或本块停下的Token）对齐
+            size_t k = chunk.tokens.lowerBound(next.offset);
+            bool synced = k < chunk.tokens.size()
+                ? chunk.tokens.offset(k) == next.offset && chunk.tokens.line(k) + lineDelta == next.line
+                : chunk.stop.offset == next.offset && chunk.stop.line + lineDelta == next.line;
+            if (synced) {
+                closeRepair();
+                pieces.push_back({&chunk.tokens, i, k, chunk.tokens.size(), lineDelta, 0, &chunk.interner, nullptr, 0, {}});
+                used[i] = true;
+                next = chunk.stop;
+                next.line += lineDelta;
+                relexer.reset();
+                break;
+            }
+            
+            // 未对齐：从next起顺序分析一个Token
+            if (!relexer) {
+                relexer.emplace(source.substr(next.offset), next.line);
+                relexer->setInterner(repairInterner);
+                relexBase = next.offset;
+                next = relexer->getNextToken();
+                next.offset += relexBase;
+            }
+            if (next.type() == TokenType::UNKNOWN) {
+                repair.push(next, relexer->getErrorMessage(next));
+            } else {
+                repair.push(next);
+            }
+            next = relexer->getNextToken();
+            next.offset += relexBase;
+            if (next.type() == TokenType::END_OF_FILE || next.offset >= chunk.end) {
+                break;
+            }
+        }
+    }
+    
+    // 末尾的END_OF_FILE
+    repair.push(next);
+    closeRepair();
+    
+    // 各段中标识符第一次出现的顺序：块的局部编号是从块首开始分配的，块中被丢弃的前缀里出现过的名字
+    // 在保留的部分中可能出现得更晚；重新分析的Token分成多段，一段中的名字也可能在前面的段中出现过
+    forEachPiece(pieces, [](Piece& piece) {
+        std::vector<bool> seen(piece.interner->size(), false);
+        for (size_t i = piece.begin; i < piece.end; ++i) {
+            if (piece.tokens->type(i) == TokenType::IDENT) {
+                uint32_t id = piece.tokens->symbol(i).id;
+                if (!seen[id]) {
+                    seen[id] = true;
+                    piece.firstUses.push_back(id);
+                }
+            }
+        }
+    });
+    
+    // 按段的顺序驻留到全局驻留表，每个名字在它第一次出现时分配编号，与顺序分析一致
+    // 映射表按来源（各块和重新分析）各一张，0表示尚未映射（空名字不会是标识符）
+    std::vector<std::vector<uint32_t>> symbolMaps(chunks.size() + 1);
+    StringInterner& global = StringInterner::global();
+    for (auto& piece : pieces) {
+        std::vector<uint32_t>& map = symbolMaps[piece.origin];
+        map.resize(piece.interner->size(), 0);
+        piece.symbolMap = &map;
+        for (uint32_t id : piece.firstUses) {
+            if (map[id] == 0) {
+                map[id] = global.intern(piece.interner->name(Symbol(id))).id;
+            }
+        }
+    }
+    
+    // 确定每段在结果中的位置，并合并错误信息
+    TokenStream result(source);
+    std::vector<uint32_t> errorBases(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (used[i]) {
+            errorBases[i] = result.appendErrors(chunks[i].tokens);
+        }
+    }
+    uint32_t repairErrorBase = result.appendErrors(repair);
+    
+    size_t total = 0;
+    for (auto& piece : pieces) {
+        piece.dst = total;
+        total += piece.end - piece.begin;
+        piece.errorBase = piece.origin < chunks.size() ? errorBases[piece.origin] : repairErrorBase;
+    }
+    result.resize(total);
+    
+    // 并行复制各段
+    forEachPiece(pieces, [&result](Piece& piece) {
+        result.copyRange(piece.dst, *piece.tokens, piece.begin, piece.end,
+                         piece.lineDelta, piece.errorBase, piece.symbolMap);
+    });
+    
+    return result;
+}
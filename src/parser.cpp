@@ -1,53 +1,88 @@
-#include "../include/Lexer.h"
 #include "../include/token.h"
 #include "../include/ast.h"
 #include "../include/Parser.h"
+#include <array>
 #include <stdexcept>
-#include <memory>
 
 // 语法分析器构造函数
-// 初始化语法分析器，关联词法分析器并获取第一个Token
-Parser::Parser(Lexer& lexer)
-    : lexer(lexer) {
-    currentToken = lexer.getNextToken();
+// 初始化语法分析器，关联已物化的Token缓冲区并定位到第一个Token，语法树节点分配在arena中
+Parser::Parser(const TokenStream& tokens, Arena& arena)
+    : tokens(tokens), position(0), arena(arena), failed(false), parenDepth(0) {
+    if (tokens.empty() || tokens.type(tokens.size() - 1) != TokenType::END_OF_FILE) {
+        throw std::invalid_argument("Token buffer must end with END_OF_FILE");
+    }
+}
+
+// 前进到下一个Token
+// 直接移动缓冲区下标，停留在末尾的END_OF_FILE上；同时记录尚未闭合的圆括号层数，供恐慌模式恢复使用
+void Parser::advanceToken() {
+    if (position + 1 < tokens.size()) {
+        TokenType type = currentType();
+        if (type == TokenType::LPAREN) {
+            parenDepth++;
+        } else if (type == TokenType::RPAREN && parenDepth > 0) {
+            parenDepth--;
+        }
+        ++position;
+    }
+}
+
+// 预览当前Token之后第n个Token的类型（不消耗Token）
+// 越过缓冲区末尾时返回END_OF_FILE
+TokenType Parser::peekType(size_t n) const {
+    size_t index = position + n;
+    return index < tokens.size() ? tokens.type(index) : TokenType::END_OF_FILE;
+}
+
+// 结束一个子节点列表
+// 把mark之后收集到的子节点复制到Arena中生成NodeList，并从收集栈中弹出
+template <typename T>
+NodeList<T> Parser::finishList(size_t mark) {
+    size_t count = pending.size() - mark;
+    T** items = arena.allocateArray<T*>(count);
+    for (size_t i = 0; i < count; ++i) {
+        items[i] = static_cast<T*>(pending[mark + i]);
+    }
+    pending.resize(mark);
+    return NodeList<T>(items, count);
 }
 
 // 解析整个编译单元
 // 处理所有的变量声明和函数定义，并生成编译单元节点
-std::unique_ptr<CompUnit> Parser::parse() {
-    auto compUnit = std::make_unique<CompUnit>();
+CompUnit* Parser::parse() {
+    CompUnit* compUnit = arena.make<CompUnit>();
+    std::vector<Decl*> decls;
+    std::vector<FuncDef*> funcDefs;
     
     // 循环解析所有Token，直到文件结束
-    while (currentToken.type != TokenType::END_OF_FILE) {
+    while (currentType() != TokenType::END_OF_FILE) {
         // 解析声明或函数定义
-        if (currentToken.type == TokenType::INT || 
-            currentToken.type == TokenType::FLOAT || 
-            currentToken.type == TokenType::VOID) {
+        if (currentType() == TokenType::CONST ||
+            currentType() == TokenType::INT || 
+            currentType() == TokenType::FLOAT || 
+            currentType() == TokenType::VOID) {
             
             // 保存当前类型Token
-            TokenType typeTokenType = currentToken.type;
-            
-            // 预取下一个Token
-            Token nextToken = lexer.peekToken();
+            TokenType typeTokenType = currentType();
             
             // 判断下一个Token是否是IDENT
-            bool isIdent = (nextToken.type == TokenType::IDENT);
+            bool isIdent = (peekType(1) == TokenType::IDENT);
             
             // 如果是IDENT，进一步判断是否是函数定义
             bool isFuncDef = false;
             if (isIdent) {
                 // 预取下下一个Token
-                Token nextNextToken = lexer.peekToken(2);
-                isFuncDef = (nextNextToken.type == TokenType::LPAREN);
+                isFuncDef = (peekType(2) == TokenType::LPAREN);
             }
             
             if (isFuncDef) {
-                // 是函数定义
+                // 是函数定义，行号取返回类型所在的行
+                int line = currentLine();
                 // 消费类型Token
                 consumeToken(typeTokenType);
                 
                 // 消费标识符Token（函数名）
-                std::string name = currentToken.stringValue;
+                Symbol name = tokens.symbol(position);
                 consumeToken(TokenType::IDENT);
                 
                 // 解析函数返回类型
@@ -61,173 +96,241 @@ std::unique_ptr<CompUnit> Parser::parse() {
                 }
                 
                 // 创建函数定义节点
-                auto funcDef = std::make_unique<FuncDef>();
-                funcDef->setReturnType(returnType);
-                funcDef->setName(name);
+                FuncDef* funcDef = arena.make<FuncDef>(returnType, name, nullptr, line);
                 
                 // 解析函数参数
                 consumeToken(TokenType::LPAREN);
-                if (currentToken.type != TokenType::RPAREN) {
-                    parseFuncParams(funcDef->getParamsRef());
+                if (!failed && currentType() != TokenType::RPAREN) {
+                    funcDef->setParams(parseFuncParams());
                 }
                 consumeToken(TokenType::RPAREN);
                 
                 // 解析函数体
-                consumeToken(TokenType::LBRACE);
-                auto body = std::make_unique<Block>();
-                parseStatementList(*body);
-                consumeToken(TokenType::RBRACE);
-                funcDef->setBody(std::move(body));
+                if (consumeToken(TokenType::LBRACE)) {
+                    Block* body = arena.make<Block>(currentLine());
+                    parseStatementList(*body);
+                    funcDef->setBody(body);
+                    consumeToken(TokenType::RBRACE);
+                }
+                
+                if (failed) {
+                    // 函数头有错误时跳过整个函数
+                    synchronize();
+                    continue;
+                }
                 
                 // 添加到编译单元
-                compUnit->addFuncDef(std::move(funcDef));
+                funcDefs.push_back(funcDef);
             } else {
                 // 不是函数定义，是变量声明
-                if (auto varDecl = parseVarDef()) {
-                    compUnit->addDecl(std::move(varDecl));
+                VarDecl* varDecl = parseVarDef();
+                if (failed) {
+                    synchronize();
+                } else if (varDecl) {
+                    decls.push_back(varDecl);
                 }
             }
-        } else if (currentToken.type == TokenType::IDENT) {
-            // 可能是赋值语句
-            try {
-                // 尝试解析表达式语句
-                auto expr = parseExpression();
-                consumeToken(TokenType::SEMICOLON);
-            } catch (const std::exception& e) {
-                // 如果解析失败，跳过这个Token
-                currentToken = lexer.getNextToken();
+        } else if (currentType() == TokenType::IDENT) {
+            // 可能是赋值语句：解析表达式语句，出错时与变量声明一样报告错误并同步到语句边界
+            parseExpression();
+            consumeToken(TokenType::SEMICOLON);
+            if (failed) {
+                synchronize();
             }
         } else {
             // 跳过未知Token
-            currentToken = lexer.getNextToken();
+            advanceToken();
         }
     }
     
+    compUnit->setDecls(arena.copyList(decls.data(), decls.size()));
+    compUnit->setFuncDefs(arena.copyList(funcDefs.data(), funcDefs.size()));
     return compUnit;
 }
 
+// 记录语法错误
+// 进入恐慌模式：直到synchronize()恢复之前，后续的错误都是这个错误的连锁反应，不再记录
+template <typename... Args>
+void Parser::reportError(const Args&... args) {
+    if (!failed) {
+        diagnostics.report(DiagKind::SYNTAX, 0, currentLine(), tokens.column(position), args...);
+        failed = true;
+    }
+}
+
+// 恐慌模式恢复
+// 跳过Token直到语句边界：消费最外层的';'，或者消费跳过的最外层'{'对应的'}'（以及紧随其后的';'，
+// 如初始化列表"= {...};"）后停下；遇到不属于被跳过部分的'}'时不消费，留给外层的语句块结束。
+// 出错时尚未闭合的圆括号中的';'不是语句边界（如被当作函数调用解析的"for (i = 1; i < n; i = i + 1)"），
+// 要等括号闭合后才能停下，否则括号内剩下的部分会在同一行接连报出由第一个错误引起的错误；
+// 但括号一直没有闭合时，下一个Token已换行的';'仍然是语句边界，避免一路跳到文件末尾
+void Parser::synchronize() {
+    int depth = 0; // 跳过的花括号嵌套层数
+    int line = currentLine(); // 出错所在行
+    while (currentType() != TokenType::END_OF_FILE) {
+        TokenType type = currentType();
+        if (type == TokenType::RBRACE) {
+            if (depth == 0) {
+                break;
+            }
+            advanceToken();
+            if (--depth == 0) {
+                if (currentType() == TokenType::SEMICOLON) {
+                    advanceToken();
+                }
+                break;
+            }
+            continue;
+        }
+        advanceToken();
+        if (type == TokenType::LBRACE) {
+            depth++;
+        } else if (type == TokenType::SEMICOLON && depth == 0 &&
+                   (parenDepth == 0 || currentLine() != line)) {
+            break;
+        }
+    }
+    failed = false;
+    parenDepth = 0;
+}
+
 // 消费指定类型的Token
-// 如果当前Token类型与预期类型匹配，则消费并获取下一个Token；否则抛出异常
-void Parser::consumeToken(TokenType expectedType) {
-    if (currentToken.type == expectedType) {
-        currentToken = lexer.getNextToken();
-    } else {
-        // 错误处理：Token类型不匹配
-        std::string errorMsg = "B:" + std::to_string(currentToken.line) + ":Unexpected token type, expected type: " + std::to_string(static_cast<int>(expectedType)) + ", got: " + std::to_string(static_cast<int>(currentToken.type));
-        throw std::runtime_error(errorMsg);
+// 如果当前Token类型与预期类型匹配，则消费并获取下一个Token，返回true；
+// 否则记录语法错误并返回false。已处于恐慌模式时不再消费任何Token
+bool Parser::consumeToken(TokenType expectedType) {
+    if (failed) {
+        return false;
+    }
+    if (currentType() == expectedType) {
+        advanceToken();
+        return true;
     }
+    // 错误处理：Token类型不匹配
+    reportError("Unexpected token type, expected type: ", static_cast<int>(expectedType),
+                ", got: ", static_cast<int>(currentType()));
+    return false;
 }
 
 // 解析函数定义
 // 处理函数的返回类型、函数名、参数列表和函数体，并生成函数定义节点
-std::unique_ptr<FuncDef> Parser::parseFuncDef() {
-    auto funcDef = std::make_unique<FuncDef>(Type::INT, "", nullptr, lexer.getLine());
+FuncDef* Parser::parseFuncDef() {
+    FuncDef* funcDef = arena.make<FuncDef>(Type::INT, Symbol(0), nullptr, currentLine());
     
     // 解析函数返回类型
-    if (currentToken.type == TokenType::INT) {
+    if (currentType() == TokenType::INT) {
         funcDef->setReturnType(Type::INT);
-    } else if (currentToken.type == TokenType::FLOAT) {
+    } else if (currentType() == TokenType::FLOAT) {
         funcDef->setReturnType(Type::FLOAT);
-    } else if (currentToken.type == TokenType::VOID) {
+    } else if (currentType() == TokenType::VOID) {
         funcDef->setReturnType(Type::VOID);
     }
-    consumeToken(currentToken.type);
+    consumeToken(currentType());
     
     // 解析函数名
-    if (currentToken.type == TokenType::IDENT) {
-        funcDef->setName(currentToken.stringValue);
+    if (currentType() == TokenType::IDENT) {
+        funcDef->setName(tokens.symbol(position));
         consumeToken(TokenType::IDENT);
     }
     
     // 解析参数列表
     consumeToken(TokenType::LPAREN); // 消费左括号
-    if (currentToken.type != TokenType::RPAREN) {
-        parseFuncParams(funcDef->getParamsRef()); // 解析参数
+    if (currentType() != TokenType::RPAREN) {
+        funcDef->setParams(parseFuncParams()); // 解析参数
     }
     consumeToken(TokenType::RPAREN); // 消费右括号
 
     // 解析函数体
     consumeToken(TokenType::LBRACE); // 消费左花括号
     // 创建函数体的语句块，传递当前行号
-    auto body = std::make_unique<Block>(lexer.getLine());
+    Block* body = arena.make<Block>(currentLine());
     parseStatementList(*body);
-    funcDef->setBody(std::move(body));
+    funcDef->setBody(body);
     consumeToken(TokenType::RBRACE); // 消费右花括号
     
     return funcDef;
 }
 
 // 解析函数参数列表
-// 处理多个函数参数，包括参数类型、参数名和数组参数，并添加到参数列表中
-void Parser::parseFuncParams(std::vector<std::unique_ptr<FuncFParam>>& params) {
+// 处理多个函数参数，包括参数类型、参数名和数组参数，返回参数列表
+NodeList<FuncFParam> Parser::parseFuncParams() {
+    size_t mark = pending.size();
     while (true) {
         // 创建函数参数节点，传递当前行号
-        auto param = std::make_unique<FuncFParam>(Type::INT, "", false, lexer.getLine());
+        FuncFParam* param = arena.make<FuncFParam>(Type::INT, Symbol(0), false, currentLine());
         
         // 解析参数类型
-        if (currentToken.type == TokenType::INT) {
+        if (currentType() == TokenType::INT) {
             param->setType(Type::INT);
-        } else if (currentToken.type == TokenType::FLOAT) {
+        } else if (currentType() == TokenType::FLOAT) {
             param->setType(Type::FLOAT);
         }
-        consumeToken(currentToken.type);
+        consumeToken(currentType());
         
         // 解析参数名
-        if (currentToken.type == TokenType::IDENT) {
-            param->setName(currentToken.stringValue);
+        if (currentType() == TokenType::IDENT) {
+            param->setName(tokens.symbol(position));
             consumeToken(TokenType::IDENT);
         }
         
         // 检查是否是数组参数
-        if (currentToken.type == TokenType::LBRACKET) {
+        if (currentType() == TokenType::LBRACKET) {
             param->setIsArray(true);
             consumeToken(TokenType::LBRACKET); // 消费左方括号
             
             // 解析数组大小
-            if (currentToken.type == TokenType::INT_CONST) {
-                param->setArraySize(currentToken.intValue);
+            if (currentType() == TokenType::INT_CONST) {
+                param->setArraySize(tokens.intValue(position));
                 consumeToken(TokenType::INT_CONST);
             }
             
             consumeToken(TokenType::RBRACKET); // 消费右方括号
         }
         
-        params.push_back(std::move(param)); // 添加参数到列表
+        pending.push_back(param); // 添加参数到列表
         
-        // 检查是否还有下一个参数
-        if (currentToken.type != TokenType::COMMA) {
+        // 检查是否还有下一个参数（出错时结束，由调用者恢复）
+        if (failed || currentType() != TokenType::COMMA) {
             break; // 没有逗号，参数列表结束
         }
         consumeToken(TokenType::COMMA); // 消费逗号，准备解析下一个参数
     }
+    return finishList<FuncFParam>(mark);
 }
 
 // 解析变量定义
-// 处理变量声明，包括变量类型、变量名、数组变量和初始化值，并生成变量声明节点
-std::unique_ptr<VarDecl> Parser::parseVarDef() {
+// 处理变量声明，包括const修饰、变量类型、变量名、数组各维的长度和初始化值，并生成变量声明节点
+VarDecl* Parser::parseVarDef() {
+    // 常量声明
+    bool isConst = false;
+    if (currentType() == TokenType::CONST) {
+        isConst = true;
+        consumeToken(TokenType::CONST);
+    }
+    
     // 解析变量类型
     Type varType;
-    if (currentToken.type == TokenType::INT) {
+    if (currentType() == TokenType::INT) {
         varType = Type::INT;
-    } else if (currentToken.type == TokenType::FLOAT) {
+    } else if (currentType() == TokenType::FLOAT) {
         varType = Type::FLOAT;
     } else {
         // 只有INT和FLOAT类型是允许的变量类型
-        std::string errorMsg = "B:" + std::to_string(currentToken.line) + ":Invalid variable type, expected int or float"; 
-        throw std::runtime_error(errorMsg);
+        reportError("Invalid variable type, expected int or float");
+        return nullptr;
     }
-    consumeToken(currentToken.type);
+    consumeToken(currentType());
     
     // 创建变量声明节点，传递当前行号
-    auto varDecl = std::make_unique<VarDecl>(varType, false, lexer.getLine());
+    VarDecl* varDecl = arena.make<VarDecl>(varType, isConst, currentLine());
+    size_t mark = pending.size();
     
     // 解析变量列表
     bool hasVariable = false;
     while (true) {
         // 解析变量名
-        std::string varName;
-        if (currentToken.type == TokenType::IDENT) {
-            varName = currentToken.stringValue;
+        Symbol varName(0);
+        if (currentType() == TokenType::IDENT) {
+            varName = tokens.symbol(position);
             consumeToken(TokenType::IDENT);
             hasVariable = true;
         } else {
@@ -236,244 +339,343 @@ std::unique_ptr<VarDecl> Parser::parseVarDef() {
                 // 如果已经解析了变量，检查分号
                 break;
             } else {
-                // 如果没有解析到任何变量，抛出异常
-                std::string errorMsg = "B:" + std::to_string(currentToken.line) + ":Invalid variable declaration"; 
-                throw std::runtime_error(errorMsg);
+                // 如果没有解析到任何变量，报告错误
+                reportError("Invalid variable declaration");
+                break;
             }
         }
         
         // 检查是否是数组变量
         bool isArray = false;
-        int arraySize = 0;
-        // 支持多维数组
-        while (currentToken.type == TokenType::LBRACKET) {
+        size_t dimMark = pending.size();
+        // 支持多维数组，每一维的长度是一个表达式，由语义分析求值
+        while (!failed && currentType() == TokenType::LBRACKET) {
             isArray = true;
             consumeToken(TokenType::LBRACKET); // 消费左方括号
             
-            // 解析数组大小
-            if (currentToken.type == TokenType::INT_CONST) {
-                arraySize = currentToken.intValue;
-                consumeToken(TokenType::INT_CONST);
-            }
+            // 解析数组大小，省略时记为nullptr
+            pending.push_back(currentType() == TokenType::RBRACKET ? nullptr : parseExpression());
             
             consumeToken(TokenType::RBRACKET); // 消费右方括号
         }
+        NodeList<Expr> dims = finishList<Expr>(dimMark);
         
         // 检查是否有初始化值
-        std::unique_ptr<Expr> initExpr = nullptr;
-        if (currentToken.type == TokenType::ASSIGN) {
+        Expr* initExpr = nullptr;
+        if (currentType() == TokenType::ASSIGN) {
             consumeToken(TokenType::ASSIGN);
             initExpr = parseExpression();
         }
         
         // 创建变量定义节点，传递当前行号
-        auto varDef = std::make_unique<VarDef>(varName, std::move(initExpr), isArray, lexer.getLine());
+        VarDef* varDef = arena.make<VarDef>(varName, initExpr, isArray, currentLine());
+        varDef->setDecl(varDecl);
+        varDef->setDims(dims);
         
         // 添加变量定义到变量声明
-        varDecl->addVarDef(std::move(varDef));
+        pending.push_back(varDef);
         
-        // 检查是否还有下一个变量
-        if (currentToken.type != TokenType::COMMA) {
+        // 检查是否还有下一个变量（出错时结束，由调用者恢复）
+        if (failed || currentType() != TokenType::COMMA) {
             break; // 没有逗号，变量列表结束
         }
         consumeToken(TokenType::COMMA); // 消费逗号，准备解析下一个变量
     }
+    varDecl->setVarDefs(finishList<VarDef>(mark));
+    if (failed) {
+        return nullptr;
+    }
     
     // 消费分号，变量定义结束
     // 变量声明通常以分号结束，但也可能遇到其他语法结构
-    if (currentToken.type == TokenType::SEMICOLON) {
+    if (currentType() == TokenType::SEMICOLON) {
         consumeToken(TokenType::SEMICOLON);
-    } else if (currentToken.type == TokenType::RBRACE || currentToken.type == TokenType::RPAREN || 
-               currentToken.type == TokenType::COMMA) {
+    } else if (currentType() == TokenType::RBRACE || currentType() == TokenType::RPAREN || 
+               currentType() == TokenType::COMMA) {
         // 如果遇到语法结构结束符，不消费并留给调用者处理
         return varDecl;
-    } else if (currentToken.type != TokenType::END_OF_FILE) {
-        // 如果不是分号且不是文件结束，抛出异常
-        std::string errorMsg = "B:" + std::to_string(currentToken.line) + ":Missing semicolon at end of variable declaration"; 
-        throw std::runtime_error(errorMsg);
+    } else if (currentType() != TokenType::END_OF_FILE) {
+        // 如果不是分号且不是文件结束，报告错误
+        reportError("Missing semicolon at end of variable declaration");
+        return nullptr;
     }
     
     return varDecl;
 }
 
-// 解析表达式
-// 处理各种类型的表达式，如常量、变量、二元表达式等
-std::unique_ptr<Expr> Parser::parseExpression() {
-    return parseBinaryExpression();
+// 二元运算符的优先级表，按TokenType下标查找，0表示不是二元运算符
+// 从低到高：赋值 < || < && < 相等比较 < 关系比较 < 加减 < 乘除取模；一元运算符高于所有二元运算符
+namespace {
+
+constexpr int UNARY_PRECEDENCE = 8; // 一元运算符的优先级
+
+constexpr std::array<uint8_t, 256> makePrecedenceTable() {
+    std::array<uint8_t, 256> table{};
+    table[static_cast<size_t>(TokenType::ASSIGN)] = 1;
+    table[static_cast<size_t>(TokenType::OR)] = 2;
+    table[static_cast<size_t>(TokenType::AND)] = 3;
+    table[static_cast<size_t>(TokenType::EQ)] = 4;
+    table[static_cast<size_t>(TokenType::NE)] = 4;
+    table[static_cast<size_t>(TokenType::LT)] = 5;
+    table[static_cast<size_t>(TokenType::GT)] = 5;
+    table[static_cast<size_t>(TokenType::LE)] = 5;
+    table[static_cast<size_t>(TokenType::GE)] = 5;
+    table[static_cast<size_t>(TokenType::PLUS)] = 6;
+    table[static_cast<size_t>(TokenType::MINUS)] = 6;
+    table[static_cast<size_t>(TokenType::MUL)] = 7;
+    table[static_cast<size_t>(TokenType::DIV)] = 7;
+    table[static_cast<size_t>(TokenType::MOD)] = 7;
+    return table;
 }
 
-// 解析二元表达式
-// 处理二元运算符的表达式，如a + b, x * y等
-std::unique_ptr<Expr> Parser::parseBinaryExpression() {
-    // 解析左操作数
-    auto left = parseUnaryExpression();
-    
-    // 处理二元运算符
-    while (true) {
-        TokenType opType = currentToken.type;
-        if (opType == TokenType::PLUS || opType == TokenType::MINUS || 
-            opType == TokenType::MUL || opType == TokenType::DIV || 
-            opType == TokenType::LT || opType == TokenType::GT || 
-            opType == TokenType::LE || opType == TokenType::GE || 
-            opType == TokenType::EQ || opType == TokenType::NE) {
-            
-            consumeToken(opType); // 消费运算符
-            
-            // 解析右操作数
-            auto right = parseUnaryExpression();
-            
-            // 创建二元表达式节点
-            left = std::make_unique<BinaryExpr>(std::move(left), opType, std::move(right));
-        } else if (opType == TokenType::ASSIGN) {
-            consumeToken(opType); // 消费赋值运算符
-            
-            // 解析右操作数（赋值运算符是右结合的）
-            auto right = parseBinaryExpression();
-            
-            // 创建赋值表达式节点
-            left = std::make_unique<BinaryExpr>(std::move(left), opType, std::move(right));
-        } else {
-            break; // 不是二元运算符，结束解析
-        }
+constexpr std::array<uint8_t, 256> BINARY_PRECEDENCE = makePrecedenceTable();
+
+// 获取二元运算符的优先级
+int binaryPrecedence(TokenType type) {
+    return BINARY_PRECEDENCE[static_cast<size_t>(type)];
+}
+
+} // namespace
+
+// 获取运算符栈中一项的优先级，括号、下标和函数调用的边界项为0，规约到它们为止
+int Parser::precedence(const OperatorEntry& entry) {
+    switch (entry.kind) {
+        case OperatorEntry::Kind::BINARY: return binaryPrecedence(entry.op);
+        case OperatorEntry::Kind::UNARY: return UNARY_PRECEDENCE;
+        default: return 0;
     }
+}
+
+// 规约运算符栈顶的一个运算符
+// 从操作数栈弹出它的操作数，生成二元或一元表达式节点后压回操作数栈，节点的行号为运算符所在的行
+void Parser::reduceOperator() {
+    OperatorEntry entry = operators.back();
+    operators.pop_back();
     
-    return left;
+    if (entry.kind == OperatorEntry::Kind::UNARY) {
+        Expr* operand = operands.back();
+        operands.back() = arena.make<UnaryExpr>(entry.op, operand, entry.line);
+    } else {
+        Expr* right = operands.back();
+        operands.pop_back();
+        Expr* left = operands.back();
+        operands.back() = arena.make<BinaryExpr>(left, entry.op, right, entry.line);
+    }
 }
 
-// 解析一元表达式
-// 处理一元运算符的表达式，如-x, !b等
-std::unique_ptr<Expr> Parser::parseUnaryExpression() {
-    // 检查是否是一元运算符
-    if (currentToken.type == TokenType::MINUS || currentToken.type == TokenType::NOT) {
-        TokenType opType = currentToken.type;
-        consumeToken(opType); // 消费运算符
-        
-        // 解析操作数
-        auto operand = parseUnaryExpression();
-        
-        // 创建一元表达式节点
-        return std::make_unique<UnaryExpr>(opType, std::move(operand));
+// 规约运算符栈中优先级不低于minPrecedence的运算符，遇到边界项或本次解析的栈底为止
+void Parser::reduceOperators(int minPrecedence, size_t operatorBase) {
+    while (operators.size() > operatorBase && precedence(operators.back()) >= minPrecedence &&
+           precedence(operators.back()) > 0) {
+        reduceOperator();
     }
-    
-    // 不是一元表达式，解析基本表达式
-    return parsePrimaryExpression();
 }
 
-// 解析基本表达式
-// 处理常量、变量、函数调用等基本表达式
-std::unique_ptr<Expr> Parser::parsePrimaryExpression() {
-    std::unique_ptr<Expr> expr;
+// 解析表达式
+// 用显式的操作数栈和运算符栈做优先级爬升（调度场算法），括号、数组下标和函数调用实参也在栈上处理，
+// 因此表达式的长度和嵌套深度都不消耗调用栈，整个表达式按Token线性解析
+// 遇到不能继续表达式的Token（如分号、不匹配的右括号、声明中的逗号）时结束，由调用者处理该Token
+// 出错时记录错误，丢弃本次解析压入各个栈的内容并返回nullptr
+Expr* Parser::parseExpression() {
+    if (failed) {
+        return nullptr;
+    }
+    size_t operandBase = operands.size();
+    size_t operatorBase = operators.size();
+    size_t pendingBase = pending.size();
+    bool expectOperand = true; // true：等待操作数（前缀位置）；false：等待运算符（后缀位置）
+    bool indexable = false;    // 刚解析完的操作数能否继续接数组下标（变量或数组元素）
     
-    // 根据当前Token类型解析不同的表达式
-    switch (currentToken.type) {
-        case TokenType::INT_CONST: {
-            // 整数常量表达式，传递当前行号
-            expr = std::make_unique<NumberExpr>(currentToken.intValue, lexer.getLine());
-            consumeToken(TokenType::INT_CONST);
-            break;
-        }
-        case TokenType::FLOAT_CONST: {
-            // 浮点数常量表达式，传递当前行号
-            expr = std::make_unique<NumberExpr>(currentToken.floatValue, lexer.getLine());
-            consumeToken(TokenType::FLOAT_CONST);
-            break;
-        }
-        case TokenType::IDENT: {
-            // 标识符表达式，可能是变量、函数调用或数组访问
-            std::string identName = currentToken.stringValue;
-            consumeToken(TokenType::IDENT);
-            
-            // 首先创建变量表达式作为基础，传递当前行号
-            expr = std::make_unique<VariableExpr>(identName, lexer.getLine());
-            
-            // 检查是否是数组访问（可能有多个维度）
-            while (currentToken.type == TokenType::LBRACKET) {
-                consumeToken(TokenType::LBRACKET);
-                
-                // 解析数组索引表达式
-                auto indexExpr = parseExpression();
-                
-                consumeToken(TokenType::RBRACKET);
-                
-                // 创建数组访问表达式节点，将当前表达式作为左操作数
-                expr = std::make_unique<IndexExpr>(std::move(expr), std::move(indexExpr));
-            }
-            
-            // 检查是否是函数调用（在数组访问之后检查，因为可能有func()[index]这样的表达式）
-            if (currentToken.type == TokenType::LPAREN) {
-                consumeToken(TokenType::LPAREN);
-                
-                // 解析函数参数列表
-                std::vector<std::unique_ptr<Expr>> args;
-                if (currentToken.type != TokenType::RPAREN) {
-                    // 解析第一个参数
-                    args.push_back(parseExpression());
-                    
-                    // 解析后续参数
-                    while (currentToken.type == TokenType::COMMA) {
-                        consumeToken(TokenType::COMMA);
-                        args.push_back(parseExpression());
+    while (true) {
+        TokenType type = currentType();
+        
+        if (expectOperand) {
+            switch (type) {
+                case TokenType::PLUS:
+                case TokenType::MINUS:
+                case TokenType::NOT:
+                    // 一元运算符
+                    operators.push_back({OperatorEntry::Kind::UNARY, type, Symbol(0), 0, currentLine()});
+                    advanceToken();
+                    continue;
+                case TokenType::LPAREN:
+                    // 括号表达式
+                    operators.push_back({OperatorEntry::Kind::GROUP, type, Symbol(0), 0, currentLine()});
+                    advanceToken();
+                    continue;
+                case TokenType::INT_CONST:
+                    // 整数常量表达式，传递当前行号
+                    operands.push_back(arena.make<NumberExpr>(tokens.intValue(position), currentLine()));
+                    advanceToken();
+                    indexable = false;
+                    break;
+                case TokenType::FLOAT_CONST:
+                    // 浮点数常量表达式，传递当前行号
+                    operands.push_back(arena.make<NumberExpr>(tokens.floatValue(position), currentLine()));
+                    advanceToken();
+                    indexable = false;
+                    break;
+                case TokenType::IDENT: {
+                    // 标识符表达式：变量、数组访问或函数调用
+                    Symbol identName = tokens.symbol(position);
+                    advanceToken();
+                    if (currentType() == TokenType::LPAREN) {
+                        // 函数调用：实参依次收集到pending中，在右括号处生成节点
+                        advanceToken();
+                        if (currentType() == TokenType::RPAREN) {
+                            advanceToken();
+                            operands.push_back(arena.make<CallExpr>(identName, NodeList<Expr>(), currentLine()));
+                            indexable = false;
+                            break;
+                        }
+                        operators.push_back({OperatorEntry::Kind::CALL, type, identName,
+                                             static_cast<uint32_t>(pending.size()), currentLine()});
+                        continue;
                     }
+                    operands.push_back(arena.make<VariableExpr>(identName, currentLine()));
+                    indexable = true;
+                    break;
                 }
-                
-                consumeToken(TokenType::RPAREN);
-                
-                // 创建函数调用表达式节点，传递当前行号
-                expr = std::make_unique<CallExpr>(identName, std::move(args), lexer.getLine());
+                default:
+                    // 未知的表达式类型
+                    reportError("Unexpected token in expression parsing");
+                    break;
             }
-            break;
+            if (failed) {
+                break;
+            }
+            expectOperand = false;
+            continue;
         }
-        case TokenType::LPAREN: {
-            // 括号表达式
-            consumeToken(TokenType::LPAREN);
-            expr = parseExpression();
-            consumeToken(TokenType::RPAREN);
-            break;
+        
+        // 后缀位置：二元运算符、数组下标，或者结束括号、下标、实参
+        int binary = binaryPrecedence(type);
+        if (binary > 0) {
+            // 左结合运算符先规约同级运算符，赋值是右结合的，只规约更高优先级的运算符
+            reduceOperators(type == TokenType::ASSIGN ? binary + 1 : binary, operatorBase);
+            operators.push_back({OperatorEntry::Kind::BINARY, type, Symbol(0), 0, currentLine()});
+            advanceToken();
+            expectOperand = true;
+            continue;
+        }
+        
+        if (type == TokenType::LBRACKET && indexable) {
+            // 数组下标，可以有多个维度
+            operators.push_back({OperatorEntry::Kind::INDEX, type, Symbol(0), 0, currentLine()});
+            advanceToken();
+            expectOperand = true;
+            continue;
+        }
+        
+        // 其余Token只可能结束某个括号、下标或实参；先规约到最近的边界项
+        reduceOperators(1, operatorBase);
+        const OperatorEntry* frame = operators.size() > operatorBase ? &operators.back() : nullptr;
+        
+        if (type == TokenType::RPAREN && frame && frame->kind == OperatorEntry::Kind::GROUP) {
+            operators.pop_back();
+            advanceToken();
+            indexable = false;
+            continue;
         }
-        default:
-            // 未知的表达式类型，抛出异常
-            std::string errorMsg = "B:" + std::to_string(currentToken.line) + ":Unexpected token in expression parsing"; 
-            throw std::runtime_error(errorMsg);
+        if (type == TokenType::RBRACKET && frame && frame->kind == OperatorEntry::Kind::INDEX) {
+            int line = frame->line;
+            operators.pop_back();
+            advanceToken();
+            // 创建数组访问表达式节点，将下标之前的表达式作为基地址，行号为左方括号所在的行
+            Expr* index = operands.back();
+            operands.pop_back();
+            operands.back() = arena.make<IndexExpr>(operands.back(), index, line);
+            indexable = true;
+            continue;
+        }
+        if ((type == TokenType::COMMA || type == TokenType::RPAREN) && frame &&
+            frame->kind == OperatorEntry::Kind::CALL) {
+            pending.push_back(operands.back());
+            operands.pop_back();
+            advanceToken();
+            if (type == TokenType::COMMA) {
+                expectOperand = true;
+                continue;
+            }
+            // 创建函数调用表达式节点，传递当前行号
+            OperatorEntry call = operators.back();
+            operators.pop_back();
+            operands.push_back(arena.make<CallExpr>(call.callee, finishList<Expr>(call.argMark), currentLine()));
+            indexable = false;
+            continue;
+        }
+        
+        // 表达式结束：不能有未闭合的括号、下标或实参列表
+        if (frame) {
+            consumeToken(frame->kind == OperatorEntry::Kind::INDEX ? TokenType::RBRACKET : TokenType::RPAREN);
+        }
+        break;
     }
     
-    return expr;
+    Expr* result = failed ? nullptr : operands.back();
+    operands.resize(operandBase);
+    operators.resize(operatorBase);
+    pending.resize(pendingBase);
+    return result;
 }
 
 // 解析语句列表
 // 处理一系列语句，如变量声明、赋值语句、控制流语句等
+// 语句出错时在这里恢复：跳到语句边界后继续解析后面的语句，从而一次报告所有语法错误
 void Parser::parseStatementList(Block& block) {
-    while (currentToken.type != TokenType::RBRACE && currentToken.type != TokenType::END_OF_FILE) {
+    size_t mark = pending.size();
+    while (currentType() != TokenType::RBRACE && currentType() != TokenType::END_OF_FILE) {
         // 解析单个语句
-        auto stmt = parseStatement();
-        if (stmt) {
-            block.addStatement(std::move(stmt));
+        Stmt* stmt = parseStatement();
+        if (failed) {
+            synchronize();
+        } else if (stmt) {
+            pending.push_back(stmt);
         }
     }
+    block.setStatements(finishList<Stmt>(mark));
+}
+
+// 解析花括号包围的语句块（当前Token为'{'）
+Block* Parser::parseBlock() {
+    consumeToken(TokenType::LBRACE);
+    Block* block = arena.make<Block>(currentLine());
+    parseStatementList(*block);
+    if (!consumeToken(TokenType::RBRACE)) {
+        return nullptr;
+    }
+    return block;
 }
 
 // 解析单个语句
-// 处理变量声明、赋值语句、控制流语句等
-std::unique_ptr<Stmt> Parser::parseStatement() {
-    switch (currentToken.type) {
+// 处理变量声明、赋值语句、控制流语句等；出错时返回nullptr，由parseStatementList恢复
+Stmt* Parser::parseStatement() {
+    switch (currentType()) {
+        case TokenType::CONST:
         case TokenType::INT: 
         case TokenType::FLOAT: {
             // 变量声明语句 - 直接调用parseVarDef，它会处理变量声明并返回
-            auto varDecl = parseVarDef();
+            VarDecl* varDecl = parseVarDef();
+            if (failed) {
+                return nullptr;
+            }
             // 创建一个声明语句，将VarDecl包装起来添加到Block，传递当前行号
-            return std::make_unique<DeclStmt>(std::move(varDecl), lexer.getLine());
+            return arena.make<DeclStmt>(varDecl, currentLine());
         }
         case TokenType::RETURN: {
             // return语句
             consumeToken(TokenType::RETURN);
             
-            std::unique_ptr<Expr> expr = nullptr;
-            if (currentToken.type != TokenType::SEMICOLON) {
+            Expr* expr = nullptr;
+            if (currentType() != TokenType::SEMICOLON) {
                 expr = parseExpression();
             }
             
-            consumeToken(TokenType::SEMICOLON);
+            if (!consumeToken(TokenType::SEMICOLON)) {
+                return nullptr;
+            }
             
-            return std::make_unique<ReturnStmt>(std::move(expr), lexer.getLine());
+            return arena.make<ReturnStmt>(expr, currentLine());
         }
         case TokenType::IF: {
             // if语句
@@ -481,39 +683,28 @@ std::unique_ptr<Stmt> Parser::parseStatement() {
             
             // 解析条件表达式
             consumeToken(TokenType::LPAREN);
-            auto condition = parseExpression();
-            consumeToken(TokenType::RPAREN);
+            Expr* condition = parseExpression();
+            if (!consumeToken(TokenType::RPAREN)) {
+                return nullptr;
+            }
             
-            // 解析then语句块
-            std::unique_ptr<Stmt> thenStmt;
-            if (currentToken.type == TokenType::LBRACE) {
-                // 语句块
-                consumeToken(TokenType::LBRACE);
-                thenStmt = std::make_unique<Block>(lexer.getLine());
-                parseStatementList(*static_cast<Block*>(thenStmt.get()));
-                consumeToken(TokenType::RBRACE);
-            } else {
-                // 单个语句
-                thenStmt = parseStatement();
+            // 解析then语句块（语句块或单个语句）
+            Stmt* thenStmt = currentType() == TokenType::LBRACE ? parseBlock() : parseStatement();
+            if (failed) {
+                return nullptr;
             }
             
             // 解析可选的else语句块
-            std::unique_ptr<Stmt> elseStmt = nullptr;
-            if (currentToken.type == TokenType::ELSE) {
+            Stmt* elseStmt = nullptr;
+            if (currentType() == TokenType::ELSE) {
                 consumeToken(TokenType::ELSE);
-                if (currentToken.type == TokenType::LBRACE) {
-                    // 语句块
-                    consumeToken(TokenType::LBRACE);
-                    elseStmt = std::make_unique<Block>(lexer.getLine());
-                    parseStatementList(*static_cast<Block*>(elseStmt.get()));
-                    consumeToken(TokenType::RBRACE);
-                } else {
-                    // 单个语句
-                    elseStmt = parseStatement();
+                elseStmt = currentType() == TokenType::LBRACE ? parseBlock() : parseStatement();
+                if (failed) {
+                    return nullptr;
                 }
             }
             
-            return std::make_unique<IfStmt>(std::move(condition), std::move(thenStmt), std::move(elseStmt), lexer.getLine());
+            return arena.make<IfStmt>(condition, thenStmt, elseStmt, currentLine());
         }
         case TokenType::WHILE: {
             // while语句
@@ -521,29 +712,46 @@ std::unique_ptr<Stmt> Parser::parseStatement() {
             
             // 解析条件表达式
             consumeToken(TokenType::LPAREN);
-            auto condition = parseExpression();
-            consumeToken(TokenType::RPAREN);
+            Expr* condition = parseExpression();
+            if (!consumeToken(TokenType::RPAREN)) {
+                return nullptr;
+            }
             
             // 解析循环体
-            auto body = parseStatement();
+            Stmt* body = parseStatement();
+            if (failed) {
+                return nullptr;
+            }
             
-            return std::make_unique<WhileStmt>(std::move(condition), std::move(body), lexer.getLine());
+            return arena.make<WhileStmt>(condition, body, currentLine());
+        }
+        case TokenType::BREAK:
+        case TokenType::CONTINUE: {
+            // break语句和continue语句，是否位于循环中由语义分析检查
+            TokenType type = currentType();
+            int line = currentLine();
+            consumeToken(type);
+            if (!consumeToken(TokenType::SEMICOLON)) {
+                return nullptr;
+            }
+
+            if (type == TokenType::BREAK) {
+                return arena.make<BreakStmt>(line);
+            }
+            return arena.make<ContinueStmt>(line);
         }
         case TokenType::LBRACE: {
             // 语句块
-            consumeToken(TokenType::LBRACE);
-            auto block = std::make_unique<Block>(lexer.getLine());
-            parseStatementList(*block);
-            consumeToken(TokenType::RBRACE);
-            
-            return block;
+            return parseBlock();
         }
         default: {
             // 表达式语句
-            auto expr = parseExpression();
-            consumeToken(TokenType::SEMICOLON);
+            Expr* expr = parseExpression();
+            if (!consumeToken(TokenType::SEMICOLON)) {
+                return nullptr;
+            }
             
-            return std::make_unique<ExprStmt>(std::move(expr), lexer.getLine());
+            return arena.make<ExprStmt>(expr, currentLine());
         }
     }
 }
@@ -0,0 +1,245 @@
+#include "../include/pass_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 依赖关系：丢弃一个分析时，依赖它的分析也要丢弃
+constexpr AnalysisSet dependents(Analysis analysis) {
+    return analysis == Analysis::DOMINATOR_TREE ? analysisSet(Analysis::DOMINANCE_FRONTIER) : NO_ANALYSES;
+}
+
+} // namespace
+
+// 构造函数
+AnalysisManager::AnalysisManager() : timing(false), computeMs(), computeCount() {}
+
+// 计时并计数
+template <typename Func>
+void AnalysisManager::measure(Analysis analysis, Func&& func) {
+    uint32_t index = static_cast<uint32_t>(analysis);
+    computeCount[index]++;
+    if (!timing) {
+        func();
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    func();
+    computeMs[index] += elapsedMs(start);
+}
+
+// 支配树
+DominatorTree& AnalysisManager::getDominatorTree(Function& function) {
+    FunctionAnalyses& entry = cache[&function];
+    if (!entry.domTree) {
+        measure(Analysis::DOMINATOR_TREE, [&] {
+            entry.domTree = std::make_unique<DominatorTree>(function);
+        });
+    }
+    return *entry.domTree;
+}
+
+// 后支配树
+PostDominatorTree& AnalysisManager::getPostDominatorTree(Function& function) {
+    FunctionAnalyses& entry = cache[&function];
+    if (!entry.postDomTree) {
+        measure(Analysis::POST_DOMINATOR_TREE, [&] {
+            entry.postDomTree = std::make_unique<PostDominatorTree>(function);
+        });
+    }
+    return *entry.postDomTree;
+}
+
+// 支配边界：先取得它所依据的支配树
+DominanceFrontier& AnalysisManager::getDominanceFrontier(Function& function) {
+    DominatorTree& domTree = getDominatorTree(function);
+    FunctionAnalyses& entry = cache[&function];
+    if (!entry.frontier) {
+        measure(Analysis::DOMINANCE_FRONTIER, [&] {
+            entry.frontier = std::make_unique<DominanceFrontier>(domTree);
+        });
+    }
+    return *entry.frontier;
+}
+
+// 确保analyses中的分析都已计算
+void AnalysisManager::compute(Function& function, AnalysisSet analyses) {
+    if (analyses & analysisSet(Analysis::DOMINATOR_TREE)) {
+        getDominatorTree(function);
+    }
+    if (analyses & analysisSet(Analysis::POST_DOMINATOR_TREE)) {
+        getPostDominatorTree(function);
+    }
+    if (analyses & analysisSet(Analysis::DOMINANCE_FRONTIER)) {
+        getDominanceFrontier(function);
+    }
+}
+
+// 分析是否已缓存
+bool AnalysisManager::isCached(const Function& function, Analysis analysis) const {
+    auto it = cache.find(&function);
+    if (it == cache.end()) {
+        return false;
+    }
+    switch (analysis) {
+        case Analysis::DOMINATOR_TREE:
+            return it->second.domTree != nullptr;
+        case Analysis::POST_DOMINATOR_TREE:
+            return it->second.postDomTree != nullptr;
+        case Analysis::DOMINANCE_FRONTIER:
+            return it->second.frontier != nullptr;
+    }
+    return false;
+}
+
+// 丢弃没有保留的分析
+void AnalysisManager::invalidate(const Function& function, AnalysisSet preserved) {
+    auto it = cache.find(&function);
+    if (it == cache.end()) {
+        return;
+    }
+    AnalysisSet dropped = ALL_ANALYSES & ~preserved;
+    for (uint32_t i = 0; i < ANALYSIS_COUNT; i++) {
+        if (dropped & (1u << i)) {
+            dropped |= dependents(static_cast<Analysis>(i));
+        }
+    }
+    FunctionAnalyses& entry = it->second;
+    // 先丢弃依赖其他分析的结果
+    if (dropped & analysisSet(Analysis::DOMINANCE_FRONTIER)) {
+        entry.frontier.reset();
+    }
+    if (dropped & analysisSet(Analysis::DOMINATOR_TREE)) {
+        entry.domTree.reset();
+    }
+    if (dropped & analysisSet(Analysis::POST_DOMINATOR_TREE)) {
+        entry.postDomTree.reset();
+    }
+}
+
+// 全部分析累计的计算时间
+double AnalysisManager::getTotalComputeMs() const {
+    double total = 0;
+    for (double ms : computeMs) {
+        total += ms;
+    }
+    return total;
+}
+
+// 分析的名字
+const char* AnalysisManager::getName(Analysis analysis) {
+    switch (analysis) {
+        case Analysis::DOMINATOR_TREE:
+            return "domtree";
+        case Analysis::POST_DOMINATOR_TREE:
+            return "postdomtree";
+        case Analysis::DOMINANCE_FRONTIER:
+            return "domfrontier";
+    }
+    return "unknown";
+}
+
+// 构造函数
+PassManager::PassManager() : printStream(nullptr), timePasses(false) {}
+
+// 添加Pass
+void PassManager::add(std::unique_ptr<FunctionPass> pass) {
+    passes.push_back(std::move(pass));
+    stats.push_back(PassStats{0, 0, 0});
+}
+
+// -print-after
+void PassManager::setPrintAfter(const std::string& name, std::ostream& out) {
+    printAfter = name;
+    printStream = &out;
+}
+
+// -time-passes
+void PassManager::setTimePasses(bool value) {
+    timePasses = value;
+    analyses.setTiming(value);
+}
+
+// 对模块中的每个函数运行全部Pass
+void PassManager::run(Module& module) {
+    for (const auto& function : module.getFunctions()) {
+        run(*function);
+    }
+}
+
+// 对一个函数依次运行全部Pass
+// 计时时从Pass的耗时中减去其中计算分析的时间，分析的耗时单独统计
+void PassManager::run(Function& function) {
+    for (size_t i = 0; i < passes.size(); i++) {
+        FunctionPass& pass = *passes[i];
+        analyses.compute(function, pass.getRequired());
+        bool changed;
+        if (timePasses) {
+            double analysisBefore = analyses.getTotalComputeMs();
+            auto start = std::chrono::steady_clock::now();
+            changed = pass.run(function, analyses);
+            stats[i].ms += elapsedMs(start) - (analyses.getTotalComputeMs() - analysisBefore);
+        } else {
+            changed = pass.run(function, analyses);
+        }
+        stats[i].runs++;
+        if (changed) {
+            stats[i].changes++;
+            analyses.invalidate(function, pass.getPreserved());
+        }
+        if (printStream != nullptr && (printAfter == "all" || printAfter == pass.getName())) {
+            *printStream << "; *** IR after " << pass.getName() << " on @" << function.getName() << " ***\n";
+            printFunction(function, *printStream);
+        }
+    }
+    analyses.release(function);
+}
+
+// 输出耗时统计
+void PassManager::printTimeReport(std::ostream& out) const {
+    struct Row {
+        const char* name;
+        double ms;
+        size_t runs;
+        size_t changes;
+        bool isAnalysis;
+    };
+    std::vector<Row> rows;
+    double total = 0;
+    for (size_t i = 0; i < passes.size(); i++) {
+        rows.push_back(Row{passes[i]->getName(), stats[i].ms, stats[i].runs, stats[i].changes, false});
+        total += stats[i].ms;
+    }
+    for (uint32_t i = 0; i < ANALYSIS_COUNT; i++) {
+        Analysis analysis = static_cast<Analysis>(i);
+        if (analyses.getComputeCount(analysis) > 0) {
+            rows.push_back(Row{AnalysisManager::getName(analysis), analyses.getComputeMs(analysis),
+                               analyses.getComputeCount(analysis), 0, true});
+            total += analyses.getComputeMs(analysis);
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.ms > b.ms; });
+
+    char line[128];
+    out << "===--- Pass execution timing report ---===\n";
+    std::snprintf(line, sizeof(line), "  Total: %.3f ms\n", total);
+    out << line;
+    out << "   Time (ms)       %      Runs   Changed  Name\n";
+    for (const Row& row : rows) {
+        double percent = total > 0 ? row.ms * 100 / total : 0;
+        if (row.isAnalysis) {
+            std::snprintf(line, sizeof(line), "%12.3f  %5.1f%%  %8zu         -  %s (analysis)\n", row.ms, percent,
+                          row.runs, row.name);
+        } else {
+            std::snprintf(line, sizeof(line), "%12.3f  %5.1f%%  %8zu  %8zu  %s\n", row.ms, percent, row.runs,
+                          row.changes, row.name);
+        }
+        out << line;
+    }
+    out.flush();
+}
@@ -0,0 +1,469 @@
+#include "../include/passes.h"
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// 基本块是否以φ函数开头
+bool startsWithPhi(const BasicBlock* block) {
+    return block->getFirst() != nullptr && block->getFirst()->getOpcode() == Opcode::PHI;
+}
+
+// 从block的φ函数中删除一个来自pred的值（同一前驱有两条边时只删除一个）
+void removePhiIncoming(BasicBlock* block, const BasicBlock* pred) {
+    for (Instruction* inst = block->getFirst(); inst != nullptr && inst->getOpcode() == Opcode::PHI;
+         inst = inst->getNext()) {
+        for (uint32_t i = 0; i < inst->getBlockCount(); i++) {
+            if (inst->getBlock(i) == pred) {
+                inst->removeIncoming(i);
+                break;
+            }
+        }
+    }
+}
+
+// 把block的终结指令替换为跳到target的无条件跳转
+void replaceWithBr(Function& function, BasicBlock* block, BasicBlock* target) {
+    block->getTerminator()->eraseFromParent();
+    IRBuilder builder(&function);
+    builder.setInsertPoint(block);
+    builder.createBr(target);
+}
+
+// 条件为常量或两个目标相同的条件跳转改为无条件跳转
+bool foldBranches(Function& function) {
+    bool changed = false;
+    for (BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        Instruction* terminator = block->getTerminator();
+        if (terminator == nullptr || terminator->getOpcode() != Opcode::CONDBR) {
+            continue;
+        }
+        BasicBlock* taken;
+        Constant* condition = dyn_cast<Constant>(terminator->getOperand(0));
+        if (terminator->getBlock(0) == terminator->getBlock(1)) {
+            taken = terminator->getBlock(0);
+        } else if (condition != nullptr) {
+            taken = terminator->getBlock(condition->getIntValue() != 0 ? 0 : 1);
+        } else {
+            continue;
+        }
+        // 不再经过的那条边：从目标的φ函数中删除来自本块的值
+        BasicBlock* dropped = terminator->getBlock(0) == taken ? terminator->getBlock(1) : terminator->getBlock(0);
+        removePhiIncoming(dropped, block);
+        replaceWithBr(function, block, taken);
+        changed = true;
+    }
+    return changed;
+}
+
+// 删除从入口不可达的基本块，其余基本块按逆后序重排并编号
+// 与翻译时一样逆序访问后继，使条件跳转的真分支（then、循环体）排在假分支之前
+bool removeUnreachableBlocks(Function& function) {
+    function.renumberBlocks();
+    size_t blockCount = function.getBlockCount();
+    std::vector<uint8_t> visited(blockCount, 0);
+    std::vector<BasicBlock*> postorder;
+    postorder.reserve(blockCount);
+    std::vector<std::pair<BasicBlock*, uint32_t>> stack;
+    visited[0] = 1;
+    stack.push_back({function.getEntry(), 0});
+    while (!stack.empty()) {
+        BasicBlock* block = stack.back().first;
+        uint32_t next = stack.back().second;
+        if (next < block->getSuccessorCount()) {
+            stack.back().second++;
+            BasicBlock* successor = block->getSuccessor(block->getSuccessorCount() - 1 - next);
+            if (!visited[successor->getIndex()]) {
+                visited[successor->getIndex()] = 1;
+                stack.push_back({successor, 0});
+            }
+            continue;
+        }
+        postorder.push_back(block);
+        stack.pop_back();
+    }
+    if (postorder.size() == blockCount) {
+        return false;
+    }
+    function.reorderBlocks(std::vector<BasicBlock*>(postorder.rbegin(), postorder.rend()));
+    return true;
+}
+
+// 只含一条无条件跳转的基本块：前驱直接跳到它的最终目标
+// 目标以φ函数开头时不转发（φ函数按前驱区分来源）；全部由空块组成的环保持不变。需要基本块编号是最新的
+bool forwardEmptyBlocks(Function& function) {
+    size_t blockCount = function.getBlockCount();
+    std::vector<BasicBlock*> forward(blockCount, nullptr); // 空块跳转的目标
+    bool any = false;
+    for (BasicBlock* block = function.getEntry()->getNext(); block != nullptr; block = block->getNext()) {
+        Instruction* first = block->getFirst();
+        if (first != nullptr && first == block->getLast() && first->getOpcode() == Opcode::BR) {
+            BasicBlock* target = first->getBlock(0);
+            if (target != block && !startsWithPhi(target)) {
+                forward[block->getIndex()] = target;
+                any = true;
+            }
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    // 沿空块链找到最终目标，结果记录在resolved中
+    enum : uint8_t { UNVISITED, VISITING, DONE };
+    std::vector<uint8_t> state(blockCount, UNVISITED);
+    std::vector<BasicBlock*> resolved(blockCount, nullptr);
+    std::vector<BasicBlock*> path;
+    auto resolve = [&](BasicBlock* start) {
+        path.clear();
+        BasicBlock* block = start;
+        while (forward[block->getIndex()] != nullptr && state[block->getIndex()] == UNVISITED) {
+            state[block->getIndex()] = VISITING;
+            path.push_back(block);
+            block = forward[block->getIndex()];
+        }
+        BasicBlock* result = block;
+        if (forward[block->getIndex()] != nullptr) {
+            result = state[block->getIndex()] == DONE ? resolved[block->getIndex()] : nullptr;
+        }
+        for (BasicBlock* node : path) {
+            state[node->getIndex()] = DONE;
+            resolved[node->getIndex()] = result != nullptr ? result : node;
+        }
+        return forward[start->getIndex()] != nullptr ? resolved[start->getIndex()] : start;
+    };
+
+    bool changed = false;
+    for (BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        Instruction* terminator = block->getTerminator();
+        if (terminator == nullptr) {
+            continue;
+        }
+        for (uint32_t i = 0; i < terminator->getBlockCount(); i++) {
+            BasicBlock* target = terminator->getBlock(i);
+            if (forward[target->getIndex()] == nullptr) {
+                continue;
+            }
+            BasicBlock* final = resolve(target);
+            if (final != target) {
+                terminator->setBlock(i, final);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+// 唯一前驱以无条件跳转进入的基本块并入前驱。需要基本块编号是最新的
+bool mergeBlocks(Function& function) {
+    size_t blockCount = function.getBlockCount();
+    std::vector<uint32_t> predCount(blockCount, 0);
+    std::vector<BasicBlock*> lastPred(blockCount, nullptr);
+    for (BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        for (uint32_t i = 0; i < block->getSuccessorCount(); i++) {
+            BasicBlock* successor = block->getSuccessor(i);
+            predCount[successor->getIndex()]++;
+            lastPred[successor->getIndex()] = block;
+        }
+    }
+
+    bool changed = false;
+    BasicBlock* next = nullptr;
+    for (BasicBlock* block = function.getEntry()->getNext(); block != nullptr; block = next) {
+        next = block->getNext();
+        BasicBlock* pred = lastPred[block->getIndex()];
+        if (predCount[block->getIndex()] != 1 || pred == block || pred->getTerminator()->getOpcode() != Opcode::BR) {
+            continue;
+        }
+        // 只有一个前驱时φ函数只有一个来源
+        while (startsWithPhi(block)) {
+            Instruction* phi = block->getFirst();
+            phi->replaceAllUsesWith(phi->getOperand(0));
+            phi->eraseFromParent();
+        }
+        pred->getTerminator()->eraseFromParent();
+        Instruction* nextInst = nullptr;
+        for (Instruction* inst = block->getFirst(); inst != nullptr; inst = nextInst) {
+            nextInst = inst->getNext();
+            block->remove(inst);
+            pred->insert(inst, nullptr);
+        }
+        // 后继块的φ函数中来自block的值改为来自pred
+        for (uint32_t i = 0; i < pred->getSuccessorCount(); i++) {
+            BasicBlock* successor = pred->getSuccessor(i);
+            for (Instruction* inst = successor->getFirst(); inst != nullptr && inst->getOpcode() == Opcode::PHI;
+                 inst = inst->getNext()) {
+                for (uint32_t j = 0; j < inst->getBlockCount(); j++) {
+                    if (inst->getBlock(j) == block) {
+                        inst->setBlock(j, pred);
+                    }
+                }
+            }
+            if (lastPred[successor->getIndex()] == block) {
+                lastPred[successor->getIndex()] = pred;
+            }
+        }
+        function.eraseBlock(block);
+        changed = true;
+    }
+    return changed;
+}
+
+// 是否有副作用（不能因为结果没有使用而删除）
+bool hasSideEffects(const Instruction* inst) {
+    return inst->getOpcode() == Opcode::STORE || inst->getOpcode() == Opcode::CALL || inst->isTerminator();
+}
+
+// 整数运算的结果，按32位补码回绕；除数为0或INT_MIN / -1时不折叠
+bool foldInt(Opcode opcode, int left, int right, int& result) {
+    uint32_t a = static_cast<uint32_t>(left);
+    uint32_t b = static_cast<uint32_t>(right);
+    switch (opcode) {
+        case Opcode::ADD:
+            result = static_cast<int>(a + b);
+            return true;
+        case Opcode::SUB:
+            result = static_cast<int>(a - b);
+            return true;
+        case Opcode::MUL:
+            result = static_cast<int>(a * b);
+            return true;
+        case Opcode::SDIV:
+        case Opcode::SREM:
+            if (right == 0 || (left == INT_MIN && right == -1)) {
+                return false;
+            }
+            result = opcode == Opcode::SDIV ? left / right : left % right;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 浮点运算的结果
+bool foldFloat(Opcode opcode, float left, float right, float& result) {
+    switch (opcode) {
+        case Opcode::FADD:
+            result = left + right;
+            return true;
+        case Opcode::FSUB:
+            result = left - right;
+            return true;
+        case Opcode::FMUL:
+            result = left * right;
+            return true;
+        case Opcode::FDIV:
+            result = left / right;
+            return true;
+        case Opcode::FREM:
+            result = std::fmod(left, right);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 比较的结果
+template <typename T>
+bool compare(CmpPredicate predicate, T left, T right) {
+    switch (predicate) {
+        case CmpPredicate::EQ:
+            return left == right;
+        case CmpPredicate::NE:
+            return left != right;
+        case CmpPredicate::LT:
+            return left < right;
+        case CmpPredicate::GT:
+            return left > right;
+        case CmpPredicate::LE:
+            return left <= right;
+        case CmpPredicate::GE:
+            return left >= right;
+    }
+    return false;
+}
+
+// 判断整数常量
+bool isIntConstant(Value* value, int expected) {
+    Constant* constant = dyn_cast<Constant>(value);
+    return constant != nullptr && constant->getType() == IRType::I32 && constant->getIntValue() == expected;
+}
+
+// 化简一条指令，返回替换它的值，不能化简时返回nullptr
+Value* simplify(Function& function, Instruction* inst) {
+    Opcode opcode = inst->getOpcode();
+    if (opcode == Opcode::PHI) {
+        // 全部来源（不计自身）相同
+        Value* common = nullptr;
+        for (uint32_t i = 0; i < inst->getOperandCount(); i++) {
+            Value* incoming = inst->getOperand(i);
+            if (incoming == inst || incoming == common) {
+                continue;
+            }
+            if (common != nullptr) {
+                return nullptr;
+            }
+            common = incoming;
+        }
+        return common;
+    }
+    if (opcode == Opcode::FNEG) {
+        Constant* operand = dyn_cast<Constant>(inst->getOperand(0));
+        return operand != nullptr ? function.getConstant(-operand->getFloatValue()) : nullptr;
+    }
+    bool binary = opcode == Opcode::ADD || opcode == Opcode::SUB || opcode == Opcode::MUL || opcode == Opcode::SDIV ||
+                  opcode == Opcode::SREM || opcode == Opcode::FADD || opcode == Opcode::FSUB ||
+                  opcode == Opcode::FMUL || opcode == Opcode::FDIV || opcode == Opcode::FREM;
+    if (!binary && opcode != Opcode::ICMP && opcode != Opcode::FCMP) {
+        return nullptr;
+    }
+    Value* left = inst->getOperand(0);
+    Value* right = inst->getOperand(1);
+    Constant* leftConstant = dyn_cast<Constant>(left);
+    Constant* rightConstant = dyn_cast<Constant>(right);
+    if (leftConstant != nullptr && rightConstant != nullptr) {
+        if (opcode == Opcode::ICMP) {
+            return function.getConstant(
+                compare(inst->getPredicate(), leftConstant->getIntValue(), rightConstant->getIntValue()) ? 1 : 0);
+        }
+        if (opcode == Opcode::FCMP) {
+            return function.getConstant(
+                compare(inst->getPredicate(), leftConstant->getFloatValue(), rightConstant->getFloatValue()) ? 1 : 0);
+        }
+        int intResult;
+        if (foldInt(opcode, leftConstant->getIntValue(), rightConstant->getIntValue(), intResult)) {
+            return function.getConstant(intResult);
+        }
+        float floatResult;
+        if (foldFloat(opcode, leftConstant->getFloatValue(), rightConstant->getFloatValue(), floatResult)) {
+            return function.getConstant(floatResult);
+        }
+        return nullptr;
+    }
+    // 整数恒等式；浮点数因为-0.0和NaN不做这类化简
+    switch (opcode) {
+        case Opcode::ADD:
+            return isIntConstant(right, 0) ? left : isIntConstant(left, 0) ? right : nullptr;
+        case Opcode::SUB:
+            if (left == right) {
+                return function.getConstant(0);
+            }
+            return isIntConstant(right, 0) ? left : nullptr;
+        case Opcode::MUL:
+            if (isIntConstant(left, 0) || isIntConstant(right, 0)) {
+                return function.getConstant(0);
+            }
+            return isIntConstant(right, 1) ? left : isIntConstant(left, 1) ? right : nullptr;
+        case Opcode::SDIV:
+            return isIntConstant(right, 1) ? left : nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace
+
+// 化简控制流图，直到不再变化
+bool SimplifyCfgPass::run(Function& function, AnalysisManager&) {
+    if (function.getEntry() == nullptr) {
+        return false;
+    }
+    bool changed = false;
+    bool progress = true;
+    while (progress) {
+        progress = foldBranches(function);
+        progress |= removeUnreachableBlocks(function);
+        progress |= forwardEmptyBlocks(function);
+        progress |= mergeBlocks(function);
+        changed |= progress;
+    }
+    function.renumberBlocks();
+    return changed;
+}
+
+// 删除死代码
+bool DeadCodeEliminationPass::run(Function& function, AnalysisManager&) {
+    std::vector<Instruction*> worklist;
+    for (BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        for (Instruction* inst = block->getFirst(); inst != nullptr; inst = inst->getNext()) {
+            if (!inst->hasUses() && !hasSideEffects(inst)) {
+                worklist.push_back(inst);
+            }
+        }
+    }
+    bool changed = false;
+    std::vector<Instruction*> operands;
+    while (!worklist.empty()) {
+        Instruction* inst = worklist.back();
+        worklist.pop_back();
+        // 同一条指令可能多次进入工作表
+        if (inst->getParent() == nullptr || inst->hasUses()) {
+            continue;
+        }
+        operands.clear();
+        for (uint32_t i = 0; i < inst->getOperandCount(); i++) {
+            if (Instruction* operand = dyn_cast<Instruction>(inst->getOperand(i))) {
+                operands.push_back(operand);
+            }
+        }
+        inst->eraseFromParent();
+        changed = true;
+        for (Instruction* operand : operands) {
+            if (operand != inst && !operand->hasUses() && !hasSideEffects(operand)) {
+                worklist.push_back(operand);
+            }
+        }
+    }
+    return changed;
+}
+
+// 化简指令：按基本块顺序处理，替换结果会传递给后面使用它的指令
+bool InstSimplifyPass::run(Function& function, AnalysisManager&) {
+    bool changed = false;
+    for (BasicBlock* block = function.getEntry(); block != nullptr; block = block->getNext()) {
+        for (Instruction* inst = block->getFirst(); inst != nullptr; inst = inst->getNext()) {
+            if (!inst->hasUses()) {
+                continue;
+            }
+            Value* replacement = simplify(function, inst);
+            if (replacement != nullptr && replacement != inst) {
+                inst->replaceAllUsesWith(replacement);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+// 按名字创建Pass
+std::unique_ptr<FunctionPass> createPass(std::string_view name) {
+    if (name == "mem2reg") {
+        return std::make_unique<PromoteMemToRegPass>();
+    }
+    if (name == "simplifycfg") {
+        return std::make_unique<SimplifyCfgPass>();
+    }
+    if (name == "dce") {
+        return std::make_unique<DeadCodeEliminationPass>();
+    }
+    if (name == "instsimplify") {
+        return std::make_unique<InstSimplifyPass>();
+    }
+    return nullptr;
+}
+
+// 优化级别对应的Pass序列
+void addOptimizationPipeline(PassManager& passManager, int level) {
+    if (level >= 1) {
+        passManager.add(std::make_unique<PromoteMemToRegPass>());
+    }
+    if (level >= 2) {
+        passManager.add(std::make_unique<InstSimplifyPass>());
+    }
+    if (level >= 1) {
+        passManager.add(std::make_unique<SimplifyCfgPass>());
+        passManager.add(std::make_unique<DeadCodeEliminationPass>());
+    }
+}
@@ -29,6 +29,7 @@ std::string PrintVisitor::getOpString(TokenType op) {
         case TokenType::NE: return "!=";
         case TokenType::AND: return "&&";
         case TokenType::OR: return "||";
+        case TokenType::NOT: return "!";
         case TokenType::ASSIGN: return "=";
         default: return "unknown operator";
     }
@@ -45,24 +46,24 @@ std::string PrintVisitor::getTypeString(Type type) {
 }
 
 // 访问编译单元节点
-void PrintVisitor::visit(CompUnit& node) {
+void PrintVisitor::visitCompUnit(CompUnit& node) {
     printIndentation();
     std::cout << "CompUnit (1)" << std::endl;
     indentation++;
     
     for (auto& decl : node.getDecls()) {
-        decl->accept(*this);
+        dispatch(decl);
     }
     
     for (auto& funcDef : node.getFuncDefs()) {
-        funcDef->accept(*this);
+        dispatch(funcDef);
     }
     
     indentation--;
 }
 
 // 访问函数定义节点
-void PrintVisitor::visit(FuncDef& node) {
+void PrintVisitor::visitFuncDef(FuncDef& node) {
     printIndentation();
     std::cout << "FuncDef (1)" << std::endl;
     indentation++;
@@ -81,21 +82,21 @@ void PrintVisitor::visit(FuncDef& node) {
     std::cout << "LPARENT" << std::endl;
     
     for (auto& param : node.getParams()) {
-        param->accept(*this);
+        dispatch(param);
     }
     
     printIndentation();
     std::cout << "RPARENT" << std::endl;
     
     if (node.getBody()) {
-        node.getBody()->accept(*this);
+        dispatch(node.getBody());
     }
     
     indentation--;
 }
 
 // 访问变量声明节点
-void PrintVisitor::visit(VarDecl& node) {
+void PrintVisitor::visitVarDecl(VarDecl& node) {
     printIndentation();
     std::cout << "VarDecl (1)" << std::endl;
     indentation++;
@@ -108,14 +109,14 @@ void PrintVisitor::visit(VarDecl& node) {
     indentation--;
     
     for (auto& varDef : node.getVarDefs()) {
-        varDef->accept(*this);
+        dispatch(varDef);
     }
     
     indentation--;
 }
 
 // 访问if语句节点
-void PrintVisitor::visit(IfStmt& node) {
+void PrintVisitor::visitIfStmt(IfStmt& node) {
     printIndentation();
     std::cout << "IfStmt (1)" << std::endl;
     indentation++;
@@ -123,24 +124,24 @@ void PrintVisitor::visit(IfStmt& node) {
     printIndentation();
     std::cout << "LPARENT" << std::endl;
     
-    node.getCondition()->accept(*this);
+    dispatch(node.getCondition());
     
     printIndentation();
     std::cout << "RPARENT" << std::endl;
     
-    node.getThenStmt()->accept(*this);
+    dispatch(node.getThenStmt());
     
     if (node.getElseStmt()) {
         printIndentation();
         std::cout << "Else" << std::endl;
-        node.getElseStmt()->accept(*this);
+        dispatch(node.getElseStmt());
     }
     
     indentation--;
 }
 
 // 访问while语句节点
-void PrintVisitor::visit(WhileStmt& node) {
+void PrintVisitor::visitWhileStmt(WhileStmt& node) {
     printIndentation();
     std::cout << "WhileStmt (1)" << std::endl;
     indentation++;
@@ -148,31 +149,43 @@ void PrintVisitor::visit(WhileStmt& node) {
     printIndentation();
     std::cout << "LPARENT" << std::endl;
     
-    node.getCondition()->accept(*this);
+    dispatch(node.getCondition());
     
     printIndentation();
     std::cout << "RPARENT" << std::endl;
     
-    node.getBody()->accept(*this);
+    dispatch(node.getBody());
     
     indentation--;
 }
 
+// 访问break语句节点
+void PrintVisitor::visitBreakStmt(BreakStmt&) {
+    printIndentation();
+    std::cout << "BreakStmt (1)" << std::endl;
+}
+
+// 访问continue语句节点
+void PrintVisitor::visitContinueStmt(ContinueStmt&) {
+    printIndentation();
+    std::cout << "ContinueStmt (1)" << std::endl;
+}
+
 // 访问return语句节点
-void PrintVisitor::visit(ReturnStmt& node) {
+void PrintVisitor::visitReturnStmt(ReturnStmt& node) {
     printIndentation();
     std::cout << "ReturnStmt (1)" << std::endl;
     indentation++;
     
     if (node.getExpr()) {
-        node.getExpr()->accept(*this);
+        dispatch(node.getExpr());
     }
     
     indentation--;
 }
 
 // 访问二元表达式节点
-void PrintVisitor::visit(BinaryExpr& node) {
+void PrintVisitor::visitBinaryExpr(BinaryExpr& node) {
     printIndentation();
     std::cout << "BinaryExpr (1)" << std::endl;
     indentation++;
@@ -180,14 +193,14 @@ void PrintVisitor::visit(BinaryExpr& node) {
     printIndentation();
     std::cout << "Op: " << getOpString(node.getOp()) << std::endl;
     
-    node.getLeft()->accept(*this);
-    node.getRight()->accept(*this);
+    dispatch(node.getLeft());
+    dispatch(node.getRight());
     
     indentation--;
 }
 
 // 访问一元表达式节点
-void PrintVisitor::visit(UnaryExpr& node) {
+void PrintVisitor::visitUnaryExpr(UnaryExpr& node) {
     printIndentation();
     std::cout << "UnaryExpr (1)" << std::endl;
     indentation++;
@@ -195,13 +208,13 @@ void PrintVisitor::visit(UnaryExpr& node) {
     printIndentation();
     std::cout << "Op: " << getOpString(node.getOp()) << std::endl;
     
-    node.getOperand()->accept(*this);
+    dispatch(node.getOperand());
     
     indentation--;
 }
 
 // 访问函数调用表达式节点
-void PrintVisitor::visit(CallExpr& node) {
+void PrintVisitor::visitCallExpr(CallExpr& node) {
     printIndentation();
     std::cout << "CallExpr (1)" << std::endl;
     indentation++;
@@ -213,7 +226,7 @@ void PrintVisitor::visit(CallExpr& node) {
     std::cout << "LPARENT" << std::endl;
     
     for (auto& arg : node.getArgs()) {
-        arg->accept(*this);
+        dispatch(arg);
     }
     
     printIndentation();
@@ -223,17 +236,17 @@ void PrintVisitor::visit(CallExpr& node) {
 }
 
 // 访问数组索引表达式节点
-void PrintVisitor::visit(IndexExpr& node) {
+void PrintVisitor::visitIndexExpr(IndexExpr& node) {
     printIndentation();
     std::cout << "IndexExpr (1)" << std::endl;
     indentation++;
     
-    node.getBase()->accept(*this);
+    dispatch(node.getBase());
     
     printIndentation();
     std::cout << "LBRACK" << std::endl;
     
-    node.getIndex()->accept(*this);
+    dispatch(node.getIndex());
     
     printIndentation();
     std::cout << "RBRACK" << std::endl;
@@ -242,7 +255,7 @@ void PrintVisitor::visit(IndexExpr& node) {
 }
 
 // 访问数字表达式节点
-void PrintVisitor::visit(NumberExpr& node) {
+void PrintVisitor::visitNumberExpr(NumberExpr& node) {
     printIndentation();
     std::cout << "Number (1)" << std::endl;
     indentation++;
@@ -258,7 +271,7 @@ void PrintVisitor::visit(NumberExpr& node) {
 }
 
 // 访问变量表达式节点
-void PrintVisitor::visit(VariableExpr& node) {
+void PrintVisitor::visitVariableExpr(VariableExpr& node) {
     printIndentation();
     std::cout << "Lval (1)" << std::endl;
     indentation++;
@@ -270,7 +283,7 @@ void PrintVisitor::visit(VariableExpr& node) {
 }
 
 // 访问代码块节点
-void PrintVisitor::visit(Block& node) {
+void PrintVisitor::visitBlock(Block& node) {
     printIndentation();
     std::cout << "Block (1)" << std::endl;
     indentation++;
@@ -279,7 +292,7 @@ void PrintVisitor::visit(Block& node) {
     std::cout << "LBRACE" << std::endl;
     
     for (auto& stmt : node.getStatements()) {
-        stmt->accept(*this);
+        dispatch(stmt);
     }
     
     printIndentation();
@@ -289,7 +302,7 @@ void PrintVisitor::visit(Block& node) {
 }
 
 // 访问变量定义节点
-void PrintVisitor::visit(VarDef& node) {
+void PrintVisitor::visitVarDef(VarDef& node) {
     printIndentation();
     std::cout << "VarDef (1)" << std::endl;
     indentation++;
@@ -305,7 +318,7 @@ void PrintVisitor::visit(VarDef& node) {
         std::cout << "InitVal (1)" << std::endl;
         indentation++;
         
-        node.getInitExpr()->accept(*this);
+        dispatch(node.getInitExpr());
         
         indentation--;
     }
@@ -317,7 +330,7 @@ void PrintVisitor::visit(VarDef& node) {
 }
 
 // 访问函数形参节点
-void PrintVisitor::visit(FuncFParam& node) {
+void PrintVisitor::visitFuncFParam(FuncFParam& node) {
     printIndentation();
     std::cout << "FuncFParam (1)" << std::endl;
     indentation++;
@@ -332,12 +345,12 @@ void PrintVisitor::visit(FuncFParam& node) {
 }
 
 // 访问表达式语句节点
-void PrintVisitor::visit(ExprStmt& node) {
+void PrintVisitor::visitExprStmt(ExprStmt& node) {
     printIndentation();
     std::cout << "Stmt (1)" << std::endl;
     indentation++;
     
-    node.getExpr()->accept(*this);
+    dispatch(node.getExpr());
     
     printIndentation();
     std::cout << "SEMICN" << std::endl;
@@ -346,12 +359,12 @@ void PrintVisitor::visit(ExprStmt& node) {
 }
 
 // 访问声明语句节点
-void PrintVisitor::visit(DeclStmt& node) {
+void PrintVisitor::visitDeclStmt(DeclStmt& node) {
     printIndentation();
     std::cout << "Stmt (1)" << std::endl;
     indentation++;
     
-    node.getDecl()->accept(*this);
+    dispatch(node.getDecl());
     
     indentation--;
 }
\ No newline at end of file
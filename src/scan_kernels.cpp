@@ -0,0 +1,404 @@
+#include "../include/scan_kernels.h"
+#include <cstdint>
+
+// 向量内核要求x86上至少有SSE2（x86-64总是满足）
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SYSY_SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SYSY_SCAN_X86 0
+#endif
+
+// AVX2内核只在对应函数上开启指令集，其余代码仍按基础指令集编译
+#if SYSY_SCAN_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SYSY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SYSY_TARGET_AVX2
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// 标量实现：同时作为向量内核的尾部处理
+// ---------------------------------------------------------------------------
+
+// 判断是否为空白字符（与C区域设置下的isspace一致）
+inline bool isSpaceByte(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// 判断是否为标识符字符（字母、数字或下划线）
+inline bool isIdentByte(unsigned char c) {
+    unsigned char lower = c | 0x20;
+    return c == '_' || (c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'z');
+}
+
+size_t skipWhitespaceFrom(const char* p, size_t i, size_t n, ScanLines& lines) {
+    while (i < n && isSpaceByte(static_cast<unsigned char>(p[i]))) {
+        if (p[i] == '\n') {
+            lines.count++;
+            lines.lastNewline = i;
+        }
+        ++i;
+    }
+    return i;
+}
+
+size_t findLineEndFrom(const char* p, size_t i, size_t n) {
+    while (i < n && p[i] != '\n' && p[i] != '\0') {
+        ++i;
+    }
+    return i;
+}
+
+size_t findBlockCommentEndFrom(const char* p, size_t i, size_t n, ScanLines& lines) {
+    while (i < n && p[i] != '\0') {
+        if (p[i] == '*' && i + 1 < n && p[i + 1] == '/') {
+            return i + 2;
+        }
+        if (p[i] == '\n') {
+            lines.count++;
+            lines.lastNewline = i;
+        }
+        ++i;
+    }
+    return i;
+}
+
+size_t scanIdentifierFrom(const char* p, size_t i, size_t n) {
+    while (i < n && isIdentByte(static_cast<unsigned char>(p[i]))) {
+        ++i;
+    }
+    return i;
+}
+
+size_t skipWhitespaceScalar(const char* p, size_t n, ScanLines& lines) {
+    return skipWhitespaceFrom(p, 0, n, lines);
+}
+
+size_t findLineEndScalar(const char* p, size_t n) {
+    return findLineEndFrom(p, 0, n);
+}
+
+size_t findBlockCommentEndScalar(const char* p, size_t n, ScanLines& lines) {
+    return findBlockCommentEndFrom(p, 0, n, lines);
+}
+
+size_t scanIdentifierScalar(const char* p, size_t n) {
+    return scanIdentifierFrom(p, 0, n);
+}
+
+const ScanKernels SCALAR_KERNELS = {
+    skipWhitespaceScalar, findLineEndScalar, findBlockCommentEndScalar, scanIdentifierScalar,
+};
+
+#if SYSY_SCAN_X86
+
+// ---------------------------------------------------------------------------
+// 位运算辅助函数
+// ---------------------------------------------------------------------------
+
+// 最低位的1所在的位置（mask不为0）
+inline unsigned lowestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// 最高位的1所在的位置（mask不为0）
+inline unsigned highestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+}
+
+// 1的个数
+inline unsigned bitCount(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<unsigned>(__popcnt(mask));
+#else
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+}
+
+// 低k位全为1的掩码（k小于32）
+inline uint32_t bitsBelow(unsigned k) {
+    return (1u << k) - 1u;
+}
+
+// 把一个块中的换行掩码计入统计，base为块起点的偏移
+inline void countNewlines(uint32_t newlineMask, size_t base, ScanLines& lines) {
+    if (newlineMask != 0) {
+        lines.count += bitCount(newlineMask);
+        lines.lastNewline = base + highestBit(newlineMask);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SSE2实现：每次处理16字节
+// ---------------------------------------------------------------------------
+
+// 字节是否落在[low, low + span]区间内（无符号比较）
+inline __m128i inRange16(__m128i c, char low, char span) {
+    __m128i offset = _mm_sub_epi8(c, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(span)), offset);
+}
+
+inline uint32_t whitespaceMask16(__m128i c) {
+    __m128i ws = _mm_or_si128(inRange16(c, '\t', '\r' - '\t'), _mm_cmpeq_epi8(c, _mm_set1_epi8(' ')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ws));
+}
+
+inline uint32_t identMask16(__m128i c) {
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i ident = _mm_or_si128(inRange16(c, '0', 9), inRange16(lower, 'a', 25));
+    ident = _mm_or_si128(ident, _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ident));
+}
+
+inline uint32_t byteMask16(__m128i c, char value) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8(value))));
+}
+
+inline __m128i load16(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+size_t skipWhitespaceSse2(const char* p, size_t n, ScanLines& lines) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = load16(p + i);
+        uint32_t stop = ~whitespaceMask16(c) & 0xFFFFu;
+        uint32_t newlines = byteMask16(c, '\n');
+        if (stop != 0) {
+            unsigned k = lowestBit(stop);
+            countNewlines(newlines & bitsBelow(k), i, lines);
+            return i + k;
+        }
+        countNewlines(newlines, i, lines);
+    }
+    return skipWhitespaceFrom(p, i, n, lines);
+}
+
+size_t findLineEndSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = load16(p + i);
+        uint32_t stop = byteMask16(c, '\n') | byteMask16(c, '\0');
+        if (stop != 0) {
+            return i + lowestBit(stop);
+        }
+    }
+    return findLineEndFrom(p, i, n);
+}
+
+size_t findBlockCommentEndSse2(const char* p, size_t n, ScanLines& lines) {
+    size_t i = 0;
+    while (i + 16 <= n) {
+        __m128i c = load16(p + i);
+        uint32_t stop = byteMask16(c, '*') | byteMask16(c, '\0');
+        uint32_t newlines = byteMask16(c, '\n');
+        if (stop == 0) {
+            countNewlines(newlines, i, lines);
+            i += 16;
+            continue;
+        }
+        unsigned k = lowestBit(stop);
+        countNewlines(newlines & bitsBelow(k), i, lines);
+        i += k;
+        if (p[i] == '\0') {
+            return i;
+        }
+        if (i + 1 < n && p[i + 1] == '/') {
+            return i + 2;
+        }
+        ++i; // 单独的'*'，从下一个字节继续
+    }
+    return findBlockCommentEndFrom(p, i, n, lines);
+}
+
+size_t scanIdentifierSse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint32_t stop = ~identMask16(load16(p + i)) & 0xFFFFu;
+        if (stop != 0) {
+            return i + lowestBit(stop);
+        }
+    }
+    return scanIdentifierFrom(p, i, n);
+}
+
+const ScanKernels SSE2_KERNELS = {
+    skipWhitespaceSse2, findLineEndSse2, findBlockCommentEndSse2, scanIdentifierSse2,
+};
+
+// ---------------------------------------------------------------------------
+// AVX2实现：每次处理32字节
+// ---------------------------------------------------------------------------
+
+SYSY_TARGET_AVX2 inline __m256i inRange32(__m256i c, char low, char span) {
+    __m256i offset = _mm256_sub_epi8(c, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(span)), offset);
+}
+
+SYSY_TARGET_AVX2 inline uint32_t whitespaceMask32(__m256i c) {
+    __m256i ws = _mm256_or_si256(inRange32(c, '\t', '\r' - '\t'), _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(ws));
+}
+
+SYSY_TARGET_AVX2 inline uint32_t identMask32(__m256i c) {
+    __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    __m256i ident = _mm256_or_si256(inRange32(c, '0', 9), inRange32(lower, 'a', 25));
+    ident = _mm256_or_si256(ident, _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(ident));
+}
+
+SYSY_TARGET_AVX2 inline uint32_t byteMask32(__m256i c, char value) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(value))));
+}
+
+SYSY_TARGET_AVX2 inline __m256i load32(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+SYSY_TARGET_AVX2 size_t skipWhitespaceAvx2(const char* p, size_t n, ScanLines& lines) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = load32(p + i);
+        uint32_t stop = ~whitespaceMask32(c);
+        uint32_t newlines = byteMask32(c, '\n');
+        if (stop != 0) {
+            unsigned k = lowestBit(stop);
+            countNewlines(newlines & bitsBelow(k), i, lines);
+            return i + k;
+        }
+        countNewlines(newlines, i, lines);
+    }
+    return skipWhitespaceFrom(p, i, n, lines);
+}
+
+SYSY_TARGET_AVX2 size_t findLineEndAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = load32(p + i);
+        uint32_t stop = byteMask32(c, '\n') | byteMask32(c, '\0');
+        if (stop != 0) {
+            return i + lowestBit(stop);
+        }
+    }
+    return findLineEndFrom(p, i, n);
+}
+
+SYSY_TARGET_AVX2 size_t findBlockCommentEndAvx2(const char* p, size_t n, ScanLines& lines) {
+    size_t i = 0;
+    while (i + 32 <= n) {
+        __m256i c = load32(p + i);
+        uint32_t stop = byteMask32(c, '*') | byteMask32(c, '\0');
+        uint32_t newlines = byteMask32(c, '\n');
+        if (stop == 0) {
+            countNewlines(newlines, i, lines);
+            i += 32;
+            continue;
+        }
+        unsigned k = lowestBit(stop);
+        countNewlines(newlines & bitsBelow(k), i, lines);
+        i += k;
+        if (p[i] == '\0') {
+            return i;
+        }
+        if (i + 1 < n && p[i + 1] == '/') {
+            return i + 2;
+        }
+        ++i; // 单独的'*'，从下一个字节继续
+    }
+    return findBlockCommentEndFrom(p, i, n, lines);
+}
+
+SYSY_TARGET_AVX2 size_t scanIdentifierAvx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        uint32_t stop = ~identMask32(load32(p + i));
+        if (stop != 0) {
+            return i + lowestBit(stop);
+        }
+    }
+    return scanIdentifierFrom(p, i, n);
+}
+
+const ScanKernels AVX2_KERNELS = {
+    skipWhitespaceAvx2, findLineEndAvx2, findBlockCommentEndAvx2, scanIdentifierAvx2,
+};
+
+// 通过CPUID检测AVX2（同时确认操作系统保存了YMM寄存器）
+bool cpuHasAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // SYSY_SCAN_X86
+
+} // namespace
+
+// 获取指定指令集的内核
+// 请求的级别超出当前CPU能力时退化为可用的最高级别
+const ScanKernels& ScanKernels::get(ScanIsa isa) {
+    ScanIsa best = bestAvailable();
+    if (static_cast<int>(isa) > static_cast<int>(best)) {
+        isa = best;
+    }
+    switch (isa) {
+#if SYSY_SCAN_X86
+        case ScanIsa::AVX2: return AVX2_KERNELS;
+        case ScanIsa::SSE2: return SSE2_KERNELS;
+#endif
+        default: return SCALAR_KERNELS;
+    }
+}
+
+// 检测当前CPU支持的最高指令集级别
+// x86-64总是支持SSE2，AVX2需要运行时检测；其他架构只使用标量实现
+ScanIsa ScanKernels::bestAvailable() {
+#if SYSY_SCAN_X86
+    static const ScanIsa best = cpuHasAvx2() ? ScanIsa::AVX2 : ScanIsa::SSE2;
+    return best;
+#else
+    return ScanIsa::SCALAR;
+#endif
+}
+
+// 获取指令集级别的名称
+const char* ScanKernels::isaName(ScanIsa isa) {
+    switch (isa) {
+        case ScanIsa::AVX2: return "avx2";
+        case ScanIsa::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
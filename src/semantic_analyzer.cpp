@@ -3,9 +3,13 @@
 #include "../include/ast.h"
 #include <string>
 #include <vector>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <stdexcept>
 #include <unordered_set>
+#include <utility>
 
 // 将Type枚举转换为字符串表示
 // 便于在错误和警告消息中显示类型名称
@@ -18,40 +22,134 @@ std::string typeToString(Type type) {
     }
 }
 
+// 构造函数
+SemanticAnalyzer::SemanticAnalyzer(unsigned threadCount)
+    : threadCount(threadCount), functionLimit(INT_MAX), currentFunction(0),
+      currentReturnType(Type::VOID), isInLoop(false), hasReturnStmt(false) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+// 检查函数体的分析器
+// 局部作用域建立在只读的全局符号表之上，诊断信息记录在自己的诊断引擎中
+SemanticAnalyzer::SemanticAnalyzer(const SymbolTable& globals)
+    : symbolTable(&globals), threadCount(1), functionLimit(INT_MAX), currentFunction(0),
+      currentReturnType(Type::VOID), isInLoop(false), hasReturnStmt(false) {}
+
+// 查找符号
+// 顺序分析时，检查第i个函数体的时刻只有前i个函数已经登记；并行检查时全部函数都已登记，
+// 因此序号大于当前函数的函数要视为未声明，使结果与顺序分析一致
+const SymbolEntry* SemanticAnalyzer::lookup(Symbol name) const {
+    const SymbolEntry* entry = symbolTable.lookup(name);
+    if (entry && entry->kind == SymbolEntry::Kind::FUNCTION && entry->funcIndex > functionLimit) {
+        return nullptr;
+    }
+    return entry;
+}
+
 // 访问编译单元节点
-// 遍历并访问编译单元中的所有声明和函数定义
-void SemanticAnalyzer::visit(CompUnit& node) {
+// 第一阶段顺序处理全局声明、登记函数签名；第二阶段并行检查函数体，最后按函数顺序合并诊断信息
+void SemanticAnalyzer::visitCompUnit(CompUnit& node) {
     // 遍历所有声明（变量声明等）
     for (auto& decl : node.getDecls()) {
-        decl->accept(*this);
+        dispatch(decl);
     }
     
-    // 遍历所有函数定义
-    for (auto& func : node.getFuncDefs()) {
-        func->accept(*this);
+    // 函数较少或只有一个线程时，顺序地逐个登记签名并检查函数体
+    const NodeList<FuncDef>& funcDefs = node.getFuncDefs();
+    size_t funcCount = funcDefs.size();
+    size_t workerCount = std::min<size_t>(threadCount, funcCount / MIN_FUNCTIONS_PER_THREAD);
+    if (workerCount <= 1) {
+        for (auto& func : funcDefs) {
+            dispatch(func);
+        }
+        return;
+    }
+    
+    // 登记所有函数签名，记录每个函数签名的诊断信息的结束位置，然后把它们移到signatures中
+    size_t globalCount = diagnostics.size();
+    std::vector<size_t> signatureEnd(funcCount);
+    for (size_t i = 0; i < funcCount; i++) {
+        declareFunction(*funcDefs[i], static_cast<int>(i));
+        signatureEnd[i] = diagnostics.size() - globalCount;
+    }
+    DiagnosticEngine signatures;
+    signatures.merge(diagnostics, globalCount, diagnostics.size());
+    diagnostics.truncate(globalCount);
+    
+    // 并行检查函数体：线程按批领取函数，每个线程使用自己的分析器和诊断引擎，记录每个函数的诊断信息所在的一段
+    struct FunctionLog {
+        unsigned worker; // 检查该函数的线程
+        size_t begin;    // 诊断信息在该线程诊断引擎中的起始下标
+        size_t end;      // 诊断信息在该线程诊断引擎中的结束下标
+    };
+    constexpr size_t BATCH_SIZE = 64; // 每次领取的函数个数
+    std::vector<std::unique_ptr<SemanticAnalyzer>> checkers(workerCount);
+    for (auto& checker : checkers) {
+        checker.reset(new SemanticAnalyzer(symbolTable));
+    }
+    std::vector<FunctionLog> functionLogs(funcCount);
+    std::atomic<size_t> nextFunction(0);
+    
+    auto checkBodies = [&](unsigned worker) {
+        SemanticAnalyzer& checker = *checkers[worker];
+        while (true) {
+            size_t first = nextFunction.fetch_add(BATCH_SIZE);
+            if (first >= funcCount) {
+                break;
+            }
+            for (size_t i = first; i < std::min(first + BATCH_SIZE, funcCount); i++) {
+                size_t begin = checker.diagnostics.size();
+                checker.functionLimit = static_cast<int>(i);
+                checker.checkFunctionBody(*funcDefs[i]);
+                functionLogs[i] = FunctionLog{worker, begin, checker.diagnostics.size()};
+            }
+        }
+    };
+    {
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < workerCount; i++) {
+            workers.emplace_back(checkBodies, i);
+        }
+        checkBodies(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    // 按函数顺序合并：每个函数先合并签名的诊断信息，再合并函数体的诊断信息
+    size_t signatureBegin = 0;
+    for (size_t i = 0; i < funcCount; i++) {
+        const FunctionLog& log = functionLogs[i];
+        diagnostics.merge(signatures, signatureBegin, signatureEnd[i]);
+        diagnostics.merge(checkers[log.worker]->diagnostics, log.begin, log.end);
+        signatureBegin = signatureEnd[i];
     }
 }
 
 // 访问函数定义节点
-// 处理函数的符号表条目、参数、函数体和返回值检查
-void SemanticAnalyzer::visit(FuncDef& node) {
+// 单独分析一个函数定义时，依次登记签名并检查函数体
+void SemanticAnalyzer::visitFuncDef(FuncDef& node) {
+    declareFunction(node, -1);
+    checkFunctionBody(node);
+}
+
+// 检查函数签名
+// 检查函数是否重复定义、形参是否重名，并把函数添加到全局符号表
+void SemanticAnalyzer::declareFunction(FuncDef& node, int index) {
     // 检查函数是否已定义
-    SymbolEntry* existingEntry = symbolTable.lookup(node.getName());
+    const SymbolEntry* existingEntry = symbolTable.lookup(node.getName());
     if (existingEntry) {
-        std::cerr << "Error type 4 at line " << node.getLine() << " : redefinition of function '" << node.getName() << "'" << std::endl;
+        diagnostics.error(4, node.getLine(), "redefinition of function '", node.getName(), "'");
     }
     
-    // 设置当前函数的信息
-    currentFunction = node.getName();
-    currentReturnType = node.getReturnType();
-    hasReturnStmt = false; // 初始化是否有返回语句的标志
-    
     // 检查参数是否重复并收集参数类型
-    std::unordered_set<std::string> paramNames;
+    std::unordered_set<Symbol> paramNames;
     std::vector<Type> paramTypes;
     for (const auto& param : node.getParams()) {
         if (paramNames.find(param->getName()) != paramNames.end()) {
-            std::cerr << "Error type 2 at line " << param->getLine() << " : duplicate parameter name '" << param->getName() << "' in function '" << node.getName() << "'" << std::endl;
+            diagnostics.error(2, param->getLine(), "duplicate parameter name '", param->getName(), "' in function '", node.getName(), "'");
         } else {
             paramNames.insert(param->getName());
             paramTypes.push_back(param->getType());
@@ -61,26 +159,36 @@ void SemanticAnalyzer::visit(FuncDef& node) {
     // 添加函数到全局符号表
     SymbolEntry funcEntry(SymbolEntry::Kind::FUNCTION, node.getReturnType());
     funcEntry.paramCount = node.getParams().size();
-    funcEntry.paramTypes = paramTypes;
-    symbolTable.insert(node.getName(), funcEntry);
+    funcEntry.paramTypes = std::move(paramTypes);
+    funcEntry.funcIndex = index;
+    funcEntry.decl = &node;
+    symbolTable.insert(node.getName(), std::move(funcEntry));
+}
+
+// 检查函数体
+// 处理函数的参数、函数体和返回值检查
+void SemanticAnalyzer::checkFunctionBody(FuncDef& node) {
+    // 设置当前函数的信息
+    currentFunction = node.getName();
+    currentReturnType = node.getReturnType();
+    hasReturnStmt = false; // 初始化是否有返回语句的标志
     
     // 进入函数的局部作用域
     symbolTable.enterScope();
     
     // 处理参数（添加到函数的局部作用域）
     for (auto& param : node.getParams()) {
-        param->accept(*this);
+        dispatch(param);
     }
     
     // 处理函数体
     if (node.getBody()) {
-        node.getBody()->accept(*this);
+        dispatch(node.getBody());
     }
     
     // 检查非void函数是否有返回语句
     if (node.getReturnType() != Type::VOID && !hasReturnStmt) {
-        std::cerr << "Warning: function '" << node.getName() 
-                  << "' should return a value" << std::endl;
+        diagnostics.warning(node.getLine(), "function '", node.getName(), "' should return a value");
     }
     
     // 退出函数的局部作用域
@@ -89,199 +197,373 @@ void SemanticAnalyzer::visit(FuncDef& node) {
 
 // 访问变量声明节点
 // 遍历并处理所有变量定义
-void SemanticAnalyzer::visit(VarDecl& node) {
+void SemanticAnalyzer::visitVarDecl(VarDecl& node) {
     Type varType = node.getType(); // 获取变量类型
     
     // 检查是否声明void类型变量
     if (varType == Type::VOID) {
-        std::cerr << "Error type 11 at line " << node.getLine() << " : variable declaration with void type" << std::endl;
+        diagnostics.error(11, node.getLine(), "variable declaration with void type");
         return;
     }
     
     // 处理所有变量定义
     for (auto& varDef : node.getVarDefs()) {
-        // 直接处理变量定义，而不是调用accept，这样可以传递类型信息
-        std::string varName = varDef->getName();
+        // 直接处理变量定义，而不是分派给visitVarDef，这样可以传递类型信息
+        Symbol varName = varDef->getName();
         
         // 创建变量的符号表项
-        SymbolEntry varEntry(SymbolEntry::Kind::VARIABLE, varType);
+        SymbolEntry varEntry(node.getIsConst() ? SymbolEntry::Kind::CONSTANT : SymbolEntry::Kind::VARIABLE, varType);
         varEntry.isArray = varDef->getIsArray(); // 设置是否为数组
+        varEntry.decl = varDef;
+        evaluateDimensions(*varDef, varEntry.dimensions);
+        
+        // 常量在登记之前检查初始化表达式并求值，初始化表达式中的同名标识符不会解析为常量自己
+        if (node.getIsConst()) {
+            evaluateConstant(*varDef, varEntry);
+        }
         
         // 添加变量到当前作用域的符号表
-        if (!symbolTable.insert(varName, varEntry)) {
-                std::cerr << "Error type 2 at line " << varDef->getLine() << " : redefinition of variable '" << varName << "'" << std::endl;
+        if (!symbolTable.insert(varName, std::move(varEntry))) {
+                diagnostics.error(2, varDef->getLine(), "redefinition of variable '", varName, "'");
             }
         
         // 处理初始化表达式
-        if (varDef->getInitExpr()) {
-            varDef->getInitExpr()->accept(*this);
-            
-            // 检查初始化表达式类型是否匹配
-            Type initType = varDef->getInitExpr()->getType();
-            if (initType != varType) {
-                std::cerr << "Error type 11 at line " << varDef->getInitExpr()->getLine() << " : type mismatch in initialization of variable '" << varName 
-                          << "': expected '" << typeToString(varType) 
-                          << "', got '" << typeToString(initType) << "'" << std::endl;
+        if (!node.getIsConst()) {
+            size_t errorCount = diagnostics.errorCount();
+            checkInitializer(*varDef, varType);
+            // 全局变量的初始值在编译期确定，初始化表达式必须是常量表达式
+            ConstValue value;
+            if (currentFunction.empty() && varDef->getInitExpr() && diagnostics.errorCount() == errorCount &&
+                !evaluator.evaluate(varDef->getInitExpr(), value)) {
+                diagnostics.error(11, varDef->getInitExpr()->getLine(), "initializer of global variable '", varName,
+                                  "' is not a constant expression");
+            }
+        }
+    }
+}
+
+// 检查初始化表达式，类型必须与变量的类型一致
+void SemanticAnalyzer::checkInitializer(VarDef& node, Type varType) {
+    if (node.getInitExpr()) {
+        dispatch(node.getInitExpr());
+        
+        // 检查初始化表达式类型是否匹配
+        Type initType = node.getInitExpr()->getType();
+        if (initType != varType) {
+            diagnostics.error(11, node.getInitExpr()->getLine(), "type mismatch in initialization of variable '", node.getName(),
+                              "': expected '", typeToString(varType), "', got '", typeToString(initType), "'");
+        }
+    }
+}
+
+// 计算数组各维的长度
+// 每一维的长度必须是非负的整型常量表达式，不满足时报告错误并把该维记为0
+void SemanticAnalyzer::evaluateDimensions(VarDef& node, std::vector<int>& dims) {
+    for (Expr* dim : node.getDims()) {
+        int size = 0;
+        if (dim == nullptr) {
+            diagnostics.error(11, node.getLine(), "missing size of array '", node.getName(), "'");
+        } else {
+            // 长度表达式本身有错误时不再重复报告
+            size_t errorCount = diagnostics.errorCount();
+            dispatch(dim);
+            ConstValue value;
+            if (diagnostics.errorCount() == errorCount) {
+                if (!evaluator.evaluate(dim, value) || value.type != Type::INT) {
+                    diagnostics.error(11, dim->getLine(), "size of array '", node.getName(),
+                                      "' is not an integer constant expression");
+                } else if (value.intValue < 0) {
+                    diagnostics.error(11, dim->getLine(), "size of array '", node.getName(), "' is negative");
+                } else {
+                    size = value.intValue;
+                }
             }
         }
+        dims.push_back(size);
+    }
+}
+
+// 检查常量的初始化表达式并求值，标量常量的值记录在符号表项中
+void SemanticAnalyzer::evaluateConstant(VarDef& node, SymbolEntry& entry) {
+    if (node.getInitExpr() == nullptr) {
+        diagnostics.error(11, node.getLine(), "missing initializer for constant '", node.getName(), "'");
+        return;
+    }
+    size_t errorCount = diagnostics.errorCount();
+    checkInitializer(node, entry.type);
+    if (node.getIsArray() || diagnostics.errorCount() != errorCount) {
+        return;
+    }
+    ConstValue value;
+    if (!evaluator.evaluate(node.getInitExpr(), value) || !ConstEvaluator::convert(value, entry.type)) {
+        diagnostics.error(11, node.getInitExpr()->getLine(), "initializer of constant '", node.getName(),
+                          "' is not a constant expression");
+        return;
+    }
+    if (value.type == Type::FLOAT) {
+        entry.value.floatValue = value.floatValue;
+        entry.valueType = SymbolEntry::ValueType::FLOAT;
+    } else {
+        entry.value.intValue = value.intValue;
+        entry.valueType = SymbolEntry::ValueType::INT;
     }
 }
 
 // 访问if语句节点
 // 处理条件表达式、then语句块和else语句块
-void SemanticAnalyzer::visit(IfStmt& node) {
+void SemanticAnalyzer::visitIfStmt(IfStmt& node) {
     // 检查条件表达式
     if (node.getCondition()) {
-        node.getCondition()->accept(*this);
+        dispatch(node.getCondition());
     }
     
     // 处理then语句块
     if (node.getThenStmt()) {
-        node.getThenStmt()->accept(*this);
+        dispatch(node.getThenStmt());
     }
     
     // 处理else语句块
     if (node.getElseStmt()) {
-        node.getElseStmt()->accept(*this);
+        dispatch(node.getElseStmt());
     }
 }
 
 // 访问while语句节点
 // 处理循环条件和循环体
-void SemanticAnalyzer::visit(WhileStmt& node) {
+void SemanticAnalyzer::visitWhileStmt(WhileStmt& node) {
     bool wasInLoop = isInLoop; // 保存之前的循环状态
     isInLoop = true; // 设置当前在循环中
     
     // 检查循环条件表达式
     if (node.getCondition()) {
-        node.getCondition()->accept(*this);
+        dispatch(node.getCondition());
     }
     
     // 处理循环体
     if (node.getBody()) {
-        node.getBody()->accept(*this);
+        dispatch(node.getBody());
     }
     
     isInLoop = wasInLoop; // 恢复之前的循环状态
 }
 
+// 访问break语句节点
+// break语句必须位于循环体内
+void SemanticAnalyzer::visitBreakStmt(BreakStmt& node) {
+    if (!isInLoop) {
+        diagnostics.error(12, node.getLine(), "break statement not within a loop");
+    }
+}
+
+// 访问continue语句节点
+// continue语句必须位于循环体内
+void SemanticAnalyzer::visitContinueStmt(ContinueStmt& node) {
+    if (!isInLoop) {
+        diagnostics.error(13, node.getLine(), "continue statement not within a loop");
+    }
+}
+
 // 访问return语句节点
 // 处理返回表达式，并检查返回类型是否匹配
-void SemanticAnalyzer::visit(ReturnStmt& node) {
+void SemanticAnalyzer::visitReturnStmt(ReturnStmt& node) {
     hasReturnStmt = true; // 标记函数有返回语句
     
     // 处理返回表达式
     if (node.getExpr()) {
-        node.getExpr()->accept(*this);
+        dispatch(node.getExpr());
         
         // 检查void函数是否返回值
     if (currentReturnType == Type::VOID) {
-        std::cerr << "Error type 10 at line " << node.getLine() << " : cannot return a value from a void function" << std::endl;
+        diagnostics.error(10, node.getLine(), "cannot return a value from a void function");
     } else {
             // 检查返回值类型是否匹配
             Type returnType = node.getExpr()->getType();
             if (returnType != currentReturnType) {
-                std::cerr << "Error type 10 at line " << node.getLine() << " : return type mismatch: expected '" 
-                          << typeToString(currentReturnType) 
-                          << "', got '" << typeToString(returnType) << "'" << std::endl;
+                diagnostics.error(10, node.getLine(), "return type mismatch: expected '", typeToString(currentReturnType),
+                                  "', got '", typeToString(returnType), "'");
             }
         }
     } else {
         // 没有返回表达式
         // 检查非void函数是否没有返回值
     if (currentReturnType != Type::VOID) {
-        std::cerr << "Error type 10 at line " << node.getLine() << " : must return a value from non-void function" << std::endl;
+        diagnostics.error(10, node.getLine(), "must return a value from non-void function");
     }
     }
 }
 
-// 访问二元表达式节点
-// 检查操作数类型是否匹配
-void SemanticAnalyzer::visit(BinaryExpr& node) {
-    // 处理左操作数
-    if (node.getLeft()) {
-        node.getLeft()->accept(*this);
-    }
-    
-    // 处理右操作数
-    if (node.getRight()) {
-        node.getRight()->accept(*this);
+// 访问表达式节点
+// 二元、一元、函数调用和数组元素表达式都交给checkExpr，用显式栈检查整个表达式
+void SemanticAnalyzer::visitBinaryExpr(BinaryExpr& node) {
+    checkExpr(node);
+}
+
+void SemanticAnalyzer::visitUnaryExpr(UnaryExpr& node) {
+    checkExpr(node);
+}
+
+void SemanticAnalyzer::visitCallExpr(CallExpr& node) {
+    checkExpr(node);
+}
+
+void SemanticAnalyzer::visitIndexExpr(IndexExpr& node) {
+    checkExpr(node);
+}
+
+// 检查整个表达式
+// 生成代码中的长表达式和深层嵌套（a + b + ...、x + (x + (...))、- - -x、f(f(...))、x = x = ...）
+// 可以有上百万层，逐层递归会耗尽调用栈。这里用显式栈做后序遍历：内部表达式第一次出栈时
+// 把自己和子表达式压栈，子表达式都处理完后再次出栈时做检查；处理和报错的顺序与逐层递归相同
+void SemanticAnalyzer::checkExpr(Expr& root) {
+    size_t base = exprWork.size();
+    exprWork.push_back(ExprWork{&root, false});
+    while (exprWork.size() > base) {
+        ExprWork item = exprWork.back();
+        exprWork.pop_back();
+        Expr* expr = item.expr;
+
+        if (item.expanded) {
+            switch (expr->getKind()) {
+                case NodeKind::BINARY_EXPR: checkBinaryExpr(*cast<BinaryExpr>(expr)); break;
+                case NodeKind::UNARY_EXPR: checkUnaryExpr(*cast<UnaryExpr>(expr)); break;
+                case NodeKind::CALL_EXPR: checkCallArgs(*cast<CallExpr>(expr)); break;
+                case NodeKind::INDEX_EXPR: checkIndexExpr(*cast<IndexExpr>(expr)); break;
+                default: break;
+            }
+            continue;
+        }
+
+        // 子表达式逆序压栈，使它们按源代码顺序处理；空指针表示语法错误中缺失的子表达式，直接跳过
+        switch (expr->getKind()) {
+            case NodeKind::BINARY_EXPR: {
+                BinaryExpr* binary = cast<BinaryExpr>(expr);
+                exprWork.push_back(ExprWork{expr, true});
+                if (binary->getRight()) {
+                    exprWork.push_back(ExprWork{binary->getRight(), false});
+                }
+                if (binary->getLeft()) {
+                    exprWork.push_back(ExprWork{binary->getLeft(), false});
+                }
+                break;
+            }
+            case NodeKind::UNARY_EXPR: {
+                UnaryExpr* unary = cast<UnaryExpr>(expr);
+                exprWork.push_back(ExprWork{expr, true});
+                if (unary->getOperand()) {
+                    exprWork.push_back(ExprWork{unary->getOperand(), false});
+                }
+                break;
+            }
+            case NodeKind::CALL_EXPR: {
+                CallExpr* call = cast<CallExpr>(expr);
+                checkCallee(*call);
+                exprWork.push_back(ExprWork{expr, true});
+                const NodeList<Expr>& args = call->getArgs();
+                for (size_t i = args.size(); i > 0; i--) {
+                    if (args[i - 1]) {
+                        exprWork.push_back(ExprWork{args[i - 1], false});
+                    }
+                }
+                break;
+            }
+            case NodeKind::INDEX_EXPR: {
+                IndexExpr* index = cast<IndexExpr>(expr);
+                exprWork.push_back(ExprWork{expr, true});
+                if (index->getIndex()) {
+                    exprWork.push_back(ExprWork{index->getIndex(), false});
+                }
+                if (index->getBase()) {
+                    exprWork.push_back(ExprWork{index->getBase(), false});
+                }
+                break;
+            }
+            case NodeKind::VARIABLE_EXPR:
+                visitVariableExpr(*cast<VariableExpr>(expr));
+                break;
+            default:
+                break; // 数字常量无需处理
+        }
     }
-    
+}
+
+// 检查二元表达式的操作数类型是否匹配（操作数已经处理完毕）
+void SemanticAnalyzer::checkBinaryExpr(BinaryExpr& node) {
     // 检查类型匹配
     if (node.getLeft() && node.getRight()) {
         Type leftType = node.getLeft()->getType();
         Type rightType = node.getRight()->getType();
         
         if (leftType != rightType) {
-            std::cerr << "Error type 11 at line " << node.getLine() << " : type mismatch in binary expression: expected '" 
-                      << typeToString(leftType) << "', got '" << typeToString(rightType) << "'" << std::endl;
+            diagnostics.error(11, node.getLine(), "type mismatch in binary expression: expected '", typeToString(leftType),
+                              "', got '", typeToString(rightType), "'");
         }
         
-        // 设置二元表达式的类型
-        node.setType(leftType);
+        // 设置二元表达式的类型：比较和逻辑运算的结果为int，其余与左操作数相同
+        switch (node.getOp()) {
+            case TokenType::EQ: case TokenType::NE: case TokenType::LT: case TokenType::GT:
+            case TokenType::LE: case TokenType::GE: case TokenType::AND: case TokenType::OR:
+                node.setType(Type::INT);
+                break;
+            default:
+                node.setType(leftType);
+                break;
+        }
         
         // 检查赋值操作符
         if (node.getOp() == TokenType::ASSIGN) {
             // 检查左操作数是否为变量或数组元素
-            if (dynamic_cast<VariableExpr*>(node.getLeft()) || dynamic_cast<IndexExpr*>(node.getLeft())) {
-                // 检查是否给常量赋值
-                if (dynamic_cast<VariableExpr*>(node.getLeft())) {
-                    VariableExpr* varExpr = dynamic_cast<VariableExpr*>(node.getLeft());
-                    SymbolEntry* entry = symbolTable.lookup(varExpr->getName());
-                    if (entry && entry->kind == SymbolEntry::Kind::CONSTANT) {
-                        std::cerr << "Error type 11 at line " << node.getLine() << " : assignment to constant variable '" << varExpr->getName() << "'" << std::endl;
+            if (isa<VariableExpr>(node.getLeft()) || isa<IndexExpr>(node.getLeft())) {
+                // 检查是否给常量赋值（左操作数已经完成名字解析，直接读取它绑定的声明）
+                if (VariableExpr* varExpr = dyn_cast<VariableExpr>(node.getLeft())) {
+                    VarDef* varDef = dyn_cast<VarDef>(varExpr->getDecl());
+                    if (varDef && varDef->getDecl()->getIsConst()) {
+                        diagnostics.error(11, node.getLine(), "assignment to constant variable '", varExpr->getName(), "'");
                     }
                 }
             } else {
-                std::cerr << "Error type 11 at line " << node.getLine() << " : left operand of assignment must be a variable or array element" << std::endl;
+                diagnostics.error(11, node.getLine(), "left operand of assignment must be a variable or array element");
             }
         }
     }
 }
 
-// 访问一元表达式节点
-// 处理操作数
-void SemanticAnalyzer::visit(UnaryExpr& node) {
-    // 处理操作数
+// 检查一元表达式（操作数已经处理完毕）
+// 正负号的结果与操作数类型相同，逻辑非的结果为int
+void SemanticAnalyzer::checkUnaryExpr(UnaryExpr& node) {
     if (node.getOperand()) {
-        node.getOperand()->accept(*this);
+        node.setType(node.getOp() == TokenType::NOT ? Type::INT : node.getOperand()->getType());
     }
 }
 
-// 访问函数调用表达式节点
-// 检查函数是否存在，参数类型是否匹配
-void SemanticAnalyzer::visit(CallExpr& node) {
-    // 检查函数是否已定义
-    SymbolEntry* funcEntry = symbolTable.lookup(node.getCallee());
+// 检查函数调用的函数名（在处理实参之前）
+// 名字解析：检查函数是否存在
+void SemanticAnalyzer::checkCallee(CallExpr& node) {
+    const SymbolEntry* funcEntry = lookup(node.getCallee());
     if (!funcEntry) {
-        std::cerr << "Error type 3 at line " << node.getLine() << " : call to undefined function '" << node.getCallee() << "'" << std::endl;
-        node.setType(Type::INT); // 默认类型
-        return;
+        diagnostics.error(3, node.getLine(), "call to undefined function '", node.getCallee(), "'");
+    } else if (funcEntry->kind != SymbolEntry::Kind::FUNCTION) {
+        diagnostics.error(5, node.getLine(), "'", node.getCallee(), "' is not a function");
     }
-    
-    if (funcEntry->kind != SymbolEntry::Kind::FUNCTION) {
-        std::cerr << "Error type 5 at line " << node.getLine() << " : '" << node.getCallee() << "' is not a function" << std::endl;
+}
+
+// 检查函数调用的实参（实参已经处理完毕，被调用的函数无效时也要完成实参中的名字解析）
+// 绑定到函数定义，再检查参数个数和类型是否匹配
+void SemanticAnalyzer::checkCallArgs(CallExpr& node) {
+    const SymbolEntry* funcEntry = lookup(node.getCallee());
+    if (!funcEntry || funcEntry->kind != SymbolEntry::Kind::FUNCTION) {
         node.setType(Type::INT); // 默认类型
         return;
     }
     
-    // 设置函数调用表达式的类型为函数返回类型
+    // 绑定到函数定义，设置函数调用表达式的类型为函数返回类型
+    node.setDecl(cast<FuncDef>(funcEntry->decl));
     node.setType(funcEntry->type);
     
-    // 处理所有参数表达式
-    for (auto& arg : node.getArgs()) {
-        if (arg) {
-            arg->accept(*this);
-        }
-    }
-    
     // 检查参数数量是否匹配
     int actualArgCount = node.getArgs().size();
     if (actualArgCount != funcEntry->paramCount) {
-        std::cerr << "Error type 9 at line " << node.getLine() << " : function '" << node.getCallee() << "' expects " 
-                  << funcEntry->paramCount << " arguments, but " 
-                  << actualArgCount << " were provided" << std::endl;
+        diagnostics.error(9, node.getLine(), "function '", node.getCallee(),
+                          "' expects ", funcEntry->paramCount, " arguments, but ", actualArgCount, " were provided");
     }
     
     // 检查参数类型是否匹配
@@ -289,31 +571,19 @@ void SemanticAnalyzer::visit(CallExpr& node) {
         if (node.getArgs()[i]) {
             Type argType = node.getArgs()[i]->getType();
             if (argType != funcEntry->paramTypes[i]) {
-            std::cerr << "Error type 9 at line " << node.getArgs()[i]->getLine() << " : argument " << i + 1 << " of function '" 
-                      << node.getCallee() << "' has type '" 
-                      << typeToString(argType) << "', but expected '" 
-                      << typeToString(funcEntry->paramTypes[i]) << "'" << std::endl;
+            diagnostics.error(9, node.getArgs()[i]->getLine(), "argument ", i + 1, " of function '", node.getCallee(),
+                              "' has type '", typeToString(argType), "', but expected '", typeToString(funcEntry->paramTypes[i]), "'");
         }
         }
     }
 }
 
-// 访问数组索引表达式节点
-// 处理数组基址和索引表达式，检查索引类型
-void SemanticAnalyzer::visit(IndexExpr& node) {
-    // 处理数组基址
-    if (node.getBase()) {
-        node.getBase()->accept(*this);
-    }
-    
-    // 处理索引表达式
-    if (node.getIndex()) {
-        node.getIndex()->accept(*this);
-        
-        // 检查索引是否为整数类型
-        if (node.getIndex()->getType() != Type::INT) {
-        std::cerr << "Error type 7 at line " << node.getLine() << " : array index must be an integer" << std::endl;
-    }
+// 检查数组元素表达式（数组基址和下标已经处理完毕）
+// 检查下标类型，设置数组元素的类型
+void SemanticAnalyzer::checkIndexExpr(IndexExpr& node) {
+    // 检查索引是否为整数类型
+    if (node.getIndex() && node.getIndex()->getType() != Type::INT) {
+        diagnostics.error(7, node.getLine(), "array index must be an integer");
     }
     
     // 设置数组元素的类型
@@ -324,33 +594,34 @@ void SemanticAnalyzer::visit(IndexExpr& node) {
 
 // 访问数字表达式节点
 // 数字表达式无需特殊处理
-void SemanticAnalyzer::visit(NumberExpr& node) {
+void SemanticAnalyzer::visitNumberExpr(NumberExpr& node) {
     // 数字表达式无需特殊处理
 }
 
 // 访问变量表达式节点
-// 检查变量是否已声明，并设置变量类型
-void SemanticAnalyzer::visit(VariableExpr& node) {
+// 名字解析：检查变量是否已声明，把变量表达式绑定到它的声明，并设置变量类型
+void SemanticAnalyzer::visitVariableExpr(VariableExpr& node) {
     // 检查变量是否已在符号表中声明
-    SymbolEntry* entry = symbolTable.lookup(node.getName());
+    const SymbolEntry* entry = lookup(node.getName());
     if (!entry) {
-        std::cerr << "Error type 1 at line " << node.getLine() << " : use of undeclared variable '" << node.getName() << "'" << std::endl;
+        diagnostics.error(1, node.getLine(), "use of undeclared variable '", node.getName(), "'");
         node.setType(Type::INT); // 默认类型，避免后续错误
     } else {
-        // 设置变量表达式的类型
+        // 绑定到声明，设置变量表达式的类型
+        node.setDecl(entry->decl);
         node.setType(entry->type);
     }
 }
 
 // 访问语句块节点
 // 处理语句块的作用域和所有语句
-void SemanticAnalyzer::visit(Block& node) {
+void SemanticAnalyzer::visitBlock(Block& node) {
     symbolTable.enterScope(); // 进入语句块的局部作用域
     
     // 处理所有语句
     for (auto& stmt : node.getStatements()) {
         if (stmt) {
-            stmt->accept(*this);
+            dispatch(stmt);
         }
     }
     
@@ -359,7 +630,7 @@ void SemanticAnalyzer::visit(Block& node) {
 
 // 访问变量定义节点
 // 处理变量的符号表条目和初始化表达式
-void SemanticAnalyzer::visit(VarDef& node) {
+void SemanticAnalyzer::visitVarDef(VarDef& node) {
     // 此方法不应直接调用，变量定义应在VarDecl中处理
     // 这里仅作占位符
 }
@@ -367,32 +638,33 @@ void SemanticAnalyzer::visit(VarDef& node) {
 
 // 访问函数参数节点
 // 处理参数的符号表条目
-void SemanticAnalyzer::visit(FuncFParam& node) {
+void SemanticAnalyzer::visitFuncFParam(FuncFParam& node) {
     // 创建参数的符号表项
     SymbolEntry paramEntry(SymbolEntry::Kind::PARAMETER, node.getType());
     paramEntry.isArray = node.getIsArray(); // 设置是否为数组参数
+    paramEntry.decl = &node;
     
     // 添加参数到当前作用域的符号表
-    if (!symbolTable.insert(node.getName(), paramEntry)) {
-        std::cerr << "Error type 2 at line " << node.getLine() << " : redefinition of parameter '" << node.getName() << "'" << std::endl;
+    if (!symbolTable.insert(node.getName(), std::move(paramEntry))) {
+        diagnostics.error(2, node.getLine(), "redefinition of parameter '", node.getName(), "'");
     }
 }
 
 // 访问表达式语句节点
 // 处理表达式语句
-void SemanticAnalyzer::visit(ExprStmt& node) {
+void SemanticAnalyzer::visitExprStmt(ExprStmt& node) {
     // 处理表达式语句
     if (node.getExpr()) {
-        node.getExpr()->accept(*this);
+        dispatch(node.getExpr());
     }
 }
 
 // 访问声明语句节点
 // 处理声明语句
-void SemanticAnalyzer::visit(DeclStmt& node) {
+void SemanticAnalyzer::visitDeclStmt(DeclStmt& node) {
     // 处理包装的声明
     if (node.getDecl()) {
-        node.getDecl()->accept(*this);
+        dispatch(node.getDecl());
     }
 }
 
@@ -405,7 +677,7 @@ void SemanticAnalyzer::checkTypeCompatibility(Type t1, Type t2, const std::strin
 
 // 检查数组维度
 // 确保数组的索引数量与数组的维度数量匹配
-void SemanticAnalyzer::checkArrayDimensions(const std::vector<std::unique_ptr<Expr>>& indices,
+void SemanticAnalyzer::checkArrayDimensions(const NodeList<Expr>& indices,
                                              const std::vector<int>& dims) {
     // 这个方法不再直接输出错误，错误输出在调用处处理
     // 保持这个方法用于维度检查但不输出错误
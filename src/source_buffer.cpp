@@ -0,0 +1,116 @@
+#include "../include/source_buffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SYSY_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#define SYSY_HAVE_MMAP 0
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#endif
+
+// 析构函数
+// 映射模式下解除映射，退化模式下的内容由storage自动释放
+SourceBuffer::~SourceBuffer() {
+#if SYSY_HAVE_MMAP
+    if (mapped && size > 0) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+#if SYSY_HAVE_MMAP
+
+// 从文件描述符读取全部内容
+// 按块调用read()直到文件结束，用于无法映射的管道和标准输入
+bool SourceBuffer::readAll(int fd) {
+    char chunk[64 * 1024];
+    while (true) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n > 0) {
+            storage.append(chunk, static_cast<size_t>(n));
+        } else if (n == 0) {
+            break;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+    data = storage.data();
+    size = storage.size();
+    return true;
+}
+
+// 打开源文件
+// 普通文件优先使用mmap；管道、标准输入和映射失败的情况退化为read()
+std::unique_ptr<SourceBuffer> SourceBuffer::open(const std::string& path) {
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+
+    if (path == "-") {
+        return buffer->readAll(STDIN_FILENO) ? std::move(buffer) : nullptr;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            // 空文件无需映射
+            ::close(fd);
+            return buffer;
+        }
+        void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // 词法分析只做顺序扫描
+            madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            buffer->data = static_cast<const char*>(addr);
+            buffer->size = static_cast<size_t>(st.st_size);
+            buffer->mapped = true;
+            ::close(fd);
+            return buffer;
+        }
+    }
+
+    bool ok = buffer->readAll(fd);
+    ::close(fd);
+    return ok ? std::move(buffer) : nullptr;
+}
+
+#else
+
+// 从标准输入读取全部内容（不支持mmap的平台）
+bool SourceBuffer::readAll(int) {
+    storage.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    data = storage.data();
+    size = storage.size();
+    return true;
+}
+
+// 打开源文件（不支持mmap的平台）
+// 整个文件一次性读入内部字符串
+std::unique_ptr<SourceBuffer> SourceBuffer::open(const std::string& path) {
+    std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+
+    if (path == "-") {
+        buffer->readAll(0);
+        return buffer;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    buffer->storage.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    buffer->data = buffer->storage.data();
+    buffer->size = buffer->storage.size();
+    return buffer;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "../include/streaming_lexer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// 统计[begin, end)中的换行符个数
+size_t countNewlines(const std::string& text, size_t begin, size_t end) {
+    return static_cast<size_t>(std::count(text.begin() + begin, text.begin() + end, '\n'));
+}
+
+// 计算从begin开始的数字常量最多可能延伸到的位置
+// Lexer::scanNumber会向后查看整个由数字、字母、下划线、'.'以及指数符号后的正负号组成的片段
+// （例如"08"之后若紧跟".5"就是合法的浮点数），因此这一片段之后的字符必须也已读入窗口
+size_t numberExtent(const std::string& text, size_t begin) {
+    size_t end = begin;
+    while (end < text.size()) {
+        char c = text[end];
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.') {
+            end++;
+        } else if ((c == '+' || c == '-') && end > begin &&
+                   std::strchr("eEpP", text[end - 1]) != nullptr) {
+            end++;
+        } else {
+            break;
+        }
+    }
+    return end;
+}
+
+// 判断Token是否为数字常量（包括非法的数字常量）
+bool isNumberToken(const std::string& text, const Token& token) {
+    if (token.offset >= text.size()) {
+        return false;
+    }
+    char c = text[token.offset];
+    return std::isdigit(static_cast<unsigned char>(c)) || c == '.';
+}
+
+} // namespace
+
+// 构造函数
+// 读入第一块并创建词法分析器
+StreamingLexer::StreamingLexer(std::istream& input, size_t blockSize)
+    : input(input), blockSize(std::max<size_t>(blockSize, 1)), inputEnded(false) {
+    refill(0, std::string(), 1);
+}
+
+// 读入下一块
+// 保留窗口中keep之后的内容，前面拼接prefix，再追加一块新数据
+void StreamingLexer::refill(size_t keep, const std::string& prefix, size_t line) {
+    buffer.erase(0, keep);
+    buffer.insert(0, prefix);
+    
+    size_t oldSize = buffer.size();
+    buffer.resize(oldSize + blockSize);
+    input.read(&buffer[oldSize], static_cast<std::streamsize>(blockSize));
+    size_t got = static_cast<size_t>(input.gcount());
+    buffer.resize(oldSize + got);
+    if (got < blockSize) {
+        inputEnded = true;
+    }
+    
+    lexer.emplace(buffer, line);
+}
+
+// 获取下一个Token
+// 在当前窗口上扫描一个Token：如果扫描停在窗口末尾之前，说明Token后面的字符已经读到，
+// Token一定完整（数字常量还要求整个可能的片段都已读到）；否则Token（或它之前的注释、空白）可能被块边界截断，
+// 需要读入下一块后重新扫描
+Token StreamingLexer::getNextToken() {
+    while (true) {
+        size_t start = lexer->getPosition();
+        size_t startLine = lexer->getLine();
+        Token token = lexer->getNextToken();
+        
+        bool complete = lexer->getPosition() < buffer.size();
+        if (complete && isNumberToken(buffer, token)) {
+            complete = numberExtent(buffer, token.offset) < buffer.size();
+        }
+        if (inputEnded || complete) {
+            if (token.type() == TokenType::UNKNOWN) {
+                errorMessage = lexer->getErrorMessage(token);
+            }
+            return token;
+        }
+        
+        if (token.type() != TokenType::END_OF_FILE) {
+            // Token可能被截断：它之前的空白和注释已经完整，从Token的起始位置重新扫描
+            refill(std::max<size_t>(token.offset, start), std::string(), token.line);
+            continue;
+        }
+        
+        // 空白和注释一直延续到窗口末尾：丢弃已经完整的部分，只保留足以延续未闭合注释的前缀，
+        // 使内存占用不随注释长度增长
+        size_t pos = start;
+        size_t line = startLine;
+        std::string prefix;
+        while (pos < buffer.size()) {
+            char c = buffer[pos];
+            char next = pos + 1 < buffer.size() ? buffer[pos + 1] : '\0';
+            if (c == '/' && next == '/') {
+                size_t end = buffer.find('\n', pos + 2);
+                if (end == std::string::npos) {
+                    // 未结束的单行注释：其余部分不影响结果
+                    prefix = "//";
+                    break;
+                }
+                pos = end;
+            } else if (c == '/' && next == '*') {
+                size_t end = buffer.find("*/", pos + 2);
+                if (end == std::string::npos) {
+                    // 未闭合的多行注释：保留"/*"和最后一个字符，以便识别跨块的"*/"
+                    prefix = "/*";
+                    if (buffer.size() - pos > 2) {
+                        prefix += buffer.back();
+                        line += countNewlines(buffer, pos, buffer.size() - 1);
+                    }
+                    break;
+                }
+                line += countNewlines(buffer, pos, end);
+                pos = end + 2;
+            } else {
+                // 空白字符
+                if (c == '\n') {
+                    line++;
+                }
+                pos++;
+            }
+        }
+        refill(buffer.size(), prefix, line);
+    }
+}
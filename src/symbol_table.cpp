@@ -1,71 +1,111 @@
 #include "../include/symbol_table.h"
 #include <stdexcept>
+#include <utility>
+
+// 构造函数
+// 哈希表初始有64个槽位，构造时进入最外层作用域
+SymbolTable::SymbolTable(const SymbolTable* parent) : slots(64, Slot{0, NONE}), usedSlots(0), parent(parent) {
+    enterScope();
+}
+
+// 查找名字所在的槽位
+// 乘以奇数常数后取低位作为起始位置，连续的Symbol编号落在互不相同的位置上，再线性探测
+size_t SymbolTable::findSlot(Symbol name) const {
+    uint32_t key = name.id + 1;
+    size_t mask = slots.size() - 1;
+    size_t index = (key * 0x9E3779B9u) & mask;
+    while (slots[index].key != key && slots[index].key != 0) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+// 扩容
+// 槽位数翻倍，把原有的名字重新插入；条目下标不变，条目本身不需要移动
+void SymbolTable::grow() {
+    std::vector<Slot> old(slots.size() * 2, Slot{0, NONE});
+    old.swap(slots);
+    for (const Slot& slot : old) {
+        if (slot.key != 0) {
+            slots[findSlot(Symbol(slot.key - 1))] = slot;
+        }
+    }
+}
 
 // 进入新的作用域
-// 向作用域栈中添加一个新的空作用域
+// 只记录当前条目个数，不分配内存
 void SymbolTable::enterScope() {
-    scopes.push_back({});
+    scopeMarks.push_back(static_cast<uint32_t>(entries.size()));
 }
 
 // 退出当前作用域
-// 从作用域栈中移除最顶层的作用域
+// 按插入的逆序弹出本作用域的条目，并恢复被它们遮蔽的外层条目
 // 如果栈为空，则抛出运行时错误
 void SymbolTable::exitScope() {
-    if (scopes.empty()) {
+    if (scopeMarks.empty()) {
         throw std::runtime_error("Cannot exit scope: no active scope");
     }
-    scopes.pop_back();
+    uint32_t mark = scopeMarks.back();
+    scopeMarks.pop_back();
+    while (entries.size() > mark) {
+        const Binding& binding = entries.back();
+        slots[findSlot(binding.name)].head = binding.shadowed;
+        entries.pop_back();
+    }
 }
 
 // 向当前作用域插入符号
-// 尝试在当前作用域中插入指定名称和条目的符号
-// 如果符号已存在或作用域栈为空，则返回失败
-// 否则插入成功并返回true
-bool SymbolTable::insert(const std::string& name, SymbolEntry entry) {
-    if (scopes.empty()) {
+// 如果当前作用域中已有同名符号，则返回失败；外层的同名符号被新条目遮蔽
+// 条目按值传入后移动到表中，不复制其中的数组
+bool SymbolTable::insert(Symbol name, SymbolEntry entry) {
+    if (scopeMarks.empty()) {
         throw std::runtime_error("Cannot insert symbol: no active scope");
     }
 
-    auto& currentScope = scopes.back();
-    if (currentScope.find(name) != currentScope.end()) {
+    Slot* slot = &slots[findSlot(name)];
+    if (slot->head != NONE && slot->head >= scopeMarks.back()) {
         return false; // 符号已存在
     }
+    if (slot->key == 0) {
+        if ((usedSlots + 1) * 2 > slots.size()) {
+            grow();
+            slot = &slots[findSlot(name)];
+        }
+        slot->key = name.id + 1;
+        usedSlots++;
+    }
 
-    currentScope[name] = entry;
+    uint32_t index = static_cast<uint32_t>(entries.size());
+    entries.push_back(Binding{std::move(entry), name, slot->head});
+    slot->head = index;
     return true;
 }
 
 // 查找符号
-// 从最内层作用域开始向外查找指定名称的符号
+// 槽位直接指向最内层的同名条目，与作用域的嵌套深度无关；本表中没有时再查找外层符号表
 // 如果找到，则返回符号条目指针
 // 否则返回nullptr
-SymbolEntry* SymbolTable::lookup(const std::string& name) {
-    // 从最内层作用域开始查找
-    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        auto entryIt = it->find(name);
-        if (entryIt != it->end()) {
-            return &entryIt->second;
-        }
+const SymbolEntry* SymbolTable::lookup(Symbol name) const {
+    const Slot& slot = slots[findSlot(name)];
+    if (slot.head == NONE) {
+        return parent != nullptr ? parent->lookup(name) : nullptr; // 本表中未找到
     }
-
-    return nullptr; // 符号未找到
+    return &entries[slot.head].entry;
 }
 
 // 在当前作用域中查找符号
-// 仅在当前最内层作用域中查找指定名称的符号
+// 最内层的同名条目属于当前作用域时才返回
 // 如果找到，则返回符号条目指针
 // 否则返回nullptr
 // 如果作用域栈为空，则抛出运行时错误
-SymbolEntry* SymbolTable::lookupCurrentScope(const std::string& name) {
-    if (scopes.empty()) {
+const SymbolEntry* SymbolTable::lookupCurrentScope(Symbol name) const {
+    if (scopeMarks.empty()) {
         throw std::runtime_error("Cannot lookup symbol: no active scope");
     }
 
-    auto& currentScope = scopes.back();
-    auto entryIt = currentScope.find(name);
-    if (entryIt != currentScope.end()) {
-        return &entryIt->second;
+    const Slot& slot = slots[findSlot(name)];
+    if (slot.head == NONE || slot.head < scopeMarks.back()) {
+        return nullptr; // 符号未找到
     }
-
-    return nullptr; // 符号未找到
+    return &entries[slot.head].entry;
 }
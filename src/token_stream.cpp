@@ -0,0 +1,97 @@
+#include "../include/token_stream.h"
+#include <algorithm>
+
+// 追加一个Token
+// 各字段分别追加到对应的列中，UNKNOWN Token的错误信息复制到本缓冲区的错误表里
+void TokenStream::push(const Token& token, std::string_view errorMessage) {
+    types.push_back(token.type());
+    lines.push_back(token.line);
+    offsets.push_back(token.offset);
+    lengths.push_back(token.length());
+    if (token.type() == TokenType::UNKNOWN) {
+        payloads.push_back(static_cast<uint32_t>(errors.size()));
+        errors.emplace_back(errorMessage);
+    } else {
+        payloads.push_back(token.rawValue());
+    }
+}
+
+// 获取列号
+// 从Token的偏移向前找到行首，不需要为每个Token保存列号
+int TokenStream::column(size_t index) const {
+    size_t offset = std::min<size_t>(offsets[index], source.size());
+    size_t lineStart = source.rfind('\n', offset == 0 ? std::string_view::npos : offset - 1);
+    if (offset == 0 || lineStart == std::string_view::npos) {
+        return static_cast<int>(offset) + 1;
+    }
+    return static_cast<int>(offset - lineStart);
+}
+
+// 预留空间
+void TokenStream::reserve(size_t count) {
+    types.reserve(count);
+    lines.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+    payloads.reserve(count);
+}
+
+// 调整Token个数
+void TokenStream::resize(size_t count) {
+    types.resize(count);
+    lines.resize(count);
+    offsets.resize(count);
+    lengths.resize(count);
+    payloads.resize(count);
+}
+
+// 追加错误信息
+uint32_t TokenStream::appendErrors(const TokenStream& other) {
+    uint32_t base = static_cast<uint32_t>(errors.size());
+    errors.insert(errors.end(), other.errors.begin(), other.errors.end());
+    return base;
+}
+
+// 复制一段Token
+// 逐列复制，同时修正行号、错误下标和标识符编号
+void TokenStream::copyRange(size_t dst, const TokenStream& other, size_t begin, size_t end,
+                            int lineDelta, uint32_t errorBase, const std::vector<uint32_t>* symbolMap) {
+    std::copy(other.types.begin() + begin, other.types.begin() + end, types.begin() + dst);
+    std::copy(other.offsets.begin() + begin, other.offsets.begin() + end, offsets.begin() + dst);
+    std::copy(other.lengths.begin() + begin, other.lengths.begin() + end, lengths.begin() + dst);
+    for (size_t i = begin; i < end; ++i, ++dst) {
+        lines[dst] = other.lines[i] + lineDelta;
+        uint32_t payload = other.payloads[i];
+        if (other.types[i] == TokenType::UNKNOWN) {
+            payload += errorBase;
+        } else if (symbolMap && other.types[i] == TokenType::IDENT) {
+            payload = (*symbolMap)[payload];
+        }
+        payloads[dst] = payload;
+    }
+}
+
+// 查找Token
+// Token按原文偏移递增排列，二分查找
+size_t TokenStream::lowerBound(uint32_t offset) const {
+    return static_cast<size_t>(std::lower_bound(offsets.begin(), offsets.end(), offset) - offsets.begin());
+}
+
+// 获取错误信息
+std::string_view TokenStream::errorMessage(size_t index) const {
+    if (types[index] != TokenType::UNKNOWN) {
+        return std::string_view();
+    }
+    return errors[payloads[index]];
+}
+
+// 重新组装Token
+Token TokenStream::at(size_t index) const {
+    Token token;
+    token.setType(types[index]);
+    token.setLength(lengths[index]);
+    token.offset = offsets[index];
+    token.line = lines[index];
+    token.setRawValue(payloads[index]);
+    return token;
+}
@@ -0,0 +1,23 @@
+# 比较扁平编码和指针形式的语法树
+# 用法：cmake -DCOMPILER=<sysy_compiler> -DTEST_DIR=<tests目录> -P compare_flat_ast.cmake
+# 对每个测试用例用--verify-flat-ast运行编译器：由语法树生成FlatAst，逐个节点比较种类、tag、行号、
+# 操作数和子节点列表（有词法或语法错误的用例比较错误恢复得到的语法树），必须返回0且没有错误输出
+
+file(GLOB_RECURSE TEST_FILES "${TEST_DIR}/*.sy")
+list(SORT TEST_FILES)
+
+set(FAILED 0)
+foreach(test_file ${TEST_FILES})
+    execute_process(COMMAND ${COMPILER} --verify-flat-ast ${test_file}
+                    OUTPUT_QUIET ERROR_VARIABLE err RESULT_VARIABLE rc)
+    if(NOT rc STREQUAL "0" OR NOT err STREQUAL "")
+        message(SEND_ERROR "flat AST mismatch on ${test_file} (${rc}): ${err}")
+        math(EXPR FAILED "${FAILED} + 1")
+    endif()
+endforeach()
+
+list(LENGTH TEST_FILES TOTAL)
+if(FAILED GREATER 0)
+    message(FATAL_ERROR "${FAILED} of ${TOTAL} test files produce a flat AST that differs from the syntax tree")
+endif()
+message(STATUS "${TOTAL} test files produce a flat AST identical to the syntax tree")
@@ -0,0 +1,24 @@
+# 比较手写词法分析器和flex扫描器的输出
+# 用法：cmake -DCOMPILER=<sysy_compiler> -DTEST_DIR=<tests目录> -P compare_lexers.cmake
+# 对每个测试用例分别用--lexer=hand和--lexer=flex运行编译器，标准输出、标准错误和返回码都必须相同
+
+file(GLOB_RECURSE TEST_FILES "${TEST_DIR}/*.sy")
+list(SORT TEST_FILES)
+
+set(FAILED 0)
+foreach(test_file ${TEST_FILES})
+    execute_process(COMMAND ${COMPILER} --lexer=hand ${test_file}
+                    OUTPUT_VARIABLE hand_out ERROR_VARIABLE hand_err RESULT_VARIABLE hand_rc)
+    execute_process(COMMAND ${COMPILER} --lexer=flex ${test_file}
+                    OUTPUT_VARIABLE flex_out ERROR_VARIABLE flex_err RESULT_VARIABLE flex_rc)
+    if(NOT hand_out STREQUAL flex_out OR NOT hand_err STREQUAL flex_err OR NOT hand_rc STREQUAL flex_rc)
+        message(SEND_ERROR "lexer backends differ on ${test_file}")
+        math(EXPR FAILED "${FAILED} + 1")
+    endif()
+endforeach()
+
+list(LENGTH TEST_FILES TOTAL)
+if(FAILED GREATER 0)
+    message(FATAL_ERROR "${FAILED} of ${TOTAL} test files differ between --lexer=hand and --lexer=flex")
+endif()
+message(STATUS "${TOTAL} test files produce identical output with both lexer backends")
@@ -0,0 +1,57 @@
+# 生成超长和深度嵌套的表达式，检查编译器能在线性时间内完成分析而不会栈溢出
+# 用法：cmake -DCOMPILER=<sysy_compiler> -DWORK_DIR=<临时目录> -P deep_expressions.cmake
+# 生成1000000项的加法表达式、100000层左侧括号嵌套、1000000层右侧括号嵌套、1000000个一元负号、
+# 100000层嵌套的函数调用和1000000个连续赋值，编译器在默认模式和--emit-ir -O2下都必须正常结束并返回0；
+# 常量版本的加法表达式整个被常量折叠
+
+set(TERMS 1000000)
+set(DEPTH 100000)
+
+math(EXPR REST "${TERMS} - 1")
+string(REPEAT " + x" ${REST} long_terms)
+file(WRITE "${WORK_DIR}/long_expression.sy"
+     "int x;\nint main() {\n    return x${long_terms};\n}\n")
+
+string(REPEAT " + 1" ${REST} constant_terms)
+file(WRITE "${WORK_DIR}/constant_expression.sy"
+     "int main() {\n    return 1${constant_terms};\n}\n")
+
+string(REPEAT "(" ${DEPTH} open_parens)
+string(REPEAT " + 1)" ${DEPTH} close_parens)
+file(WRITE "${WORK_DIR}/nested_expression.sy"
+     "int x;\nint main() {\n    return ${open_parens}x${close_parens};\n}\n")
+
+# x + (x + (... + (x)))：右操作数层层嵌套
+string(REPEAT "x + (" ${TERMS} right_open)
+string(REPEAT ")" ${TERMS} right_close)
+file(WRITE "${WORK_DIR}/right_nested_expression.sy"
+     "int x;\nint main() {\n    return ${right_open}x${right_close};\n}\n")
+
+string(REPEAT "-" ${TERMS} minus_signs)
+file(WRITE "${WORK_DIR}/unary_expression.sy"
+     "int x;\nint main() {\n    return ${minus_signs}x;\n}\n")
+
+string(REPEAT "f(" ${DEPTH} call_open)
+string(REPEAT ")" ${DEPTH} call_close)
+file(WRITE "${WORK_DIR}/nested_call_expression.sy"
+     "int f(int a) {\n    return a;\n}\nint main() {\n    return ${call_open}1${call_close};\n}\n")
+
+# x = x = ... = 1：赋值是右结合的
+string(REPEAT "x = " ${TERMS} assignments)
+file(WRITE "${WORK_DIR}/assignment_chain.sy"
+     "int x;\nint main() {\n    ${assignments}1;\n    return x;\n}\n")
+
+foreach(name long_expression constant_expression nested_expression right_nested_expression
+             unary_expression nested_call_expression assignment_chain)
+    foreach(mode "" "--emit-ir;-O2")
+        execute_process(COMMAND ${COMPILER} ${mode} "${WORK_DIR}/${name}.sy"
+                        OUTPUT_QUIET ERROR_VARIABLE err RESULT_VARIABLE rc)
+        if(NOT rc STREQUAL "0")
+            message(FATAL_ERROR "${name}.sy ${mode} failed (${rc}): ${err}")
+        endif()
+        if(NOT err STREQUAL "")
+            message(FATAL_ERROR "${name}.sy ${mode} reported errors: ${err}")
+        endif()
+    endforeach()
+endforeach()
+message(STATUS "compiled ${TERMS}-term, ${TERMS}-level and ${DEPTH}-level expressions of every shape")
@@ -0,0 +1,49 @@
+# 生成有大量函数和语义错误的程序，检查并行语义分析输出的错误信息与单线程逐字节一致
+# 用法：cmake -DCOMPILER=<sysy_compiler> -DWORK_DIR=<临时目录> -P parallel_semantic.cmake
+# 1500个函数远超过并行所需的函数数，每个函数里有未定义变量、重复定义、参数个数不符、
+# 循环外的break、调用后面才定义的函数等错误；--threads=1、4和8的返回值和标准错误必须完全相同
+
+set(FUNCTIONS 1500)
+
+math(EXPR LAST "${FUNCTIONS} - 1")
+set(program "int g;\n")
+foreach(i RANGE ${LAST})
+    math(EXPR next "${i} + 1")
+    string(APPEND program
+           "int f${i}(int a, int b) {\n"
+           "    int x;\n"
+           "    int x;\n"
+           "    x = a + y${i};\n"
+           "    g = f${i}(a);\n"
+           "    g = f${next}(a, b);\n"
+           "    if (a > b) {\n"
+           "        break;\n"
+           "    }\n"
+           "    return x;\n"
+           "}\n")
+endforeach()
+string(APPEND program "int main() {\n    return f0(1, 2);\n}\n")
+file(WRITE "${WORK_DIR}/parallel_semantic.sy" "${program}")
+
+execute_process(COMMAND ${COMPILER} --threads=1 "${WORK_DIR}/parallel_semantic.sy"
+                OUTPUT_QUIET ERROR_VARIABLE expected RESULT_VARIABLE expected_rc)
+string(REGEX MATCHALL "Error type" errors "${expected}")
+list(LENGTH errors error_count)
+if(error_count LESS ${FUNCTIONS})
+    message(FATAL_ERROR "single-threaded run reported only ${error_count} errors (${expected_rc})")
+endif()
+
+foreach(threads 4 8)
+    execute_process(COMMAND ${COMPILER} --threads=${threads} "${WORK_DIR}/parallel_semantic.sy"
+                    OUTPUT_QUIET ERROR_VARIABLE actual RESULT_VARIABLE rc)
+    if(NOT rc STREQUAL expected_rc)
+        message(FATAL_ERROR "--threads=${threads} returned ${rc}, single-threaded run returned ${expected_rc}")
+    endif()
+    if(NOT actual STREQUAL expected)
+        file(WRITE "${WORK_DIR}/parallel_semantic.${threads}.err" "${actual}")
+        file(WRITE "${WORK_DIR}/parallel_semantic.1.err" "${expected}")
+        message(FATAL_ERROR "--threads=${threads} diagnostics differ from the single-threaded run, "
+                            "see ${WORK_DIR}/parallel_semantic.{1,${threads}}.err")
+    endif()
+endforeach()
+message(STATUS "${FUNCTIONS} functions, ${error_count} errors: identical diagnostics with 1, 4 and 8 threads")
@@ -160,7 +160,11 @@ function Test-All {
                 "..\tests\work3_test\basic_variables.sy",
                 "..\tests\work3_test\array_program.sy",
                 "..\tests\work3_test\function_program.sy",
-                "..\tests\work3_test\control_flow.sy"
+                "..\tests\work3_test\control_flow.sy",
+                "..\tests\work3_test\nested_while_loop.sy",
+                "..\tests\work3_test\loop_control.sy",
+                "..\tests\work3_test\operator_precedence.sy",
+                "..\tests\work3_test\float_underflow.sy"
             );
             ShouldFail = $false
         },
@@ -171,7 +175,8 @@ function Test-All {
             Description = "语法分析错误测试";
             Tests = @(
                 "..\tests\work3_test\missing_semicolon.sy",
-                "..\tests\work3_test\mismatched_brackets.sy"
+                "..\tests\work3_test\mismatched_brackets.sy",
+                "..\tests\work3_test\top_level_error.sy"
             );
             ShouldFail = $true
         },
@@ -201,7 +206,8 @@ function Test-All {
                 "..\tests\work4_test\non_integer_array_index.sy",
                 "..\tests\work4_test\type_mismatch_assignment.sy",
                 "..\tests\work3_test\multiple_declarations.sy",  # 这个文件有类型不匹配的语义错误
-                "..\tests\work4_test\const_assignment_error.sy"
+                "..\tests\work4_test\const_assignment_error.sy",
+                "..\tests\work4_test\break_outside_loop.sy"
             );
             ShouldFail = $true
         }